@@ -0,0 +1,107 @@
+// bench/bench.c
+
+#include "bench.h"
+#include <stdio.h>
+#include <string.h>
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+
+#ifdef SIMULACAO_HOST
+#include <time.h>
+#define BENCH_PLATAFORMA "host-sim"
+#else
+#define BENCH_PLATAFORMA "rp2040"
+#endif
+
+void bench_init(void) {
+  systick_hw->csr = 0;
+  systick_hw->rvr = 0xffffff;
+  systick_hw->cvr = 0;
+  systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+}
+
+void bench_iniciar(bench_t *b, const char *nome, const char *unidade) {
+  b->nome = nome;
+  b->unidade = unidade;
+  b->n = 0;
+}
+
+bench_marca_t bench_marca(void) {
+  bench_marca_t m;
+#ifdef SIMULACAO_HOST
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  m.host_ns = (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+  m.us = time_us_64();
+  m.systick = systick_hw->cvr;
+  return m;
+}
+
+void bench_registrar_desde(bench_t *b, bench_marca_t inicio) {
+  bench_marca_t fim = bench_marca();
+  uint32_t ciclos;
+
+  if (fim.us - inicio.us < BENCH_SYSTICK_MAX_US)
+    ciclos = (inicio.systick - fim.systick) & 0xffffff; // conta para baixo
+  else
+    ciclos = (uint32_t)((fim.us - inicio.us) * (clock_get_hz(clk_sys) / 1000000));
+
+  if (b->n < BENCH_MAX_AMOSTRAS) {
+#ifdef SIMULACAO_HOST
+    b->host_ns[b->n] = (uint32_t)(fim.host_ns - inicio.host_ns);
+#endif
+    b->amostras[b->n++] = ciclos;
+  }
+}
+
+void bench_registrar(bench_t *b, uint32_t valor) {
+  if (b->n < BENCH_MAX_AMOSTRAS) {
+#ifdef SIMULACAO_HOST
+    b->host_ns[b->n] = 0;
+#endif
+    b->amostras[b->n++] = valor;
+  }
+}
+
+// Ordena no lugar; poucas amostras, inserção basta
+static void ordenar(uint32_t *v, uint n) {
+  for (uint i = 1; i < n; i++) {
+    uint32_t x = v[i];
+    uint j = i;
+    for (; j > 0 && v[j - 1] > x; j--)
+      v[j] = v[j - 1];
+    v[j] = x;
+  }
+}
+
+// Percentil pelo posto mais próximo: o menor valor com pelo menos p% das amostras até ele
+static uint32_t percentil(const uint32_t *ordenado, uint n, uint p) {
+  uint posto = (n * p + 99) / 100;
+  return ordenado[posto ? posto - 1 : 0];
+}
+
+void bench_relatar(bench_t *b) {
+  if (b->n == 0) {
+    printf("{\"bench\":\"%s\",\"plataforma\":\"%s\",\"unidade\":\"%s\",\"n\":0}\n", b->nome, BENCH_PLATAFORMA,
+           b->unidade);
+    return;
+  }
+
+  ordenar(b->amostras, b->n);
+  uint32_t mediana = percentil(b->amostras, b->n, 50);
+  printf("{\"bench\":\"%s\",\"plataforma\":\"%s\",\"unidade\":\"%s\",\"n\":%u,"
+         "\"min\":%lu,\"mediana\":%lu,\"p99\":%lu,\"max\":%lu",
+         b->nome, BENCH_PLATAFORMA, b->unidade, b->n, (unsigned long)b->amostras[0], (unsigned long)mediana,
+         (unsigned long)percentil(b->amostras, b->n, 99), (unsigned long)b->amostras[b->n - 1]);
+  if (!strcmp(b->unidade, "ciclos"))
+    printf(",\"mediana_us\":%.1f", mediana / (clock_get_hz(clk_sys) / 1e6));
+
+#ifdef SIMULACAO_HOST
+  ordenar(b->host_ns, b->n);
+  if (b->host_ns[b->n - 1])
+    printf(",\"host_ns\":{\"min\":%lu,\"mediana\":%lu,\"p99\":%lu}", (unsigned long)b->host_ns[0],
+           (unsigned long)percentil(b->host_ns, b->n, 50), (unsigned long)percentil(b->host_ns, b->n, 99));
+#endif
+  printf("}\n");
+}
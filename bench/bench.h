@@ -0,0 +1,59 @@
+// bench/bench.h
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "pico/stdlib.h"
+
+#define BENCH_MAX_AMOSTRAS 128
+
+/*
+ * Medidas dos caminhos quentes, em ciclos de clk_sys. Intervalos curtos vêm
+ * do SysTick (24 bits, exato ao ciclo); os que passam de BENCH_SYSTICK_MAX_US
+ * vêm de time_us_64() convertidos para ciclos.
+ *
+ * Cada bench termina numa linha JSON na serial, fácil de separar dos quadros
+ * e do texto do jogo (python/bench.py coletar):
+ *
+ *   {"bench":"render_cheio","plataforma":"rp2040","unidade":"ciclos","n":32,
+ *    "min":..,"mediana":..,"p99":..,"max":..,"mediana_us":..}
+ *
+ * Na simulação de host o tempo virtual não anda enquanto o código roda, então
+ * cada amostra também guarda o tempo de CPU real do host ("host_ns").
+ */
+#define BENCH_SYSTICK_MAX_US 100000
+
+typedef struct {
+  uint64_t us;
+  uint32_t systick;
+#ifdef SIMULACAO_HOST
+  uint64_t host_ns;
+#endif
+} bench_marca_t;
+
+typedef struct {
+  const char *nome;
+  const char *unidade; // "ciclos" ou, para medidas prontas, "us"
+  uint n;
+  uint32_t amostras[BENCH_MAX_AMOSTRAS];
+#ifdef SIMULACAO_HOST
+  uint32_t host_ns[BENCH_MAX_AMOSTRAS];
+#endif
+} bench_t;
+
+// Liga o SysTick contando clk_sys (sem interrupção)
+void bench_init(void);
+
+void bench_iniciar(bench_t *b, const char *nome, const char *unidade);
+bench_marca_t bench_marca(void);
+
+// Guarda os ciclos desde a marca; amostras além de BENCH_MAX_AMOSTRAS são ignoradas
+void bench_registrar_desde(bench_t *b, bench_marca_t inicio);
+
+// Guarda um valor já medido, na unidade do bench
+void bench_registrar(bench_t *b, uint32_t valor);
+
+// Imprime min/mediana/p99/max numa linha JSON
+void bench_relatar(bench_t *b);
+
+#endif
@@ -0,0 +1,156 @@
+// bench/bench_firmware.c
+
+#include "bench_firmware.h"
+#include <stdio.h>
+#include "bench.h"
+#include "buzzer/buzzer_pwm.h"
+#include "comunicacao/linha_serial.h"
+#include "matriz_led/neopixel_pio.h"
+#include "microfone/log_mel.h"
+#include "microfone/pipeline_audio.h"
+
+#define ITERACOES 32
+#define CAPTURA_LATENCIA_US 1200000
+
+static bench_t b;
+
+static void bench_display(uint8_t *buf, struct render_area *area) {
+  // Tela inteira sujando: comandos + 1024 bytes numa transação só
+  bench_iniciar(&b, "render_cheio", "ciclos");
+  for (uint i = 0; i < ITERACOES; i++) {
+    SSD1306_invalidate();
+    bench_marca_t m = bench_marca();
+    render(buf, area);
+    bench_registrar_desde(&b, m);
+  }
+  bench_relatar(&b);
+
+  // O mesmo quadro com um comando por transação, como era antes do envio em lote
+  uint8_t cmds[] = {SSD1306_SET_COL_ADDR, 0, SSD1306_WIDTH - 1, SSD1306_SET_PAGE_ADDR, 0, SSD1306_NUM_PAGES - 1};
+  bench_iniciar(&b, "render_cmd_por_transacao", "ciclos");
+  for (uint i = 0; i < ITERACOES; i++) {
+    bench_marca_t m = bench_marca();
+    for (uint c = 0; c < count_of(cmds); c++)
+      SSD1306_send_cmd(cmds[c]);
+    SSD1306_send_buf(buf, SSD1306_BUF_LEN);
+    bench_registrar_desde(&b, m);
+  }
+  bench_relatar(&b);
+  SSD1306_invalidate(); // o envio direto não passa pela cópia do painel
+
+  // Uma letra trocando: só a janela suja vai para o I2C
+  bench_iniciar(&b, "render_parcial", "ciclos");
+  for (uint i = 0; i < ITERACOES; i++) {
+    WriteString(buf, 0, 0, (i & 1) ? "A" : "B");
+    bench_marca_t m = bench_marca();
+    render(buf, area);
+    bench_registrar_desde(&b, m);
+  }
+  bench_relatar(&b);
+
+  bench_iniciar(&b, "writestring", "ciclos");
+  for (uint i = 0; i < ITERACOES; i++) {
+    bench_marca_t m = bench_marca();
+    WriteString(buf, 5, 8, "pressione B");
+    bench_registrar_desde(&b, m);
+  }
+  bench_relatar(&b);
+}
+
+static void bench_leds(void) {
+  npClear();
+  bench_iniciar(&b, "npwrite", "ciclos");
+  for (uint i = 0; i < ITERACOES; i++) {
+    npSetLED(i % 25, 0, 80, 0);
+    bench_marca_t m = bench_marca();
+    npWrite();
+    bench_registrar_desde(&b, m);
+  }
+  bench_relatar(&b);
+  npClear();
+  npWrite();
+}
+
+// O beep não bloqueia mais: mede só o custo de enfileirar e já começar a tocar
+static void bench_buzzer(uint pin) {
+  pwm_init_buzzer(pin);
+  bench_iniciar(&b, "beep_enfileirar", "ciclos");
+  for (uint i = 0; i < ITERACOES; i++) {
+    bench_marca_t m = bench_marca();
+    beep(pin, 1000, 10);
+    bench_registrar_desde(&b, m);
+    buzzer_cancelar();
+  }
+  bench_relatar(&b);
+}
+
+static void bench_linha_serial(void) {
+  static const char texto[] = "palavra_de_teste\n";
+  linha_serial_t l;
+
+  linha_serial_init(&l);
+  bench_iniciar(&b, "linha_serial", "ciclos");
+  for (uint i = 0; i < ITERACOES; i++) {
+    bench_marca_t m = bench_marca();
+    for (const char *p = texto; *p; p++)
+      linha_serial_alimentar(&l, *p);
+    bench_registrar_desde(&b, m);
+  }
+  bench_relatar(&b);
+}
+
+// Um bloco de LOG_MEL_JANELA amostras no codec log-mel: dois quadros de
+// FFT de 256 pontos (passo de LOG_MEL_PASSO) por bloco
+static void bench_log_mel(void) {
+  static log_mel_t mel;
+  static uint16_t amostras[LOG_MEL_JANELA];
+  uint8_t saida[2 * LOG_MEL_BANDAS];
+
+  for (uint i = 0; i < count_of(amostras); i++)
+    amostras[i] = 2048 + ((i * 37) & 0xFF) - 128; // ruído de dente de serra
+  log_mel_reset(&mel);
+  log_mel_processar(&mel, amostras, count_of(amostras), saida); // enche a janela
+  bench_iniciar(&b, "log_mel_bloco", "ciclos");
+  for (uint i = 0; i < ITERACOES; i++) {
+    bench_marca_t m = bench_marca();
+    log_mel_processar(&mel, amostras, count_of(amostras), saida);
+    bench_registrar_desde(&b, m);
+  }
+  bench_relatar(&b);
+}
+
+// Da última amostra de cada bloco convertida até o quadro ser entregue à USB:
+// DMA, core1 (codec), anel SPSC e o laço do core0
+static void bench_latencia_adc_usb(void) {
+  static uint32_t latencias[AUDIO_PIPELINE_LATENCIAS];
+
+  audio_pipeline_latencias(latencias, 0); // descarta medidas antigas
+  audio_pipeline_start(CODEC_IMA_ADPCM, NULL);
+  uint64_t fim = time_us_64() + CAPTURA_LATENCIA_US;
+  while (time_us_64() < fim) {
+    audio_pipeline_poll();
+    tight_loop_contents();
+  }
+  audio_pipeline_stop();
+  while (!audio_pipeline_idle()) {
+    audio_pipeline_poll();
+    tight_loop_contents();
+  }
+
+  uint n = audio_pipeline_latencias(latencias, count_of(latencias));
+  bench_iniciar(&b, "adc_usb_latencia", "us");
+  for (uint i = 0; i < n; i++)
+    bench_registrar(&b, latencias[i]);
+  bench_relatar(&b);
+}
+
+void bench_firmware_rodar(uint8_t *buf, struct render_area *area, uint buzzer_pin) {
+  bench_init();
+  bench_display(buf, area);
+  bench_leds();
+  bench_buzzer(buzzer_pin);
+  bench_linha_serial();
+  bench_log_mel();
+  bench_latencia_adc_usb();
+  printf("bench_fim\n");
+}
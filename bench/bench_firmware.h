@@ -0,0 +1,15 @@
+// bench/bench_firmware.h
+
+#ifndef BENCH_FIRMWARE_H
+#define BENCH_FIRMWARE_H
+
+#include "pico/stdlib.h"
+#include "display/ssd1306_i2c.h"
+
+// Roda a suíte de benchmarks dos caminhos quentes do firmware (display, LEDs,
+// buzzer, serial e latência ADC→USB) e imprime uma linha JSON por caso,
+// terminando com "bench_fim". Espera os periféricos já inicializados; deixa
+// o conteúdo de buf e da tela alterados.
+void bench_firmware_rodar(uint8_t *buf, struct render_area *area, uint buzzer_pin);
+
+#endif
@@ -1,103 +1,248 @@
 #include <stdio.h>
+#include "buzzer_pwm.h"
 #include "pico/stdlib.h"
 #include "hardware/pwm.h"
 #include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "rastreio/rastreio.h"
 
 // Configuração do pino do buzzer
 #define BUZZER_PIN_A 21
 #define BUZZER_PIN_B 8
 
-// Notas musicais para a música tema de Star Wars
-const uint star_wars_notes[] = {
-    330, 330, 330, 262, 392, 523, 330, 262,
-    392, 523, 330, 659, 659, 659, 698, 523,
-    415, 349, 330, 262, 392, 523, 330, 262,
-    392, 523, 330, 659, 659, 659, 698, 523,
-    415, 349, 330, 523, 494, 440, 392, 330,
-    659, 784, 659, 523, 494, 440, 392, 330,
-    659, 659, 330, 784, 880, 698, 784, 659,
-    523, 494, 440, 392, 659, 784, 659, 523,
-    494, 440, 392, 330, 659, 523, 659, 262,
-    330, 294, 247, 262, 220, 262, 330, 262,
-    330, 294, 247, 262, 330, 392, 523, 440,
-    349, 330, 659, 784, 659, 523, 494, 440,
-    392, 659, 784, 659, 523, 494, 440, 392
+// Música tema de Star Wars: frequência (Hz) e duração (ms) de cada nota, cada
+// uma seguida da pausa curta entre notas. Tabela pronta na compilação: a fila do
+// buzzer lê direto dela, então tocar de novo não mexe no que está tocando.
+#define PAUSA_ENTRE_NOTAS_MS 50
+#define NOTA_SW(freq, dur) \
+    {freq, dur, BUZZER_VOLUME_MAX, BUZZER_ENV_SUAVE}, {0, PAUSA_ENTRE_NOTAS_MS, 0, BUZZER_ENV_PLANO}
+
+static const nota_t star_wars[] = {
+    NOTA_SW(330, 500), NOTA_SW(330, 500), NOTA_SW(330, 500), NOTA_SW(262, 350),
+    NOTA_SW(392, 150), NOTA_SW(523, 300), NOTA_SW(330, 500), NOTA_SW(262, 350),
+    NOTA_SW(392, 150), NOTA_SW(523, 300), NOTA_SW(330, 500), NOTA_SW(659, 500),
+    NOTA_SW(659, 500), NOTA_SW(659, 500), NOTA_SW(698, 350), NOTA_SW(523, 150),
+    NOTA_SW(415, 300), NOTA_SW(349, 500), NOTA_SW(330, 500), NOTA_SW(262, 350),
+    NOTA_SW(392, 150), NOTA_SW(523, 300), NOTA_SW(330, 500), NOTA_SW(262, 350),
+    NOTA_SW(392, 150), NOTA_SW(523, 300), NOTA_SW(330, 650), NOTA_SW(659, 500),
+    NOTA_SW(659, 150), NOTA_SW(659, 300), NOTA_SW(698, 500), NOTA_SW(523, 350),
+    NOTA_SW(415, 150), NOTA_SW(349, 300), NOTA_SW(330, 500), NOTA_SW(523, 150),
+    NOTA_SW(494, 300), NOTA_SW(440, 500), NOTA_SW(392, 350), NOTA_SW(330, 150),
+    NOTA_SW(659, 300), NOTA_SW(784, 650), NOTA_SW(659, 500), NOTA_SW(523, 350),
+    NOTA_SW(494, 150), NOTA_SW(440, 300), NOTA_SW(392, 500), NOTA_SW(330, 350),
+    NOTA_SW(659, 150), NOTA_SW(659, 300), NOTA_SW(330, 500), NOTA_SW(784, 500),
+    NOTA_SW(880, 500), NOTA_SW(698, 500), NOTA_SW(784, 350), NOTA_SW(659, 150),
+    NOTA_SW(523, 300), NOTA_SW(494, 500), NOTA_SW(440, 500), NOTA_SW(392, 350),
+    NOTA_SW(659, 150), NOTA_SW(784, 300), NOTA_SW(659, 500), NOTA_SW(523, 350),
+    NOTA_SW(494, 150), NOTA_SW(440, 300), NOTA_SW(392, 500), NOTA_SW(330, 350),
+    NOTA_SW(659, 150), NOTA_SW(523, 300), NOTA_SW(659, 500), NOTA_SW(262, 500),
+    NOTA_SW(330, 350), NOTA_SW(294, 150), NOTA_SW(247, 300), NOTA_SW(262, 500),
+    NOTA_SW(220, 500), NOTA_SW(262, 350), NOTA_SW(330, 150), NOTA_SW(262, 300),
 };
 
-// Duração das notas em milissegundos
-const uint note_duration[] = {
-    500, 500, 500, 350, 150, 300, 500, 350,
-    150, 300, 500, 500, 500, 500, 350, 150,
-    300, 500, 500, 350, 150, 300, 500, 350,
-    150, 300, 650, 500, 150, 300, 500, 350,
-    150, 300, 500, 150, 300, 500, 350, 150,
-    300, 650, 500, 350, 150, 300, 500, 350,
-    150, 300, 500, 500, 500, 500, 350, 150,
-    300, 500, 500, 350, 150, 300, 500, 350,
-    150, 300, 500, 350, 150, 300, 500, 500,
-    350, 150, 300, 500, 500, 350, 150, 300,
-};
+#define FILA_TRECHOS 16
+#define ENVELOPE_PASSO_US 10000// de quanto em quanto o volume é recalculado
+#define RAMPA_SUAVE_US 15000   // ataque e soltura do BUZZER_ENV_SUAVE
+
+// Um pedido de buzzer_tocar(): notas do chamador ou uma nota copiada aqui
+typedef struct {
+    const nota_t *notas;
+    uint16_t n;
+    nota_t unica;
+} trecho_t;
+
+static trecho_t fila[FILA_TRECHOS];
+static uint fila_ini = 0, fila_n = 0, fila_pos = 0; // fila_pos: próxima nota do primeiro trecho
+
+static uint buzzer_pin;
+static uint slice_num;
+static bool iniciado = false;
+
+// Tocando agora: uma cópia, porque o trecho de uma nota avulsa é liberado na
+// hora em que ela sai da fila e pode ser reaproveitado por outro enfileirar()
+static nota_t tocando;
+static const nota_t *nota = NULL; // &tocando, ou NULL em silêncio
+static uint32_t decorrido_us, restante_us;
+static uint16_t wrap_atual;
+static alarm_id_t alarme = 0;
 
 // Inicializa o PWM no pino do buzzer
 void pwm_init_buzzer(uint pin) {
+    buzzer_pin = pin;
+    slice_num = pwm_gpio_to_slice_num(pin);
     gpio_set_function(pin, GPIO_FUNC_PWM);
-    uint slice_num = pwm_gpio_to_slice_num(pin);
     pwm_config config = pwm_get_default_config();
-    pwm_config_set_clkdiv(&config, 4.0f); // Ajusta divisor de clock
-    pwm_init(slice_num, &config, true);
+    pwm_init(slice_num, &config, false);
     pwm_set_gpio_level(pin, 0); // Desliga o PWM inicialmente
+    iniciado = true;
 }
 
-// Toca uma nota com a frequência e duração especificadas
-void play_tone(uint pin, uint frequency, uint duration_ms) {
-    uint slice_num = pwm_gpio_to_slice_num(pin);
-    uint32_t clock_freq = clock_get_hz(clk_sys);
-    uint32_t top = clock_freq / frequency - 1;
+/**
+ * Divisor e wrap exatos para a frequência: o menor divisor (em 1/16) que deixa
+ * o período caber nos 16 bits do contador, o que dá a maior resolução de duty.
+ */
+static void configurar_frequencia(uint freq_hz) {
+    uint64_t clk16 = (uint64_t)clock_get_hz(clk_sys) * 16;
+    uint32_t div16 = (uint32_t)((clk16 + (uint64_t)freq_hz * 65536 - 1) / ((uint64_t)freq_hz * 65536));
+    if (div16 < 16)
+        div16 = 16;
+    if (div16 > 255 * 16 + 15)
+        div16 = 255 * 16 + 15; // abaixo de ~8 Hz o período satura
+    uint64_t periodo = (clk16 + (uint64_t)div16 * freq_hz / 2) / ((uint64_t)div16 * freq_hz);
+    if (periodo > 65536)
+        periodo = 65536;
+
+    wrap_atual = (uint16_t)(periodo - 1);
+    pwm_set_clkdiv_int_frac(slice_num, div16 >> 4, div16 & 0xF);
+    pwm_set_wrap(slice_num, wrap_atual);
+}
 
-    pwm_set_wrap(slice_num, top);
-    pwm_set_gpio_level(pin, top / 2); // 50% de duty cycle
+// Volume em 0..255 do máximo (duty de 50%), conforme o envelope da nota
+static void aplicar_volume(void) {
+    uint32_t vol = nota->volume;
+    uint32_t total = nota->dur_ms * 1000u;
+
+    if (nota->envelope == BUZZER_ENV_DECAI) {
+        vol = vol * (total - decorrido_us) / total;
+    } else if (nota->envelope == BUZZER_ENV_SUAVE) {
+        uint32_t borda = decorrido_us < total - decorrido_us ? decorrido_us : total - decorrido_us;
+        if (borda < RAMPA_SUAVE_US)
+            vol = vol * borda / RAMPA_SUAVE_US;
+    }
+    pwm_set_gpio_level(buzzer_pin, (uint16_t)(((uint32_t)wrap_atual + 1) / 2 * vol / 255));
+}
 
-    sleep_ms(duration_ms);
+static void silenciar(void) {
+    pwm_set_gpio_level(buzzer_pin, 0);
+    pwm_set_enabled(slice_num, false);
+}
 
-    pwm_set_gpio_level(pin, 0); // Desliga o som após a duração
-    sleep_ms(50); // Pausa entre notas
+static const nota_t *tirar_da_fila(void) {
+    if (fila_n == 0)
+        return NULL;
+    trecho_t *t = &fila[fila_ini];
+    const nota_t *n = t->notas ? &t->notas[fila_pos] : &t->unica;
+    if (++fila_pos >= t->n) {
+        fila_pos = 0;
+        fila_ini = (fila_ini + 1) % FILA_TRECHOS;
+        fila_n--;
+    }
+    return n;
 }
 
-// Função principal para tocar a música
-void play_star_wars(uint pin) {
-    for (int i = 0; i < sizeof(star_wars_notes) / sizeof(star_wars_notes[0]); i++) {
-        if (star_wars_notes[i] == 0) {
-            sleep_ms(note_duration[i]);
+// Avança o sequenciador; retorna em quantos us chamar de novo (0 = fila vazia)
+static uint32_t sequenciar(void) {
+    while (restante_us == 0) {
+        if (nota) {
+            rastreio_fim(RT_BEEP, nota->freq_hz);
+            nota = NULL;
+        }
+        const nota_t *proxima = tirar_da_fila();
+        if (proxima == NULL) {
+            silenciar();
+            return 0;
+        }
+        tocando = *proxima;
+        nota = &tocando;
+        decorrido_us = 0;
+        restante_us = nota->dur_ms * 1000u;
+        rastreio_inicio(RT_BEEP, nota->freq_hz);
+        if (nota->freq_hz == 0 || nota->volume == 0) {
+            silenciar(); // pausa
         } else {
-            play_tone(pin, star_wars_notes[i], note_duration[i]);
+            configurar_frequencia(nota->freq_hz);
+            pwm_set_enabled(slice_num, true);
         }
     }
+
+    bool envelope = nota->freq_hz != 0 && nota->envelope != BUZZER_ENV_PLANO;
+    uint32_t passo = envelope && restante_us > ENVELOPE_PASSO_US ? ENVELOPE_PASSO_US : restante_us;
+    if (nota->freq_hz != 0)
+        aplicar_volume();
+    decorrido_us += passo;
+    restante_us -= passo;
+    return passo;
 }
 
-void beep(uint pin, uint freq_hz, uint duration_ms) {
-    // Calcula o slice PWM
-    uint slice_num = pwm_gpio_to_slice_num(pin);
-    pwm_config config = pwm_get_default_config();
+// Negativo: o próximo passo conta de quando este estava marcado, sem acumular atraso
+static int64_t alarme_sequenciador(alarm_id_t id, void *user_data) {
+    uint32_t us = sequenciar();
+    if (us == 0)
+        alarme = 0;
+    return -(int64_t)us;
+}
 
-    // Calcula o wrap para a frequência desejada
-    uint32_t clock = 6553500; // clock padrão da Pico (125 MHz)
-    uint32_t wrap = clock / freq_hz;
+// Põe um trecho no fim da fila e, se o sequenciador estava parado, já começa a tocar
+static bool enfileirar(const nota_t *notas, uint n, const nota_t *unica) {
+    if (!iniciado || n == 0)
+        return false;
+
+    uint32_t status = save_and_disable_interrupts();
+    bool ok = fila_n < FILA_TRECHOS;
+    if (ok) {
+        trecho_t *t = &fila[(fila_ini + fila_n++) % FILA_TRECHOS];
+        t->notas = notas;
+        t->n = notas ? n : 1;
+        if (unica)
+            t->unica = *unica; // a cópia fica no trecho, então a nota pode vir da pilha
+        if (alarme == 0) {
+            uint32_t us = sequenciar();
+            if (us)
+                alarme = add_alarm_in_us(us, alarme_sequenciador, NULL, true);
+        }
+    }
+    restore_interrupts(status);
+    return ok;
+}
 
-    pwm_config_set_wrap(&config, wrap - 1);
-    pwm_config_set_clkdiv(&config, 1.0f); // clock divisor = 1
+bool buzzer_tocar(const nota_t *notas, uint n) {
+    return notas != NULL && enfileirar(notas, n, NULL);
+}
 
-    // Configura pino como saída PWM
-    gpio_set_function(pin, GPIO_FUNC_PWM);
-    pwm_init(slice_num, &config, true);
+bool buzzer_nota(uint freq_hz, uint dur_ms, uint8_t volume, uint8_t envelope) {
+    nota_t nota = {freq_hz, dur_ms, volume, envelope};
+    return enfileirar(NULL, 1, &nota);
+}
+
+void buzzer_cancelar(void) {
+    uint32_t status = save_and_disable_interrupts();
+    if (alarme) {
+        cancel_alarm(alarme);
+        alarme = 0;
+    }
+    if (nota)
+        rastreio_fim(RT_BEEP, nota->freq_hz);
+    fila_n = 0;
+    fila_pos = 0;
+    nota = NULL;
+    restante_us = 0;
+    if (iniciado)
+        silenciar();
+    restore_interrupts(status);
+}
 
-    // Define duty cycle (50%)
-    pwm_set_gpio_level(pin, wrap / 2);
+bool buzzer_tocando(void) {
+    return alarme != 0;
+}
 
-    // Aguarda duração
-    sleep_ms(duration_ms);
+// Toca uma nota com a frequência e duração especificadas, seguida de uma pausa curta
+void play_tone(uint pin, uint frequency, uint duration_ms) {
+    if (!iniciado || pin != buzzer_pin)
+        pwm_init_buzzer(pin);
+    buzzer_nota(frequency, duration_ms, BUZZER_VOLUME_MAX, BUZZER_ENV_PLANO);
+    buzzer_nota(0, PAUSA_ENTRE_NOTAS_MS, 0, BUZZER_ENV_PLANO);
+}
 
-    // Para o PWM (silêncio)
-    pwm_set_enabled(slice_num, false);
-    gpio_set_function(pin, GPIO_FUNC_SIO); // volta para função GPIO
-    gpio_put(pin, 0); // garante nível baixo
-}
\ No newline at end of file
+// Função principal para tocar a música (em segundo plano)
+void play_star_wars(uint pin) {
+    if (!iniciado || pin != buzzer_pin)
+        pwm_init_buzzer(pin);
+    buzzer_tocar(star_wars, count_of(star_wars));
+}
+
+// Enfileira um bipe e retorna na hora; o som sai em segundo plano
+void beep(uint pin, uint freq_hz, uint duration_ms) {
+    if (!iniciado || pin != buzzer_pin)
+        pwm_init_buzzer(pin);
+    buzzer_nota(freq_hz, duration_ms, BUZZER_VOLUME_MAX, BUZZER_ENV_PLANO);
+}
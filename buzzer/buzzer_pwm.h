@@ -3,9 +3,43 @@
 
 #include "pico/stdlib.h"
 
+#define BUZZER_VOLUME_MAX 255
+
+// Como o volume de uma nota evolui ao longo da duração
+enum {
+    BUZZER_ENV_PLANO = 0, // volume constante
+    BUZZER_ENV_DECAI,     // cai linearmente até zero (bipes de contagem)
+    BUZZER_ENV_SUAVE,     // rampas curtas de ataque e soltura, sem estalo
+};
+
+/**
+ * Uma nota do sequenciador. freq_hz = 0 é pausa; volume vai de 0 a
+ * BUZZER_VOLUME_MAX (duty de 50%).
+ */
+typedef struct {
+    uint16_t freq_hz;
+    uint16_t dur_ms;
+    uint8_t volume;
+    uint8_t envelope;
+} nota_t;
+
 void pwm_init_buzzer(uint pin);
+
+/**
+ * Enfileira uma lista de notas e retorna na hora; o som sai em segundo plano,
+ * conduzido por alarmes de hardware. A lista não é copiada: precisa continuar
+ * válida (static/const) até tocar. Retorna false com a fila cheia.
+ */
+bool buzzer_tocar(const nota_t *notas, uint n);
+// Enfileira uma nota avulsa (copiada)
+bool buzzer_nota(uint freq_hz, uint dur_ms, uint8_t volume, uint8_t envelope);
+// Silencia na hora e esvazia a fila
+void buzzer_cancelar(void);
+bool buzzer_tocando(void);
+
+// Compatíveis com as versões antigas, mas sem bloquear
 void play_tone(uint pin, uint frequency, uint duration_ms);
 void play_star_wars(uint pin);
 void beep(uint pin, uint freq_hz, uint duration_ms);
 
-#endif
\ No newline at end of file
+#endif
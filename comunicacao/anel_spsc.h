@@ -0,0 +1,67 @@
+// comunicacao/anel_spsc.h
+
+#ifndef ANEL_SPSC_H
+#define ANEL_SPSC_H
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+/*
+ * Fila circular sem trava para exatamente um produtor e um consumidor
+ * (por exemplo, core1 produz e core0 consome). Os slots têm tamanho fixo
+ * e são preenchidos/lidos no lugar, sem cópia. A capacidade deve ser
+ * potência de 2; os índices crescem livremente e são mascarados no acesso.
+ *
+ * Cada índice só é escrito por um lado, e a barreira (__dmb) garante que
+ * o conteúdo do slot fica visível antes do índice que o publica.
+ */
+typedef struct {
+    volatile uint32_t head;     // escrito só pelo produtor
+    volatile uint32_t tail;     // escrito só pelo consumidor
+    uint32_t mask;
+    uint32_t slot_size;
+    uint8_t *slots;
+} anel_spsc_t;
+
+static inline void anel_spsc_init(anel_spsc_t *a, void *slots, uint32_t slot_size, uint32_t capacidade) {
+    a->head = 0;
+    a->tail = 0;
+    a->mask = capacidade - 1;
+    a->slot_size = slot_size;
+    a->slots = (uint8_t *)slots;
+}
+
+static inline bool anel_spsc_vazio(const anel_spsc_t *a) {
+    return a->head == a->tail;
+}
+
+// Produtor: slot livre para preencher, ou NULL se a fila está cheia
+static inline void *anel_spsc_reservar(anel_spsc_t *a) {
+    if (a->head - a->tail > a->mask)
+        return NULL;
+    return a->slots + (a->head & a->mask) * a->slot_size;
+}
+
+// Produtor: torna visível ao consumidor o slot reservado
+static inline void anel_spsc_publicar(anel_spsc_t *a) {
+    __dmb();
+    a->head = a->head + 1;
+    __sev(); // acorda o outro core se estiver em __wfe
+}
+
+// Consumidor: slot mais antigo, ou NULL se a fila está vazia
+static inline void *anel_spsc_frente(anel_spsc_t *a) {
+    if (a->head == a->tail)
+        return NULL;
+    __dmb();
+    return a->slots + (a->tail & a->mask) * a->slot_size;
+}
+
+// Consumidor: devolve o slot ao produtor
+static inline void anel_spsc_liberar(anel_spsc_t *a) {
+    __dmb();
+    a->tail = a->tail + 1;
+    __sev();
+}
+
+#endif
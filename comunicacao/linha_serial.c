@@ -0,0 +1,21 @@
+// comunicacao/linha_serial.c
+
+#include "linha_serial.h"
+
+void linha_serial_init(linha_serial_t *l) {
+  l->pos = 0;
+  l->linha[0] = '\0';
+}
+
+bool linha_serial_alimentar(linha_serial_t *l, char ch) {
+  if (ch == '\n' || ch == '\r') {
+    if (l->pos == 0)
+      return false;
+    l->linha[l->pos] = '\0';
+    l->pos = 0;
+    return true;
+  }
+  if (l->pos < LINHA_SERIAL_MAX - 1)
+    l->linha[l->pos++] = ch;
+  return false;
+}
@@ -0,0 +1,23 @@
+// comunicacao/linha_serial.h
+
+#ifndef LINHA_SERIAL_H
+#define LINHA_SERIAL_H
+
+#include "pico/stdlib.h"
+
+#define LINHA_SERIAL_MAX 128
+
+// Montador das linhas de texto que chegam do host, um caractere por vez.
+// Linhas vazias são ignoradas; o excesso além de LINHA_SERIAL_MAX - 1 é descartado.
+typedef struct {
+  char linha[LINHA_SERIAL_MAX];
+  uint pos;
+} linha_serial_t;
+
+void linha_serial_init(linha_serial_t *l);
+
+// Retorna true quando ch fecha uma linha; ela fica em l->linha (terminada em
+// '\0') até o próximo caractere ser alimentado.
+bool linha_serial_alimentar(linha_serial_t *l, char ch);
+
+#endif
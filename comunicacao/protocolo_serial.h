@@ -0,0 +1,43 @@
+// comunicacao/protocolo_serial.h
+
+#ifndef PROTOCOLO_SERIAL_H
+#define PROTOCOLO_SERIAL_H
+
+#include "pico/stdlib.h"
+
+/*
+ * Quadro binário multiplexado com as linhas de texto na mesma serial USB:
+ *
+ *   0xA5 0x5A | tipo (1) | seq (2, LE) | len (2, LE) | payload (len) | crc16 (2, LE)
+ *
+ * O CRC-16/CCITT (poly 0x1021, init 0xFFFF) cobre tipo, seq, len e payload.
+ * Linhas de texto são ASCII puro, então nunca começam com 0xA5.
+ */
+#define PROTO_SYNC0             0xA5
+#define PROTO_SYNC1             0x5A
+#define PROTO_HEADER_LEN        7
+#define PROTO_CRC_LEN           2
+#define PROTO_MAX_PAYLOAD       512
+
+// Tipos de quadro
+#define PROTO_INICIO            0x01  // payload: taxa (u16), formato (u8)
+#define PROTO_AUDIO             0x02  // payload: amostras no formato anunciado
+#define PROTO_FIM               0x03  // payload: total de amostras (u32), blocos perdidos (u32)
+#define PROTO_VAD               0x04  // payload: evento (u8), bloco (u32), energia (u32), piso de ruído (u32)
+#define PROTO_RASTREIO          0x05  // despejo do rastro (rastreio/rastreio.h), quebrado em vários quadros
+#define PROTO_ESTATISTICAS      0x06  // contadores do rastro, u32 LE
+#define PROTO_MEL               0x07  // payload: quadros log-mel de LOG_MEL_BANDAS bytes (microfone/log_mel.h)
+
+// Formatos de áudio anunciados no quadro de início
+#define PROTO_FORMATO_PCM8      0x00  // 8 bits sem sinal, 128 = silêncio
+#define PROTO_FORMATO_MULAW     0x01  // G.711 mu-law, 1 byte por amostra
+#define PROTO_FORMATO_IMA_ADPCM 0x02  // cabeçalho de 3 bytes por quadro + 4 bits por amostra
+#define PROTO_FORMATO_LOG_MEL   0x03  // sem quadros de áudio: só PROTO_MEL
+
+uint16_t proto_crc16(const uint8_t *data, uint len, uint16_t crc);
+void proto_send(uint8_t tipo, const uint8_t *payload, uint len);
+void proto_send_start(uint16_t sample_rate_hz, uint8_t formato);
+void proto_send_audio(const uint8_t *amostras, uint len);
+void proto_send_stop(uint32_t total_amostras, uint32_t blocos_perdidos);
+
+#endif
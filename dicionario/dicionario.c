@@ -0,0 +1,73 @@
+// dicionario/dicionario.c
+
+#include "dicionario.h"
+#include "dicionario_dados.h"
+#include "pico/rand.h"
+#include <string.h>
+
+static const dicionario_raiz_t *raiz_de(uint letras) {
+  for (uint i = 0; i < dicionario_num_raizes; i++)
+    if (dicionario_raizes[i].letras == letras)
+      return &dicionario_raizes[i];
+  return NULL;
+}
+
+uint32_t dicionario_total(uint letras) {
+  const dicionario_raiz_t *r = raiz_de(letras);
+  return r ? r->total : 0;
+}
+
+/**
+ * Desce pelo DAWG escolhendo, em cada nó, a aresta cujo intervalo de
+ * contagens contém o índice. No máximo 26 arestas por letra.
+ */
+bool dicionario_palavra(uint letras, uint32_t indice, char *dst) {
+  const dicionario_raiz_t *r = raiz_de(letras);
+  if (r == NULL || indice >= r->total)
+    return false;
+
+  uint32_t no = r->raiz;
+  for (uint i = 0; i < letras; i++) {
+    uint32_t e = no;
+    while (indice >= dicionario_contagens[e]) {
+      indice -= dicionario_contagens[e];
+      e++;
+    }
+    dst[i] = DICIONARIO_LETRA(dicionario_arestas[e]);
+    no = DICIONARIO_DESTINO(dicionario_arestas[e]);
+  }
+  dst[letras] = '\0';
+  return true;
+}
+
+bool dicionario_sortear(uint letras, char *dst) {
+  uint32_t total = dicionario_total(letras);
+  if (total == 0)
+    return false;
+
+  // Rejeita o pedaço final do intervalo de 32 bits para não favorecer os primeiros índices
+  uint32_t limite = UINT32_MAX - UINT32_MAX % total;
+  uint32_t sorteio;
+  do {
+    sorteio = get_rand_32();
+  } while (sorteio >= limite);
+  return dicionario_palavra(letras, sorteio % total, dst);
+}
+
+bool dicionario_contem(const char *palavra) {
+  const dicionario_raiz_t *r = raiz_de(strlen(palavra));
+  if (r == NULL)
+    return false;
+
+  uint32_t no = r->raiz;
+  for (const char *c = palavra; *c; c++) {
+    uint32_t e = no;
+    while (DICIONARIO_LETRA(dicionario_arestas[e]) != *c) {
+      if (dicionario_arestas[e] & DICIONARIO_ULTIMA)
+        return false;
+      e++;
+    }
+    no = DICIONARIO_DESTINO(dicionario_arestas[e]);
+  }
+  return true;
+}
@@ -0,0 +1,26 @@
+// dicionario/dicionario.h
+
+#ifndef DICIONARIO_H
+#define DICIONARIO_H
+
+#include "pico/stdlib.h"
+
+// Maior palavra que cabe no dicionário, sem contar o '\0'
+#define DICIONARIO_MAX_LETRAS 31
+
+// Palavras do dataset compiladas para a flash (normalizadas: a-z, sem acentos).
+// Tudo roda direto sobre as tabelas; nada é descompactado na RAM.
+
+// Quantas palavras com esse número de letras (0 se o tamanho não foi incluído no build)
+uint32_t dicionario_total(uint letras);
+
+// A palavra de posição "indice" na ordem alfabética entre as de "letras" letras.
+// dst precisa de letras + 1 bytes. Retorna false se o índice não existe.
+bool dicionario_palavra(uint letras, uint32_t indice, char *dst);
+
+// Sorteio uniforme (get_rand_32) entre as palavras de "letras" letras
+bool dicionario_sortear(uint letras, char *dst);
+
+bool dicionario_contem(const char *palavra);
+
+#endif
@@ -0,0 +1,33 @@
+// dicionario/dicionario_dados.h
+
+#ifndef DICIONARIO_DADOS_H
+#define DICIONARIO_DADOS_H
+
+#include "pico/stdlib.h"
+
+// Tabelas do DAWG geradas no build por python/gerar_dicionario.py (ficam na
+// flash, lidas direto pelo XIP). Só dicionario.c deve usá-las.
+//
+// Um nó é uma sequência de arestas contíguas em dicionario_arestas, a última
+// marcada com DICIONARIO_ULTIMA; o nó é identificado pelo índice da primeira.
+// Destino 0 marca o fim da palavra. dicionario_contagens[i] é o número de
+// palavras que passam pela aresta i, o que permite ir direto à k-ésima.
+
+#define DICIONARIO_ULTIMA        (1u << 31)
+#define DICIONARIO_BITS_DESTINO  22
+#define DICIONARIO_DESTINO(a)    ((a) & ((1u << DICIONARIO_BITS_DESTINO) - 1))
+#define DICIONARIO_LETRA(a)      ((char)('a' - 1 + (((a) >> DICIONARIO_BITS_DESTINO) & 0x1F)))
+
+// Uma raiz por tamanho: todas as palavras abaixo dela têm "letras" letras
+typedef struct {
+  uint8_t letras;
+  uint32_t raiz;
+  uint32_t total;
+} dicionario_raiz_t;
+
+extern const dicionario_raiz_t dicionario_raizes[];
+extern const uint dicionario_num_raizes;
+extern const uint32_t dicionario_arestas[];
+extern const uint16_t dicionario_contagens[];
+
+#endif
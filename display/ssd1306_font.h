@@ -50,4 +50,6 @@ static uint8_t font[] = {
 0x00, 0x00, 0x00, 0x00, 0x18, 0x08, 0x30, 0x00, // ,        
 0x41, 0x22, 0x10, 0x08, 0x04, 0x42, 0x81, 0x00, // %
 0x00, 0x00, 0x00, 0x00, 0x60, 0x60, 0x00, 0x00, // .
+0x00, 0x02, 0x01, 0x51, 0x09, 0x06, 0x00, 0x00, // ?
+0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x00, 0x00, // _
 };
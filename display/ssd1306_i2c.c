@@ -11,7 +11,10 @@
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
 #include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
 #include "ssd1306_font.h"
+#include "rastreio/rastreio.h"
 
 #define SSD1306_HEIGHT              64
 #define SSD1306_WIDTH               128
@@ -67,6 +70,41 @@ struct render_area {
     int buflen;
 };
 
+// Cópia da RAM do painel e, por página, a faixa de colunas que pode ter mudado
+// desde o último render(). Vale para o único framebuffer de tela cheia do jogo.
+static uint8_t shadow[SSD1306_BUF_LEN];
+static bool shadow_valido = false;
+static uint8_t sujo_ini[SSD1306_NUM_PAGES];
+static uint8_t sujo_fim[SSD1306_NUM_PAGES];
+
+static inline void marcar_sujo(int page, int col_ini, int col_fim) {
+    if (sujo_ini[page] > col_ini)
+        sujo_ini[page] = col_ini;
+    if (sujo_fim[page] < col_fim)
+        sujo_fim[page] = col_fim;
+}
+
+static inline void limpar_sujo(int page) {
+    sujo_ini[page] = SSD1306_WIDTH; // ini > fim: página limpa
+    sujo_fim[page] = 0;
+}
+
+void SSD1306_mark_dirty(int col_ini, int page_ini, int col_fim, int page_fim) {
+    for (int p = page_ini; p <= page_fim; p++)
+        marcar_sujo(p, col_ini, col_fim);
+}
+
+// Força o próximo render() a mandar a tela inteira (a RAM do painel é desconhecida)
+void SSD1306_invalidate() {
+    shadow_valido = false;
+}
+
+// Use no lugar de memset(): além de zerar, marca a tela toda como suja
+void SSD1306_clear(uint8_t *buf) {
+    memset(buf, 0, SSD1306_BUF_LEN);
+    SSD1306_mark_dirty(0, 0, SSD1306_WIDTH - 1, SSD1306_NUM_PAGES - 1);
+}
+
 void calc_render_area_buflen(struct render_area *area) {
     // calcular quanto tempo o buffer achatado terá para uma área de renderização
     area->buflen = (area->end_col - area->start_col + 1) * (area->end_page - area->start_page + 1);
@@ -74,7 +112,99 @@ void calc_render_area_buflen(struct render_area *area) {
 
 #ifdef i2c_default
 
+// Fluxo para o DMA: cada palavra vai direto no registrador IC_DATA_CMD, com o
+// byte nos bits 0..7 e o bit STOP no último byte de cada transação. Depois de
+// um STOP o controlador começa sozinho a próxima transação, então uma única
+// transferência de DMA leva todas as janelas (comandos + dados) de um render.
+#define SSD1306_STREAM_LEN (SSD1306_BUF_LEN + SSD1306_NUM_PAGES * 16 + 16)
+static uint16_t stream[SSD1306_STREAM_LEN];
+static uint stream_len = 0;
+
+static int dma_i2c = -1;
+static volatile bool dma_ativo = false;
+static void (*render_done_callback)(void) = NULL;
+
+// Buffer estático com o byte de controle na frente, para o envio bloqueante
+static uint8_t tx_buf[SSD1306_BUF_LEN + 1];
+
+static void dma_i2c_irq_handler(void) {
+    if (dma_i2c < 0 || !dma_channel_get_irq0_status(dma_i2c))
+        return;
+    dma_channel_acknowledge_irq0(dma_i2c);
+    dma_ativo = false;
+    rastreio_fim(RT_RENDER, 0);
+    if (render_done_callback)
+        render_done_callback();
+}
+
+static void dma_i2c_init() {
+    dma_i2c = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(dma_i2c);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(i2c_default, true));
+    dma_channel_configure(dma_i2c, &c, &i2c_get_hw(i2c_default)->data_cmd, stream, 0, false);
+
+    dma_channel_set_irq0_enabled(dma_i2c, true);
+    irq_add_shared_handler(DMA_IRQ_0, dma_i2c_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
+/**
+ * Verdadeiro enquanto houver bytes de um render_async() no DMA, na FIFO ou
+ * no barramento. Se o display não responder (NACK), a transferência é
+ * abortada aqui, o driver volta a ficar livre e o próximo render manda a
+ * tela inteira (não se sabe quanto do quadro chegou ao painel).
+ */
+bool SSD1306_busy() {
+    i2c_hw_t *hw = i2c_get_hw(i2c_default);
+
+    if (dma_i2c >= 0 && (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)) {
+        dma_channel_abort(dma_i2c);
+        dma_channel_acknowledge_irq0(dma_i2c);
+        (void)hw->clr_tx_abrt;
+        dma_ativo = false;
+        SSD1306_invalidate(); // a sombra já conta com os bytes que não chegaram
+        rastreio_fim(RT_RENDER, 0xFFFF); // abortado
+        return false;
+    }
+
+    if (dma_ativo)
+        return true;
+    return !(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_ACTIVITY_BITS);
+}
+
+void SSD1306_wait() {
+    while (SSD1306_busy())
+        tight_loop_contents();
+}
+
+// Chamado na IRQ do DMA quando o último byte foi entregue à FIFO do I2C
+void SSD1306_set_render_callback(void (*callback)(void)) {
+    render_done_callback = callback;
+}
+
+static inline void stream_push(uint8_t byte, bool stop) {
+    stream[stream_len++] = byte | (stop ? I2C_IC_DATA_CMD_STOP_BITS : 0);
+}
+
+// Comandos seguidos de dados numa única transação: cada comando vai com
+// Co = 1 (0x80, "vem outro byte de controle depois"), e o último byte de
+// controle 0x40 (Co = 0, D/C = 1) faz o resto da transação ser RAM gráfica.
+static void stream_janela(const uint8_t *cmds, int num_cmds, const uint8_t *dados, int num) {
+    for (int i = 0; i < num_cmds; i++) {
+        stream_push(0x80, false);
+        stream_push(cmds[i], false);
+    }
+    stream_push(0x40, false);
+    for (int i = 0; i < num; i++)
+        stream_push(dados[i], i == num - 1);
+}
+
 void SSD1306_send_cmd(uint8_t cmd) {
+    SSD1306_wait(); // não intercala com um render_async() em andamento
+
     // O processo de gravação I2C espera um byte de controle seguido por dados
     // esses "dados" podem ser um comando ou dados para acompanhar um comando
     // Co = 1, D/C = 0 => o driver espera um comando
@@ -83,26 +213,30 @@ void SSD1306_send_cmd(uint8_t cmd) {
 }
 
 void SSD1306_send_cmd_list(uint8_t *buf, int num) {
-    for (int i=0;i<num;i++)
-        SSD1306_send_cmd(buf[i]);
+    SSD1306_wait();
+
+    // Co = 0, D/C = 0 => todos os bytes seguintes da transação são comandos,
+    // então a lista inteira vai com um único start/endereço/stop
+    tx_buf[0] = 0x00;
+    memcpy(tx_buf+1, buf, num);
+
+    i2c_write_blocking(i2c_default, SSD1306_I2C_ADDR, tx_buf, num + 1, false);
 }
 
 void SSD1306_send_buf(uint8_t buf[], int buflen) {
+    SSD1306_wait();
+
     // no modo de endereçamento horizontal, o ponteiro de endereço da coluna aumenta automaticamente
     // e depois passa para a próxima página, para que possamos enviar o quadro inteiro
     // buffer em um gooooooo!
 
-    // copia nosso buffer de quadro para um novo buffer porque precisamos adicionar o byte de controle
+    // copia nosso buffer de quadro para um buffer estático porque precisamos adicionar o byte de controle
     // até o início
 
-    uint8_t *temp_buf = malloc(buflen + 1);
-
-    temp_buf[0] = 0x40;
-    memcpy(temp_buf+1, buf, buflen);
-
-    i2c_write_blocking(i2c_default, SSD1306_I2C_ADDR, temp_buf, buflen + 1, false);
+    tx_buf[0] = 0x40;
+    memcpy(tx_buf+1, buf, buflen);
 
-    free(temp_buf);
+    i2c_write_blocking(i2c_default, SSD1306_I2C_ADDR, tx_buf, buflen + 1, false);
 }
 
 void SSD1306_init() {
@@ -168,21 +302,92 @@ void SSD1306_scroll(bool on) {
     };
 
     SSD1306_send_cmd_list(cmds, count_of(cmds));
+    SSD1306_invalidate(); // a rolagem desloca a RAM do painel
 }
 
-void render(uint8_t *buf, struct render_area *area) {
-    // atualizar uma parte da exibição com uma área de renderização
+static void render_janela(const uint8_t *buf, int start_col, int end_col, int start_page, int end_page, int buflen) {
     uint8_t cmds[] = {
         SSD1306_SET_COL_ADDR,
-        area->start_col,
-        area->end_col,
+        start_col,
+        end_col,
         SSD1306_SET_PAGE_ADDR,
-        area->start_page,
-        area->end_page
+        start_page,
+        end_page
     };
 
-    SSD1306_send_cmd_list(cmds, count_of(cmds));
-    SSD1306_send_buf(buf, area->buflen);
+    stream_janela(cmds, count_of(cmds), buf, buflen);
+}
+
+/**
+ * Monta no fluxo estático as janelas que precisam ser atualizadas e dispara o
+ * DMA; retorna sem esperar o I2C. O conteúdo de buf é copiado, então o chamador
+ * pode continuar desenhando. Só espera se o render anterior ainda não terminou.
+ */
+void render_async(uint8_t *buf, struct render_area *area) {
+    if (dma_i2c < 0)
+        dma_i2c_init();
+    SSD1306_wait();
+    stream_len = 0;
+
+    bool tela_cheia = area->start_col == 0 && area->end_col == SSD1306_WIDTH - 1 &&
+                      area->start_page == 0 && area->end_page == SSD1306_NUM_PAGES - 1;
+
+    if (!tela_cheia || !shadow_valido) {
+        // atualizar uma parte da exibição com uma área de renderização
+        render_janela(buf, area->start_col, area->end_col, area->start_page, area->end_page, area->buflen);
+        if (tela_cheia) {
+            memcpy(shadow, buf, SSD1306_BUF_LEN);
+            shadow_valido = true;
+            for (int p = 0; p < SSD1306_NUM_PAGES; p++)
+                limpar_sujo(p);
+        } else if (shadow_valido) {
+            // mantém a cópia do painel em dia com a área que acabou de ser enviada
+            int largura = area->end_col - area->start_col + 1;
+            for (int p = area->start_page; p <= area->end_page; p++)
+                memcpy(shadow + p * SSD1306_WIDTH + area->start_col, buf + (p - area->start_page) * largura, largura);
+        }
+    } else {
+        // Só as páginas sujas, e nelas só as colunas que de fato diferem do painel
+        for (int p = 0; p < SSD1306_NUM_PAGES; p++) {
+            int ini = sujo_ini[p];
+            int fim = sujo_fim[p];
+            limpar_sujo(p);
+            if (ini > fim)
+                continue;
+
+            uint8_t *linha = buf + p * SSD1306_WIDTH;
+            uint8_t *painel = shadow + p * SSD1306_WIDTH;
+            while (ini <= fim && linha[ini] == painel[ini])
+                ini++;
+            if (ini > fim)
+                continue;
+            while (linha[fim] == painel[fim])
+                fim--;
+
+            int n = fim - ini + 1;
+            render_janela(linha + ini, ini, fim, p, p, n);
+            memcpy(painel + ini, linha + ini, n);
+        }
+    }
+
+    if (stream_len == 0)
+        return; // nada mudou
+
+    // Alvo do I2C: o SDK faz o mesmo a cada i2c_write_blocking
+    i2c_hw_t *hw = i2c_get_hw(i2c_default);
+    hw->enable = 0;
+    hw->tar = SSD1306_I2C_ADDR;
+    hw->enable = 1;
+
+    dma_ativo = true;
+    rastreio_inicio(RT_RENDER, stream_len);
+    dma_channel_transfer_from_buffer_now(dma_i2c, stream, stream_len);
+}
+
+// Versão bloqueante: retorna só depois de o quadro inteiro sair pelo I2C
+void render(uint8_t *buf, struct render_area *area) {
+    render_async(buf, area);
+    SSD1306_wait();
 }
 
 static void SetPixel(uint8_t *buf, int x,int y, bool on) {
@@ -209,6 +414,7 @@ static void SetPixel(uint8_t *buf, int x,int y, bool on) {
         byte &= ~(1 << (y % 8));
 
     buf[byte_idx] = byte;
+    marcar_sujo(y / 8, x, x);
 }
 // Bresenhams básicos.
 static void DrawLine(uint8_t *buf, int x0, int y0, int x1, int y1, bool on) {
@@ -256,6 +462,12 @@ static inline int GetFontIndex(uint8_t ch) {
     else if (ch == '.') {
         return 40; // '.' no índice 40
     } 
+    else if (ch == '?') {
+        return 41; // '?' no índice 41
+    }
+    else if (ch == '_') {
+        return 42; // '_' no índice 42
+    }
     else return  0; // Não tenho aquele caractere, então espaço.
 }
 
@@ -273,6 +485,7 @@ static void WriteChar(uint8_t *buf, int16_t x, int16_t y, uint8_t ch) {
     for (int i=0;i<8;i++) {
         buf[fb_idx++] = font[idx * 8 + i];
     }
+    marcar_sujo(y, x, x + 7);
 }
 
 void WriteString(uint8_t *buf, int16_t x, int16_t y, char *str) {
@@ -60,6 +60,13 @@ void SSD1306_send_buf(uint8_t buf[], int buflen);
 void SSD1306_init();
 void SSD1306_scroll(bool on);
 void render(uint8_t *buf, struct render_area *area);
+void render_async(uint8_t *buf, struct render_area *area);
+bool SSD1306_busy();
+void SSD1306_wait();
+void SSD1306_set_render_callback(void (*callback)(void));
+void SSD1306_clear(uint8_t *buf);
+void SSD1306_mark_dirty(int col_ini, int page_ini, int col_fim, int page_fim);
+void SSD1306_invalidate();
 static void SetPixel(uint8_t *buf, int x,int y, bool on);
 static void DrawLine(uint8_t *buf, int x0, int y0, int x1, int y1, bool on);
 static inline int GetFontIndex(uint8_t ch);
@@ -0,0 +1,138 @@
+// entrada/botoes.c
+
+#include "botoes.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+
+typedef struct {
+    uint gpio;
+    bool pressionado;        // último nível estável
+    uint32_t borda_us;       // primeira borda desde o último nível estável
+    uint32_t pressionado_us; // início do aperto atual
+    alarm_id_t alarme_longo;
+    bool longo;              // o aperto atual já gerou BOTAO_LONGO
+} botao_t;
+
+static botao_t botoes[BOTOES_MAX];
+static uint num_botoes = 0;
+
+static botao_evento_t fila[BOTOES_FILA];
+static volatile uint32_t head = 0;
+static volatile uint32_t tail = 0;
+static uint32_t descartados = 0;
+
+static void enfileirar(uint8_t tipo, uint8_t botao, uint32_t t_us, uint32_t duracao_us) {
+  uint32_t status = save_and_disable_interrupts();
+  if (head - tail < BOTOES_FILA) {
+    botao_evento_t *ev = &fila[head % BOTOES_FILA];
+    ev->tipo = tipo;
+    ev->botao = botao;
+    ev->t_us = t_us;
+    ev->duracao_us = duracao_us;
+    head = head + 1;
+  } else {
+    descartados++;
+  }
+  restore_interrupts(status);
+}
+
+static int64_t longo_callback(alarm_id_t id, void *user_data) {
+  botao_t *b = &botoes[(uintptr_t)user_data];
+  b->alarme_longo = 0;
+  if (b->pressionado) {
+    b->longo = true;
+    enfileirar(BOTAO_LONGO, (uintptr_t)user_data, b->pressionado_us, time_us_32() - b->pressionado_us);
+  }
+  return 0;
+}
+
+/**
+ * Fim do debounce: lê o nível já estável, gera o evento se mudou e volta a
+ * escutar as bordas do pino.
+ */
+static int64_t debounce_callback(alarm_id_t id, void *user_data) {
+  uint i = (uintptr_t)user_data;
+  botao_t *b = &botoes[i];
+  bool agora = !gpio_get(b->gpio);
+
+  if (agora != b->pressionado) {
+    b->pressionado = agora;
+    if (agora) {
+      b->pressionado_us = b->borda_us;
+      b->longo = false;
+      enfileirar(BOTAO_PRESSIONADO, i, b->borda_us, 0);
+      b->alarme_longo = add_alarm_in_us(BOTAO_LONGO_US, longo_callback, user_data, true);
+    } else {
+      if (b->alarme_longo) {
+        cancel_alarm(b->alarme_longo);
+        b->alarme_longo = 0;
+      }
+      enfileirar(BOTAO_SOLTO, i, b->borda_us, b->borda_us - b->pressionado_us);
+      if (!b->longo)
+        enfileirar(BOTAO_CURTO, i, b->pressionado_us, b->borda_us - b->pressionado_us);
+    }
+  }
+
+  gpio_acknowledge_irq(b->gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE);
+  gpio_set_irq_enabled(b->gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true);
+
+  // Uma borda entre a leitura e o acknowledge seria perdida: confere de novo
+  if (!gpio_get(b->gpio) != b->pressionado) {
+    b->borda_us = time_us_32();
+    gpio_set_irq_enabled(b->gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, false);
+    return BOTAO_DEBOUNCE_US; // reagenda este mesmo alarme
+  }
+  return 0;
+}
+
+// Primeira borda: guarda o instante e silencia o pino até o contato assentar
+static void gpio_callback(uint gpio, uint32_t events) {
+  for (uint i = 0; i < num_botoes; i++) {
+    if (botoes[i].gpio != gpio)
+      continue;
+    botoes[i].borda_us = time_us_32();
+    gpio_set_irq_enabled(gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, false);
+    add_alarm_in_us(BOTAO_DEBOUNCE_US, debounce_callback, (void *)(uintptr_t)i, true);
+    return;
+  }
+}
+
+uint botoes_adicionar(uint gpio) {
+  hard_assert(num_botoes < BOTOES_MAX); // tabela fixa: aumente BOTOES_MAX
+  uint i = num_botoes++;
+  botao_t *b = &botoes[i];
+
+  gpio_init(gpio);
+  gpio_set_dir(gpio, GPIO_IN);
+  gpio_pull_up(gpio);
+
+  b->gpio = gpio;
+  b->pressionado = !gpio_get(gpio);
+  b->borda_us = 0;
+  b->pressionado_us = 0;
+  b->alarme_longo = 0;
+  b->longo = false;
+
+  gpio_set_irq_enabled_with_callback(gpio, GPIO_IRQ_EDGE_FALL | GPIO_IRQ_EDGE_RISE, true, &gpio_callback);
+  return i;
+}
+
+bool botoes_pop(botao_evento_t *ev) {
+  uint32_t status = save_and_disable_interrupts();
+  bool ok = head != tail;
+  if (ok) {
+    *ev = fila[tail % BOTOES_FILA];
+    tail = tail + 1;
+  }
+  restore_interrupts(status);
+  return ok;
+}
+
+bool botoes_pressionado(uint botao) {
+  return botoes[botao].pressionado;
+}
+
+uint32_t botoes_descartados(void) {
+  return descartados;
+}
@@ -0,0 +1,37 @@
+// entrada/botoes.h
+
+#ifndef BOTOES_H
+#define BOTOES_H
+
+#include "pico/stdlib.h"
+
+#define BOTOES_MAX 4
+#define BOTOES_FILA 16
+
+#define BOTAO_DEBOUNCE_US   5000    // espera o contato assentar antes de ler o nível
+#define BOTAO_LONGO_US      800000  // segurar mais que isso gera BOTAO_LONGO
+
+typedef enum {
+    BOTAO_PRESSIONADO = 1,
+    BOTAO_SOLTO,
+    BOTAO_LONGO,
+    BOTAO_CURTO,         // solto antes de BOTAO_LONGO_US: depois de BOTAO_SOLTO, só se não houve BOTAO_LONGO
+} botao_evento_tipo_t;
+
+typedef struct {
+    uint8_t tipo;        // botao_evento_tipo_t
+    uint8_t botao;       // índice devolvido por botoes_adicionar()
+    uint32_t t_us;       // instante da primeira borda (time_us_32), não do fim do debounce;
+                         // em BOTAO_LONGO e BOTAO_CURTO, a do aperto
+    uint32_t duracao_us; // BOTAO_SOLTO/BOTAO_LONGO/BOTAO_CURTO: tempo desde que foi pressionado
+} botao_evento_t;
+
+// Botão ativo em nível baixo com pull-up interno; retorna o índice do botão.
+// No máximo BOTOES_MAX botões (passar disso é erro de programa: hard_assert)
+uint botoes_adicionar(uint gpio);
+
+bool botoes_pop(botao_evento_t *ev);
+bool botoes_pressionado(uint botao);
+uint32_t botoes_descartados(void);
+
+#endif
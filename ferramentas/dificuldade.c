@@ -0,0 +1,101 @@
+// ferramentas/dificuldade.c
+
+#include "dificuldade.h"
+#include <string.h>
+
+// Quanto cada característica soma na pontuação
+#define PESO_LETRA    2
+#define PESO_SILABA   3
+#define PESO_DIGRAFO  6
+#define PESO_H_MUDO   8
+#define PESO_AMBIGUA  5
+#define PESO_ACENTO   6
+#define PESO_RARIDADE 2
+
+#define PESO_SORTEIO_MAX 15
+
+// Raridade de cada letra no português: 0 comum, 1 média, 2 rara, 4 estrangeira
+static const uint8_t RARIDADE[26] = {
+  //a  b  c  d  e  f  g  h  i  j  k  l  m  n  o  p  q  r  s  t  u  v  w  x  y  z
+    0, 1, 0, 0, 0, 1, 1, 1, 0, 2, 4, 0, 0, 0, 0, 1, 1, 0, 0, 0, 0, 1, 4, 2, 4, 2,
+};
+
+static int vogal(char c) {
+  return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u' || c == 'y';
+}
+
+static int e_ou_i(char c) {
+  return c == 'e' || c == 'i' || c == 'y';
+}
+
+// O u de que/qui/gue/gui não é pronunciado
+static int u_mudo(const char *w, unsigned i, unsigned n) {
+  return w[i] == 'u' && i > 0 && (w[i - 1] == 'q' || w[i - 1] == 'g') && i + 1 < n && e_ou_i(w[i + 1]);
+}
+
+void dificuldade_medir(const char *w, const uint8_t *original, unsigned bytes_original,
+                       dificuldade_t *d) {
+  memset(d, 0, sizeof(*d));
+  unsigned n = (unsigned)strlen(w);
+  d->letras = (uint8_t)n;
+
+  for (unsigned i = 0; i < n; i++)
+    d->raridade += RARIDADE[w[i] - 'a'];
+
+  for (unsigned i = 0; i < n; i++) {
+    char c = w[i], prox = i + 1 < n ? w[i + 1] : '\0', ant = i ? w[i - 1] : '\0';
+
+    if ((c == 'l' || c == 'n' || c == 'c') && prox == 'h') {
+      d->digrafos++;
+      i++;  // o h já foi contado no dígrafo
+      continue;
+    }
+    if ((c == 'r' || c == 's') && prox == c) {
+      d->digrafos++;
+      i++;
+      continue;
+    }
+    if (u_mudo(w, i + 1, n)) {
+      d->digrafos++;
+      i++;
+      continue;
+    }
+
+    if (c == 'h')
+      d->h_mudo++;
+    else if (c == 'x' || c == 'z')
+      d->ambiguas++;
+    else if (c == 's' && prox == 'c' && i + 2 < n && e_ou_i(w[i + 2])) {
+      d->ambiguas++;  // nascer, piscina: sc conta uma vez
+      i++;
+    } else if (c == 's' && vogal(ant) && vogal(prox))
+      d->ambiguas++;  // casa: som de z
+    else if ((c == 'c' || c == 'g') && e_ou_i(prox))
+      d->ambiguas++;
+  }
+
+  // Cada grupo de vogais pronunciadas é uma sílaba
+  int anterior_vogal = 0;
+  for (unsigned i = 0; i < n; i++) {
+    int v = vogal(w[i]) && !u_mudo(w, i, n);
+    if (v && !anterior_vogal)
+      d->silabas++;
+    anterior_vogal = v;
+  }
+
+  // Cada caractere multibyte da original que virou letra na normalizada era acentuado
+  for (unsigned i = 0; i < bytes_original; i++)
+    if (original[i] == 0xC3)
+      d->acentos++;
+}
+
+uint16_t dificuldade_pontuar(const dificuldade_t *d) {
+  return (uint16_t)(PESO_LETRA * d->letras + PESO_SILABA * d->silabas + PESO_DIGRAFO * d->digrafos +
+                    PESO_H_MUDO * d->h_mudo + PESO_AMBIGUA * d->ambiguas + PESO_ACENTO * d->acentos +
+                    PESO_RARIDADE * d->raridade);
+}
+
+uint8_t dificuldade_peso(const dificuldade_t *d) {
+  unsigned armadilhas = d->digrafos + d->h_mudo + d->ambiguas + d->acentos;
+  return (uint8_t)(1 + (armadilhas < PESO_SORTEIO_MAX - 1 ? armadilhas : PESO_SORTEIO_MAX - 1));
+}
@@ -0,0 +1,29 @@
+// ferramentas/dificuldade.h
+
+#ifndef DIFICULDADE_H
+#define DIFICULDADE_H
+
+#include <stdint.h>
+
+// O que torna uma palavra difícil de soletrar, medido na forma normalizada
+// (a-z) e, para os acentos, na original
+typedef struct {
+  uint8_t letras;
+  uint8_t silabas;    // grupos de vogais (hiatos contam como um)
+  uint8_t digrafos;   // lh, nh, ch, rr, ss e o u mudo de qu/gu antes de e/i
+  uint8_t h_mudo;     // h fora de lh/nh/ch (hora, bahia)
+  uint8_t ambiguas;   // s entre vogais, z, x, c/g antes de e/i, sc antes de e/i
+  uint8_t acentos;    // letras com diacrítico na original (á, ç, õ...)
+  uint8_t raridade;   // soma da raridade das letras (j, x, z; k, w, y valem mais)
+} dificuldade_t;
+
+void dificuldade_medir(const char *normalizada, const uint8_t *original, unsigned bytes_original,
+                       dificuldade_t *d);
+
+// Pontuação única (quanto maior, mais difícil); os níveis são quantis dela
+uint16_t dificuldade_pontuar(const dificuldade_t *d);
+
+// Peso no sorteio dentro do nível: palavras com mais armadilhas saem mais
+uint8_t dificuldade_peso(const dificuldade_t *d);
+
+#endif
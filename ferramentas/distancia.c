@@ -0,0 +1,232 @@
+// ferramentas/distancia.c
+
+#include "distancia.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIMBOLOS 27  // a-z e "qualquer outro", que não casa com nada
+
+struct distancia_dicionario {
+  char *textos;          // palavras terminadas em '\0', por tamanho e depois em ordem alfabética
+  uint32_t *offsets;
+  uint64_t *assinaturas;  // ver assinatura_de()
+  uint32_t num_palavras;
+  uint32_t inicio[DISTANCIA_MAX_LETRAS + 2];  // palavras de n letras: [inicio[n], inicio[n + 1])
+};
+
+static unsigned simbolo(char c) {
+  return c >= 'a' && c <= 'z' ? (unsigned)(c - 'a') : SIMBOLOS - 1;
+}
+
+/**
+ * Bit l: a letra l aparece; bit 32 + l: aparece duas ou mais vezes. Inserir,
+ * apagar ou trocar uma letra muda a contagem de no máximo duas letras em 1,
+ * então liga no máximo um bit de um lado e desliga no máximo um do outro.
+ */
+static uint64_t assinatura_de(const char *s) {
+  uint64_t m = 0;
+  for (; *s; s++) {
+    if (*s < 'a' || *s > 'z')
+      continue;
+    uint64_t bit = 1ull << (*s - 'a');
+    m |= m & bit ? bit << 32 : bit;
+  }
+  return m;
+}
+
+// Máscaras de ocorrência de cada símbolo no padrão (bit i = posição i)
+static void preparar(const char *p, int m, uint64_t *peq) {
+  memset(peq, 0, SIMBOLOS * sizeof(uint64_t));
+  for (int i = 0; i < m; i++)
+    if (simbolo(p[i]) < SIMBOLOS - 1)
+      peq[simbolo(p[i])] |= 1ull << i;
+}
+
+/**
+ * Myers/Hyyrö: uma coluna da matriz de edição por caractere de t, com os
+ * deltas verticais do padrão inteiro em duas palavras de 64 bits. A linha 0
+ * cresce de 1 a cada coluna (distância global, não busca de substring).
+ * D[m][n] >= D[m][j] - (n - j), então dá para desistir assim que passar de k.
+ */
+static int myers(const uint64_t *peq, int m, const char *t, int n, int k) {
+  if (m == 0)
+    return n <= k ? n : k + 1;
+
+  uint64_t pv = ~0ull, mv = 0, ultimo = 1ull << (m - 1);
+  int pontos = m;
+  for (int j = 0; j < n; j++) {
+    uint64_t eq = peq[simbolo(t[j])];
+    uint64_t xv = eq | mv;
+    uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+    if (ph & ultimo)
+      pontos++;
+    else if (mh & ultimo)
+      pontos--;
+    ph = (ph << 1) | 1;
+    mh <<= 1;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    if (pontos - (n - 1 - j) > k)
+      return k + 1;
+  }
+  return pontos <= k ? pontos : k + 1;
+}
+
+int distancia_levenshtein(const char *a, const char *b, int k) {
+  int m = (int)strlen(a), n = (int)strlen(b);
+  if (m > DISTANCIA_MAX_LETRAS)
+    return -1;
+  if (m - n > k || n - m > k)
+    return k + 1;
+  uint64_t peq[SIMBOLOS];
+  preparar(a, m, peq);
+  return myers(peq, m, b, n, k);
+}
+
+static const char *textos_ordenacao;
+
+static int comparar_offsets(const void *a, const void *b) {
+  return strcmp(textos_ordenacao + *(const uint32_t *)a, textos_ordenacao + *(const uint32_t *)b);
+}
+
+static uint32_t ler_u32(const uint8_t *p) {
+  return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+// Lê só as formas normalizadas do índice (formato em indexar_palavras.c)
+distancia_dicionario_t *distancia_abrir(const char *caminho_indice) {
+  FILE *f = fopen(caminho_indice, "rb");
+  if (f == NULL)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  long tam = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t *idx = malloc((size_t)tam);
+  size_t lidos = idx ? fread(idx, 1, (size_t)tam, f) : 0;
+  fclose(f);
+  if (lidos != (size_t)tam || tam < 40 || memcmp(idx, "SPIX\x02\x00", 6) != 0) {
+    free(idx);
+    return NULL;
+  }
+
+  uint32_t n = ler_u32(idx + 8), off_entradas = ler_u32(idx + 16), off_textos = ler_u32(idx + 20);
+  distancia_dicionario_t *d = calloc(1, sizeof(*d));
+  d->offsets = malloc(n * sizeof(uint32_t));
+  d->assinaturas = malloc(n * sizeof(uint64_t));
+
+  // Conta por tamanho para já gravar agrupado
+  size_t tam_textos = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    uint8_t letras = idx[off_entradas + 8 * i + 4];
+    if (letras <= DISTANCIA_MAX_LETRAS) {
+      d->inicio[letras + 1]++;
+      tam_textos += letras + 1u;
+    }
+  }
+  for (unsigned l = 1; l < DISTANCIA_MAX_LETRAS + 2; l++)
+    d->inicio[l] += d->inicio[l - 1];
+  d->textos = malloc(tam_textos);
+
+  uint32_t proximo[DISTANCIA_MAX_LETRAS + 1];
+  memcpy(proximo, d->inicio, sizeof(proximo));
+  size_t pos = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    const uint8_t *e = idx + off_entradas + 8 * i;
+    uint8_t letras = e[4];
+    if (letras > DISTANCIA_MAX_LETRAS)
+      continue;
+    uint32_t j = proximo[letras]++;
+    memcpy(d->textos + pos, idx + off_textos + ler_u32(e), letras);
+    d->textos[pos + letras] = '\0';
+    d->offsets[j] = (uint32_t)pos;
+    pos += letras + 1u;
+  }
+  d->num_palavras = d->inicio[DISTANCIA_MAX_LETRAS + 1];
+  free(idx);
+
+  // Ordem alfabética dentro de cada tamanho, para os empates saírem estáveis
+  textos_ordenacao = d->textos;
+  for (unsigned l = 0; l <= DISTANCIA_MAX_LETRAS; l++)
+    qsort(d->offsets + d->inicio[l], d->inicio[l + 1] - d->inicio[l], sizeof(uint32_t), comparar_offsets);
+  for (uint32_t i = 0; i < d->num_palavras; i++)
+    d->assinaturas[i] = assinatura_de(d->textos + d->offsets[i]);
+  return d;
+}
+
+void distancia_fechar(distancia_dicionario_t *d) {
+  if (d == NULL)
+    return;
+  free(d->textos);
+  free(d->offsets);
+  free(d->assinaturas);
+  free(d);
+}
+
+uint32_t distancia_num_palavras(const distancia_dicionario_t *d) {
+  return d->num_palavras;
+}
+
+const char *distancia_palavra(const distancia_dicionario_t *d, uint32_t i) {
+  return i < d->num_palavras ? d->textos + d->offsets[i] : NULL;
+}
+
+// popcount(x) > n, sem contar tudo: n é pequeno (o limite de distância)
+static int mais_de(uint64_t x, int n) {
+  while (n-- > 0 && x)
+    x &= x - 1;
+  return x != 0;
+}
+
+/**
+ * Candidatas só nos tamanhos m - k .. m + k. Antes do Myers, o filtro de
+ * assinatura: como cada edição muda no máximo um bit de cada lado, a
+ * distância é pelo menos o maior dos dois lados da diferença entre elas.
+ */
+int distancia_vizinhas(const distancia_dicionario_t *d, const char *consulta, int k, int max,
+                       uint32_t *indices, uint8_t *distancias) {
+  int m = (int)strlen(consulta);
+  if (m > DISTANCIA_MAX_LETRAS || max <= 0 || k < 0)
+    return 0;
+
+  uint64_t peq[SIMBOLOS];
+  preparar(consulta, m, peq);
+  uint64_t aq = assinatura_de(consulta);
+  int achadas = 0;
+
+  // A ordem de visita já é a ordem de desempate: tamanho mais perto da consulta,
+  // o mais curto primeiro, e alfabética. Com a lista cheia, só entra quem for
+  // estritamente melhor que a pior, o que aperta o limite do Myers.
+  for (int dl = 0; dl <= k; dl++) {
+    for (int lado = 0; lado < (dl ? 2 : 1); lado++) {
+      int n = lado ? m + dl : m - dl;
+      if (n < 0 || n > DISTANCIA_MAX_LETRAS)
+        continue;
+      for (uint32_t i = d->inicio[n]; i < d->inicio[n + 1]; i++) {
+        int limite = achadas == max ? distancias[max - 1] - 1 : k;
+        if (dl > limite)
+          return achadas;
+        uint64_t aw = d->assinaturas[i];
+        if (mais_de(aq & ~aw, limite) || mais_de(aw & ~aq, limite))
+          continue;
+
+        int dist = myers(peq, m, d->textos + d->offsets[i], n, limite);
+        if (dist > limite)
+          continue;
+
+        // Inserção por distância; entre iguais, quem chegou antes fica na frente
+        int pos = achadas < max ? achadas++ : max - 1;
+        while (pos > 0 && distancias[pos - 1] > dist) {
+          indices[pos] = indices[pos - 1];
+          distancias[pos] = distancias[pos - 1];
+          pos--;
+        }
+        indices[pos] = i;
+        distancias[pos] = (uint8_t)dist;
+      }
+    }
+  }
+  return achadas;
+}
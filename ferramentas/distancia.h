@@ -0,0 +1,39 @@
+// ferramentas/distancia.h
+
+#ifndef DISTANCIA_H
+#define DISTANCIA_H
+
+#include <stdint.h>
+
+// Distância de edição bit-paralela (Myers/Hyyrö) e busca das palavras mais
+// próximas no índice (indexar_palavras). Compilada como biblioteca
+// compartilhada para o python/distancia.py (ctypes); só palavras a-z de até
+// DISTANCIA_MAX_LETRAS letras.
+
+#define DISTANCIA_MAX_LETRAS 64
+
+typedef struct distancia_dicionario distancia_dicionario_t;
+
+/**
+ * Levenshtein entre a e b, com limite: se passar de k, para cedo e retorna k + 1.
+ * Retorna -1 se a tiver mais de DISTANCIA_MAX_LETRAS letras.
+ */
+int distancia_levenshtein(const char *a, const char *b, int k);
+
+// Carrega as formas normalizadas de um palavras.idx; NULL se não for um índice válido
+distancia_dicionario_t *distancia_abrir(const char *caminho_indice);
+void distancia_fechar(distancia_dicionario_t *d);
+uint32_t distancia_num_palavras(const distancia_dicionario_t *d);
+
+// Forma normalizada da palavra i (ordem interna: por tamanho), terminada em '\0'
+const char *distancia_palavra(const distancia_dicionario_t *d, uint32_t i);
+
+/**
+ * As até "max" palavras a distância <= k da consulta, da mais próxima para a mais
+ * distante. Empates: tamanho mais perto do da consulta, depois a mais curta,
+ * depois ordem alfabética. Retorna quantas achou.
+ */
+int distancia_vizinhas(const distancia_dicionario_t *d, const char *consulta, int k, int max,
+                       uint32_t *indices, uint8_t *distancias);
+
+#endif
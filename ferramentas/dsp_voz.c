@@ -0,0 +1,270 @@
+// ferramentas/dsp_voz.c
+
+#include "dsp_voz.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAPS DSP_VOZ_TAPS_POR_FASE
+#define FATOR_MAX 4
+#define LOTE 256            // amostras de entrada por passada do FIR
+#define CORTE_DC_HZ 20.0f
+#define BLOCOS_POR_SEGUNDO 100  // energia medida em blocos de 10 ms
+#define SILENCIO_MIN_BLOCOS 70  // min_silence_len = 700 ms
+#define MARGEM_BLOCOS 30        // keep_silence = 300 ms
+#define PAUSA_MS 200            // silêncio entre trechos e nas pontas
+#define LIMIAR_DB 14.0          // silêncio: 14 dB abaixo da energia média
+#define FOLGA_DB 0.1            // pico normalizado em -0,1 dBFS
+
+struct dsp_voz {
+  int fator;
+  size_t bloco;  // amostras de entrada por bloco de energia
+
+  // Passa-altas de um polo para o DC: y = x - x_ant + r * y_ant
+  float r, x_ant, y_ant;
+  int iniciou;
+
+  // Entrada sem DC, com TAPS - 1 zeros na frente (histórico inicial do FIR)
+  float *entrada;
+  size_t n_entrada, cap_entrada;
+  float *reamostrado;
+  size_t n_reamostrado, cap_reamostrado;
+  // Coeficientes de cada fase, já invertidos: fase p = sum coef[p][j] * x[n - TAPS + 1 + j]
+  float coef[FATOR_MAX][TAPS];
+
+  // Energia média quadrática de cada bloco e estatísticas da captura inteira
+  float *energias;
+  size_t n_blocos, cap_blocos;
+  double soma_bloco, soma_total;
+  size_t no_bloco, n_amostras;
+  float pico;
+
+  int16_t *saida;
+  size_t n_saida;
+};
+
+static int garantir(void **p, size_t *cap, size_t n, size_t tam) {
+  if (n <= *cap)
+    return 0;
+  size_t nova = *cap ? *cap : 4096;
+  while (nova < n)
+    nova *= 2;
+  void *q = realloc(*p, nova * tam);
+  if (q == NULL)
+    return -1;
+  *p = q;
+  *cap = nova;
+  return 0;
+}
+
+/**
+ * Passa-baixas sinc janelado (Blackman) na taxa de saída, corte em 90% do
+ * Nyquist da entrada, repartido em "fator" fases de TAPS coeficientes: cada
+ * amostra de entrada gera uma saída por fase, sem multiplicar pelos zeros
+ * que a interpolação inseriria. Cada fase é normalizada para ganho 1 em DC.
+ */
+static void projetar_filtro(dsp_voz_t *d) {
+  int n = d->fator * TAPS;
+  double c = (n - 1) / 2.0, fc = 0.45 / d->fator;
+  double h[FATOR_MAX * TAPS];
+  for (int i = 0; i < n; i++) {
+    double x = 2.0 * fc * (i - c);
+    double sinc = fabs(x) < 1e-12 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+    double w = 0.42 - 0.5 * cos(2.0 * M_PI * i / (n - 1)) + 0.08 * cos(4.0 * M_PI * i / (n - 1));
+    h[i] = 2.0 * fc * sinc * w;
+  }
+  for (int p = 0; p < d->fator; p++) {
+    double soma = 0;
+    for (int k = 0; k < TAPS; k++)
+      soma += h[p + k * d->fator];
+    for (int j = 0; j < TAPS; j++)
+      d->coef[p][j] = (float)(h[p + (TAPS - 1 - j) * d->fator] / soma);
+  }
+}
+
+dsp_voz_t *dsp_voz_criar(int taxa_entrada) {
+  if (taxa_entrada <= 0 || DSP_VOZ_TAXA_SAIDA % taxa_entrada != 0 ||
+      DSP_VOZ_TAXA_SAIDA / taxa_entrada > FATOR_MAX)
+    return NULL;
+  dsp_voz_t *d = calloc(1, sizeof(*d));
+  if (d == NULL)
+    return NULL;
+  d->fator = DSP_VOZ_TAXA_SAIDA / taxa_entrada;
+  d->bloco = (size_t)(taxa_entrada / BLOCOS_POR_SEGUNDO);
+  d->r = 1.0f - 2.0f * (float)M_PI * CORTE_DC_HZ / (float)taxa_entrada;
+  projetar_filtro(d);
+  if (garantir((void **)&d->entrada, &d->cap_entrada, TAPS - 1, sizeof(float)) != 0) {
+    free(d);
+    return NULL;
+  }
+  memset(d->entrada, 0, (TAPS - 1) * sizeof(float));
+  d->n_entrada = TAPS - 1;
+  return d;
+}
+
+void dsp_voz_destruir(dsp_voz_t *d) {
+  if (d == NULL)
+    return;
+  free(d->entrada);
+  free(d->reamostrado);
+  free(d->energias);
+  free(d->saida);
+  free(d);
+}
+
+/**
+ * Reamostra as n amostras de entrada a partir de "ini" (índice em entrada).
+ * O laço interno corre sobre amostras consecutivas com o coeficiente fixo,
+ * sem dependência entre iterações, e o compilador o vetoriza (-O3) sem
+ * precisar reordenar somas de ponto flutuante.
+ */
+static int reamostrar(dsp_voz_t *d, size_t ini, size_t n) {
+  if (garantir((void **)&d->reamostrado, &d->cap_reamostrado, d->n_reamostrado + n * d->fator,
+               sizeof(float)) != 0)
+    return -1;
+  float fase[LOTE];
+  for (size_t base = 0; base < n; base += LOTE) {
+    size_t m = n - base < LOTE ? n - base : LOTE;
+    const float *restrict x = d->entrada + ini + base - (TAPS - 1);
+    float *y = d->reamostrado + d->n_reamostrado + base * d->fator;
+    for (int p = 0; p < d->fator; p++) {
+      float *restrict f = fase;
+      memset(f, 0, m * sizeof(float));
+      for (int j = 0; j < TAPS; j++) {
+        float h = d->coef[p][j];
+        for (size_t i = 0; i < m; i++)
+          f[i] += h * x[i + j];
+      }
+      for (size_t i = 0; i < m; i++)
+        y[i * d->fator + p] = f[i];
+    }
+  }
+  d->n_reamostrado += n * d->fator;
+  return 0;
+}
+
+static int fechar_bloco(dsp_voz_t *d) {
+  if (garantir((void **)&d->energias, &d->cap_blocos, d->n_blocos + 1, sizeof(float)) != 0)
+    return -1;
+  d->energias[d->n_blocos++] = (float)(d->soma_bloco / d->no_bloco);
+  d->soma_bloco = 0;
+  d->no_bloco = 0;
+  return 0;
+}
+
+int dsp_voz_empurrar(dsp_voz_t *d, const int16_t *amostras, size_t n) {
+  if (n == 0)
+    return 0;
+  if (garantir((void **)&d->entrada, &d->cap_entrada, d->n_entrada + n, sizeof(float)) != 0)
+    return -1;
+  if (!d->iniciou) {
+    d->x_ant = amostras[0];  // sem degrau no início: o filtro parte do nível DC da captura
+    d->iniciou = 1;
+  }
+
+  size_t ini = d->n_entrada;
+  for (size_t i = 0; i < n; i++) {
+    float x = amostras[i];
+    float y = x - d->x_ant + d->r * d->y_ant;
+    d->x_ant = x;
+    d->y_ant = y;
+    d->entrada[d->n_entrada++] = y;
+
+    float a = fabsf(y);
+    if (a > d->pico)
+      d->pico = a;
+    d->soma_bloco += (double)y * y;
+    d->soma_total += (double)y * y;
+    if (++d->no_bloco == d->bloco && fechar_bloco(d) != 0)
+      return -1;
+  }
+  d->n_amostras += n;
+  return reamostrar(d, ini, n);
+}
+
+/**
+ * Copia [ini, fim) da saída reamostrada (já compensado o atraso do FIR) com o
+ * ganho, arredondando e saturando em 16 bits. ini e fim em amostras de saída.
+ */
+static void copiar(dsp_voz_t *d, size_t ini, size_t fim, float ganho) {
+  size_t atraso = (size_t)(d->fator * TAPS - 1) / 2;
+  for (size_t i = ini; i < fim; i++) {
+    float v = d->reamostrado[i + atraso] * ganho;
+    v = v > 32767.0f ? 32767.0f : v < -32768.0f ? -32768.0f : v;
+    d->saida[d->n_saida++] = (int16_t)lrintf(v);
+  }
+}
+
+static void pausa(dsp_voz_t *d) {
+  size_t n = (size_t)DSP_VOZ_TAXA_SAIDA * PAUSA_MS / 1000;
+  memset(d->saida + d->n_saida, 0, n * sizeof(int16_t));
+  d->n_saida += n;
+}
+
+// Blocos [ini, fim) e MARGEM_BLOCOS dos silêncios vizinhos, seguidos de uma pausa
+static void trecho(dsp_voz_t *d, size_t ini, size_t fim, float ganho, int primeiro) {
+  size_t por_bloco = d->bloco * d->fator, total = d->n_amostras * d->fator;
+  ini = ini > MARGEM_BLOCOS ? ini - MARGEM_BLOCOS : 0;
+  fim = fim + MARGEM_BLOCOS < d->n_blocos ? fim + MARGEM_BLOCOS : d->n_blocos;
+  if (primeiro)
+    pausa(d);
+  copiar(d, ini * por_bloco, fim * por_bloco < total ? fim * por_bloco : total, ganho);
+  pausa(d);
+}
+
+size_t dsp_voz_finalizar(dsp_voz_t *d) {
+  d->n_saida = 0;
+  if (d->n_amostras == 0)
+    return 0;
+  if (d->no_bloco > 0 && fechar_bloco(d) != 0)
+    return 0;
+
+  // Esvazia o FIR com zeros (fora das estatísticas) para o fim não ficar preso nele
+  size_t ini = d->n_entrada;
+  if (garantir((void **)&d->entrada, &d->cap_entrada, d->n_entrada + TAPS - 1, sizeof(float)) != 0)
+    return 0;
+  memset(d->entrada + ini, 0, (TAPS - 1) * sizeof(float));
+  d->n_entrada += TAPS - 1;
+  if (reamostrar(d, ini, TAPS - 1) != 0)
+    return 0;
+
+  size_t total = d->n_amostras * d->fator;
+  size_t n_pausa = (size_t)DSP_VOZ_TAXA_SAIDA * PAUSA_MS / 1000;
+  // Pior caso: um trecho a cada silêncio mínimo, cada um com a sua pausa
+  size_t max_saida = total + n_pausa * (d->n_blocos / SILENCIO_MIN_BLOCOS + 2);
+  free(d->saida);
+  d->saida = malloc(max_saida * sizeof(int16_t));
+  if (d->saida == NULL)
+    return 0;
+
+  float ganho = d->pico > 0 ? (float)(32767.0 * pow(10.0, -FOLGA_DB / 20.0) / d->pico) : 1.0f;
+  float limiar = (float)(d->soma_total / d->n_amostras * pow(10.0, -LIMIAR_DB / 10.0));
+
+  // Trechos = o que sobra entre silêncios de SILENCIO_MIN_BLOCOS blocos ou mais
+  size_t trechos = 0, inicio = 0;
+  for (size_t b = 0; b < d->n_blocos;) {
+    if (d->energias[b] >= limiar) {
+      b++;
+      continue;
+    }
+    size_t fim = b;
+    while (fim < d->n_blocos && d->energias[fim] < limiar)
+      fim++;
+    if (fim - b >= SILENCIO_MIN_BLOCOS) {
+      if (b > inicio)
+        trecho(d, inicio, b, ganho, trechos++ == 0);
+      inicio = fim;
+    }
+    b = fim;
+  }
+  if (d->n_blocos > inicio)
+    trecho(d, inicio, d->n_blocos, ganho, trechos++ == 0);
+
+  if (trechos == 0)
+    copiar(d, 0, total, ganho);  // nada além de silêncio: devolve tudo
+  return d->n_saida;
+}
+
+const int16_t *dsp_voz_saida(const dsp_voz_t *d) {
+  return d->saida;
+}
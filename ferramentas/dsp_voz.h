@@ -0,0 +1,39 @@
+// ferramentas/dsp_voz.h
+
+#ifndef DSP_VOZ_H
+#define DSP_VOZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Pré-processamento da fala antes do ASR, em memória e em fluxo: os blocos de
+// amostras entram à medida que chegam da Pico (remoção de DC, energia por
+// bloco, pico e reamostragem para DSP_VOZ_TAXA_SAIDA); no fim da captura só
+// falta cortar os silêncios e aplicar o ganho. Mesmos parâmetros do pydub
+// usado antes (normalize + split_on_silence). Compilada como biblioteca
+// compartilhada para o python/dsp_voz.py (ctypes).
+
+#define DSP_VOZ_TAXA_SAIDA 16000
+#define DSP_VOZ_TAPS_POR_FASE 16  // FIR de reamostragem: fator * 16 coeficientes
+
+typedef struct dsp_voz dsp_voz_t;
+
+// NULL se DSP_VOZ_TAXA_SAIDA não for múltiplo de taxa_entrada (fator 1..4)
+dsp_voz_t *dsp_voz_criar(int taxa_entrada);
+void dsp_voz_destruir(dsp_voz_t *d);
+
+// Processa mais n amostras da captura. Retorna 0, ou -1 sem memória.
+int dsp_voz_empurrar(dsp_voz_t *d, const int16_t *amostras, size_t n);
+
+/**
+ * Fecha a captura: corta silêncios de 700 ms ou mais (deixando 300 ms de cada
+ * lado e 200 ms de silêncio entre os trechos), normaliza o pico em -0,1 dBFS e
+ * retorna o número de amostras em dsp_voz_saida(), a DSP_VOZ_TAXA_SAIDA.
+ * Sem nenhum trecho de fala, devolve a captura inteira só normalizada.
+ */
+size_t dsp_voz_finalizar(dsp_voz_t *d);
+
+// Amostras de 16 bits produzidas pelo último dsp_voz_finalizar(); válidas até destruir
+const int16_t *dsp_voz_saida(const dsp_voz_t *d);
+
+#endif
@@ -0,0 +1,375 @@
+// ferramentas/indexar_palavras.c
+//
+// Indexador do servidor de palavras (host): lê a lista de palavras uma vez,
+// mede a dificuldade de cada uma (dificuldade.c) e grava um índice binário
+// que o python/indice_palavras.py abre com mmap, sem nenhum parse por rodada.
+// Uso:
+//
+//   indexar_palavras dataset/palavras.txt dataset/palavras.idx [--niveis N]
+//
+// Os níveis são quantis da pontuação de dificuldade dentro de cada tamanho: o
+// nível 0 tem o 1/N mais fácil das palavras de cada tamanho, o N-1 o mais difícil.
+//
+// Formato (little-endian):
+//
+//   cabeçalho, 40 bytes
+//     char magic[4]        "SPIX"
+//     u16  versao          2
+//     u8   letras_max      palavras normalizadas de 0..letras_max letras
+//     u8   niveis
+//     u32  num_palavras
+//     u32  off_baldes      niveis * (letras_max + 1) * 26 + 1 u32: início de cada
+//                          balde em "entradas"; o balde b vai de baldes[b] a baldes[b + 1]
+//     u32  off_entradas    num_palavras entradas de 8 bytes
+//     u32  off_textos
+//     u32  tam_textos
+//     u32  off_pesos       niveis * (letras_max + 1) u32: soma dos pesos de cada
+//                          faixa (nível, letras)
+//     u32  off_amostragem  num_palavras pares u32 (limiar, alias): tabela de alias
+//                          de cada faixa (nível, letras), na mesma ordem das entradas
+//     u32  reservado
+//
+//   entrada: u32 texto (offset em textos), u8 letras, u8 bytes_original, u16 pontuação
+//   textos:  forma normalizada seguida da original (UTF-8), sem terminador
+//
+// O balde de uma palavra é ((nivel * (letras_max + 1)) + letras) * 26 + (inicial - 'a'),
+// então um nível, ou um nível e tamanho, é uma faixa contígua. O sorteio ponderado
+// numa faixa (nível, letras) é O(1): índice i uniforme e u de 32 bits uniforme;
+// fica i se u < limiar[i], senão alias[i] (método de Vose).
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dificuldade.h"
+
+#define VERSAO 2
+#define LETRAS_MAX 63
+#define NIVEIS_PADRAO 10
+#define INICIAIS 26
+#define TAM_CABECALHO 40
+
+typedef struct {
+  const char *original;  // aponta para o texto lido
+  uint8_t bytes_original;
+  uint8_t letras;
+  uint8_t nivel;
+  uint8_t peso;
+  uint16_t pontuacao;
+  uint32_t desempate;  // hash da palavra: empates não ficam em ordem alfabética
+  char normalizada[LETRAS_MAX + 1];
+} palavra_t;
+
+// U+00C0..U+00FF sem o acento, como o NFKD do normalize_string (python/texto.py);
+// '-' são os que o NFKD não decompõe e por isso somem (æ, ð, ø, ß...)
+static const char LATIN1[] = "aaaaaa-ceeeeiiii-nooooo--uuuuy--"
+                             "aaaaaa-ceeeeiiii-nooooo--uuuuy-y";
+
+static unsigned letras_max = 0;
+
+/**
+ * Mesma forma que normalize_string: minúsculas, sem acentos, só a-z.
+ * Retorna o número de letras (0 se nada sobrou ou se passou de LETRAS_MAX).
+ */
+static unsigned normalizar(const uint8_t *s, unsigned n, char *dst) {
+  unsigned letras = 0;
+  for (unsigned i = 0; i < n; i++) {
+    char c = 0;
+    if (s[i] < 0x80) {
+      c = (char)s[i];
+      if (c >= 'A' && c <= 'Z')
+        c += 'a' - 'A';
+    } else if (s[i] == 0xC3 && i + 1 < n) {
+      c = LATIN1[s[i + 1] & 0x3F];  // C3 80..BF = U+00C0..U+00FF
+      i++;
+    } else {
+      while (i + 1 < n && (s[i + 1] & 0xC0) == 0x80)
+        i++;  // outros caracteres multibyte são descartados inteiros
+    }
+    if (c < 'a' || c > 'z')
+      continue;
+    if (letras == LETRAS_MAX)
+      return 0;
+    dst[letras++] = c;
+  }
+  dst[letras] = '\0';
+  return letras;
+}
+
+static unsigned faixa_de(const palavra_t *p) {
+  return (unsigned)p->nivel * (letras_max + 1) + p->letras;
+}
+
+static unsigned balde_de(const palavra_t *p) {
+  return faixa_de(p) * INICIAIS + (unsigned)(p->normalizada[0] - 'a');
+}
+
+static int comparar_normalizada(const void *a, const void *b) {
+  const palavra_t *pa = a, *pb = b;
+  if (pa->letras != pb->letras)
+    return pa->letras < pb->letras ? -1 : 1;
+  return strcmp(pa->normalizada, pb->normalizada);
+}
+
+static int comparar_pontuacao(const void *a, const void *b) {
+  const palavra_t *pa = a, *pb = b;
+  if (pa->letras != pb->letras)
+    return pa->letras < pb->letras ? -1 : 1;
+  if (pa->pontuacao != pb->pontuacao)
+    return pa->pontuacao < pb->pontuacao ? -1 : 1;
+  if (pa->desempate != pb->desempate)
+    return pa->desempate < pb->desempate ? -1 : 1;
+  return strcmp(pa->normalizada, pb->normalizada);
+}
+
+// FNV-1a
+static uint32_t hash_palavra(const char *s) {
+  uint32_t h = 2166136261u;
+  while (*s)
+    h = (h ^ (uint8_t)*s++) * 16777619u;
+  return h;
+}
+
+static int comparar_balde(const void *a, const void *b) {
+  const palavra_t *pa = a, *pb = b;
+  unsigned ba = balde_de(pa), bb = balde_de(pb);
+  if (ba != bb)
+    return ba < bb ? -1 : 1;
+  return strcmp(pa->normalizada, pb->normalizada);
+}
+
+static char *ler_arquivo(const char *caminho, size_t *tam) {
+  FILE *f = fopen(caminho, "rb");
+  if (f == NULL)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  long n = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  char *dados = malloc((size_t)n + 1);
+  if (dados && fread(dados, 1, (size_t)n, f) != (size_t)n) {
+    free(dados);
+    dados = NULL;
+  }
+  fclose(f);
+  if (dados) {
+    dados[n] = '\0';
+    *tam = (size_t)n;
+  }
+  return dados;
+}
+
+static void escrever_u32(uint8_t *p, uint32_t v) {
+  for (unsigned i = 0; i < 4; i++)
+    p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void escrever_u16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+/**
+ * Níveis por quantis da pontuação, separados por tamanho. O corte é pela
+ * posição, então os níveis de um tamanho têm o mesmo número de palavras; os
+ * empates na fronteira se dividem pelo hash.
+ */
+static void atribuir_niveis(palavra_t *palavras, size_t n, unsigned niveis) {
+  qsort(palavras, n, sizeof(palavra_t), comparar_pontuacao);
+  for (size_t ini = 0; ini < n;) {
+    size_t fim = ini;
+    while (fim < n && palavras[fim].letras == palavras[ini].letras)
+      fim++;
+    for (size_t i = ini; i < fim; i++)
+      palavras[i].nivel = (uint8_t)((i - ini) * niveis / (fim - ini));
+    ini = fim;
+  }
+}
+
+/**
+ * Tabela de alias (Vose) para as palavras [ini, fim) de uma faixa, com pesos
+ * inteiros: limiar em escala de 2^32, alias como índice absoluto de entrada.
+ */
+static void montar_alias(const palavra_t *palavras, size_t ini, size_t fim, uint8_t *amostragem) {
+  size_t n = fim - ini;
+  uint64_t soma = 0;
+  for (size_t i = ini; i < fim; i++)
+    soma += palavras[i].peso;
+
+  // prob[i] = peso * n / soma, em escala de "soma" para ficar tudo inteiro
+  uint64_t *prob = malloc(n * sizeof(uint64_t));
+  size_t *pequenos = malloc(n * sizeof(size_t)), *grandes = malloc(n * sizeof(size_t));
+  size_t np = 0, ng = 0;
+  for (size_t i = 0; i < n; i++) {
+    prob[i] = (uint64_t)palavras[ini + i].peso * n;
+    if (prob[i] < soma)
+      pequenos[np++] = i;
+    else
+      grandes[ng++] = i;
+  }
+
+  while (np && ng) {
+    size_t p = pequenos[--np], g = grandes[ng - 1];
+    uint8_t *e = amostragem + 8 * (ini + p);
+    escrever_u32(e, (uint32_t)((prob[p] << 32) / soma));
+    escrever_u32(e + 4, (uint32_t)(ini + g));
+    prob[g] -= soma - prob[p];
+    if (prob[g] < soma) {
+      ng--;
+      pequenos[np++] = g;
+    }
+  }
+  // O que sobra tem probabilidade 1 (a menos de arredondamento): fica sempre com ele mesmo
+  while (ng) {
+    size_t g = grandes[--ng];
+    escrever_u32(amostragem + 8 * (ini + g), UINT32_MAX);
+    escrever_u32(amostragem + 8 * (ini + g) + 4, (uint32_t)(ini + g));
+  }
+  while (np) {
+    size_t p = pequenos[--np];
+    escrever_u32(amostragem + 8 * (ini + p), UINT32_MAX);
+    escrever_u32(amostragem + 8 * (ini + p) + 4, (uint32_t)(ini + p));
+  }
+  free(prob);
+  free(pequenos);
+  free(grandes);
+}
+
+int main(int argc, char **argv) {
+  unsigned niveis = NIVEIS_PADRAO;
+  if (argc == 5 && strcmp(argv[3], "--niveis") == 0)
+    niveis = (unsigned)atoi(argv[4]);
+  if ((argc != 3 && argc != 5) || niveis < 1 || niveis > 255) {
+    fprintf(stderr, "uso: %s palavras.txt palavras.idx [--niveis 1..255]\n", argv[0]);
+    return 2;
+  }
+
+  size_t tam;
+  char *texto = ler_arquivo(argv[1], &tam);
+  if (texto == NULL) {
+    fprintf(stderr, "[ERRO] não consegui ler %s\n", argv[1]);
+    return 1;
+  }
+
+  // Uma palavra por linha (ou separadas por espaço, como o split() do Python)
+  size_t cap = 1024, n = 0;
+  palavra_t *palavras = malloc(cap * sizeof(palavra_t));
+  for (size_t i = 0; i < tam;) {
+    while (i < tam && (texto[i] == ' ' || texto[i] == '\t' || texto[i] == '\r' || texto[i] == '\n'))
+      i++;
+    size_t ini = i;
+    while (i < tam && texto[i] != ' ' && texto[i] != '\t' && texto[i] != '\r' && texto[i] != '\n')
+      i++;
+    if (i == ini || i - ini > UINT8_MAX)
+      continue;
+
+    if (n == cap) {
+      cap *= 2;
+      palavras = realloc(palavras, cap * sizeof(palavra_t));
+    }
+    palavra_t *p = &palavras[n];
+    p->letras = (uint8_t)normalizar((const uint8_t *)texto + ini, (unsigned)(i - ini), p->normalizada);
+    if (p->letras == 0)
+      continue;
+    p->original = texto + ini;
+    p->bytes_original = (uint8_t)(i - ini);
+
+    dificuldade_t d;
+    dificuldade_medir(p->normalizada, (const uint8_t *)p->original, p->bytes_original, &d);
+    p->pontuacao = dificuldade_pontuar(&d);
+    p->peso = dificuldade_peso(&d);
+    p->desempate = hash_palavra(p->normalizada);
+    n++;
+  }
+  if (n == 0) {
+    fprintf(stderr, "[ERRO] nenhuma palavra em %s\n", argv[1]);
+    return 1;
+  }
+
+  // Sem repetições da forma normalizada ("Aarao" e "aarao" viram uma só)
+  qsort(palavras, n, sizeof(palavra_t), comparar_normalizada);
+  size_t unicas = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (unicas && strcmp(palavras[unicas - 1].normalizada, palavras[i].normalizada) == 0)
+      continue;
+    palavras[unicas++] = palavras[i];
+    if (palavras[i].letras > letras_max)
+      letras_max = palavras[i].letras;
+  }
+  n = unicas;
+
+  atribuir_niveis(palavras, n, niveis);
+  qsort(palavras, n, sizeof(palavra_t), comparar_balde);
+
+  unsigned num_faixas = niveis * (letras_max + 1);
+  unsigned num_baldes = num_faixas * INICIAIS;
+  size_t tam_textos = 0;
+  for (size_t i = 0; i < n; i++)
+    tam_textos += palavras[i].letras + palavras[i].bytes_original;
+
+  size_t off_baldes = TAM_CABECALHO;
+  size_t off_pesos = off_baldes + 4 * ((size_t)num_baldes + 1);
+  size_t off_entradas = off_pesos + 4 * (size_t)num_faixas;
+  size_t off_amostragem = off_entradas + 8 * n;
+  size_t off_textos = off_amostragem + 8 * n;
+  size_t total = off_textos + tam_textos;
+  if (total > UINT32_MAX) {
+    fprintf(stderr, "[ERRO] índice passaria de 4 GB\n");
+    return 1;
+  }
+
+  uint8_t *saida = calloc(1, total);
+  memcpy(saida, "SPIX", 4);
+  escrever_u16(saida + 4, VERSAO);
+  saida[6] = (uint8_t)letras_max;
+  saida[7] = (uint8_t)niveis;
+  escrever_u32(saida + 8, (uint32_t)n);
+  escrever_u32(saida + 12, (uint32_t)off_baldes);
+  escrever_u32(saida + 16, (uint32_t)off_entradas);
+  escrever_u32(saida + 20, (uint32_t)off_textos);
+  escrever_u32(saida + 24, (uint32_t)tam_textos);
+  escrever_u32(saida + 28, (uint32_t)off_pesos);
+  escrever_u32(saida + 32, (uint32_t)off_amostragem);
+
+  // Baldes em forma de prefixo: início de cada um, mais o fim do último
+  size_t i = 0, pos_texto = 0;
+  for (unsigned b = 0; b <= num_baldes; b++) {
+    escrever_u32(saida + off_baldes + 4 * b, (uint32_t)i);
+    while (i < n && balde_de(&palavras[i]) == b) {
+      palavra_t *p = &palavras[i];
+      uint8_t *e = saida + off_entradas + 8 * i;
+      escrever_u32(e, (uint32_t)pos_texto);
+      e[4] = p->letras;
+      e[5] = p->bytes_original;
+      escrever_u16(e + 6, p->pontuacao);
+      memcpy(saida + off_textos + pos_texto, p->normalizada, p->letras);
+      memcpy(saida + off_textos + pos_texto + p->letras, p->original, p->bytes_original);
+      pos_texto += p->letras + p->bytes_original;
+      i++;
+    }
+  }
+
+  // Pesos e alias de cada faixa (nível, letras)
+  for (size_t ini = 0; ini < n;) {
+    size_t fim = ini;
+    uint32_t soma = 0;
+    while (fim < n && faixa_de(&palavras[fim]) == faixa_de(&palavras[ini]))
+      soma += palavras[fim++].peso;
+    escrever_u32(saida + off_pesos + 4 * faixa_de(&palavras[ini]), soma);
+    montar_alias(palavras, ini, fim, saida + off_amostragem);
+    ini = fim;
+  }
+
+  FILE *f = fopen(argv[2], "wb");
+  if (f == NULL || fwrite(saida, 1, total, f) != total) {
+    fprintf(stderr, "[ERRO] não consegui gravar %s\n", argv[2]);
+    return 1;
+  }
+  fclose(f);
+
+  printf("indice: %zu palavras, até %u letras, %u níveis, %zu bytes -> %s\n", n, letras_max, niveis,
+         total, argv[2]);
+  free(saida);
+  free(palavras);
+  free(texto);
+  return 0;
+}
@@ -0,0 +1,497 @@
+// ferramentas/verificador.c
+//
+// Formato do modelo de letras (little-endian), gravado pelo python/verificador.py:
+//
+//   char magic[4]   "SPLM"
+//   u16  versao     2 (a 1 não tem origem e reservado: cabeçalho de 16 bytes, áudio)
+//   u8   coefs      VERIFICADOR_COEFS
+//   u8   letras     VERIFICADOR_LETRAS
+//   f32  custo_max        custo de DTW aceito numa palavra (0 = sem limite)
+//   f32  custo_max_letra  o mesmo para uma letra sozinha, sem CMN (0 = sem limite)
+//   u8   origem     VERIFICADOR_ORIGEM_*
+//   u8   reservado[3]
+//   por letra, de 'a' a 'z': u16 quadros (0 = sem modelo) e quadros * coefs f32,
+//   cepstro sem CMN (a média é tirada da palavra montada)
+
+#include "verificador.h"
+#include "microfone/log_mel.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VERSAO 2
+#define TAM_CABECALHO 20
+#define TAM_CABECALHO_V1 16
+#define C VERIFICADOR_COEFS
+
+#define N_FFT 512
+#define QUADRO 400  // 25 ms
+#define PASSO 160   // 10 ms
+#define BINS (N_FFT / 2 + 1)
+#define BANDAS 26
+#define MEL_MIN_HZ 20.0
+#define MEL_MAX_HZ 7600.0
+#define PRE_ENFASE 0.97f
+#define FAIXA_DB 25.0f      // quadros mais fracos que isso em relação ao pico são pausa
+#define FOLGA_DESISTIR 1.5f  // candidatas 50% piores que a melhor não precisam de custo exato
+
+struct verificador {
+  int origem;
+  float custo_max, custo_max_letra;
+  int quadros[VERIFICADOR_LETRAS];
+  float *modelos[VERIFICADOR_LETRAS];
+};
+
+// Tabelas fixas, montadas na primeira chamada
+static struct {
+  int pronto;
+  float janela[QUADRO];
+  // Fatores de giro de cada estágio em sequência: o estágio de meia-largura h
+  // usa [h - 1, 2h - 1), contíguos, para o laço da borboleta vetorizar
+  float giro_re[N_FFT - 1], giro_im[N_FFT - 1];
+  uint16_t reverso[N_FFT];
+  float mel[BANDAS][BINS];
+  float dct[C][BANDAS];
+  float dct_pico[C][LOG_MEL_BANDAS];
+} t;
+
+static double hz_para_mel(double f) {
+  return 2595.0 * log10(1.0 + f / 700.0);
+}
+
+static double mel_para_hz(double m) {
+  return 700.0 * (pow(10.0, m / 2595.0) - 1.0);
+}
+
+static void preparar_tabelas(void) {
+  if (t.pronto)
+    return;
+  for (int i = 0; i < QUADRO; i++)
+    t.janela[i] = (float)(0.54 - 0.46 * cos(2.0 * M_PI * i / (QUADRO - 1)));  // Hamming
+
+  for (int h = 1; h < N_FFT; h <<= 1)
+    for (int j = 0; j < h; j++) {
+      t.giro_re[h - 1 + j] = (float)cos(-M_PI * j / h);
+      t.giro_im[h - 1 + j] = (float)sin(-M_PI * j / h);
+    }
+  for (int i = 0; i < N_FFT; i++) {
+    int r = 0;
+    for (int b = 1, x = i; b < N_FFT; b <<= 1, x >>= 1)
+      r = (r << 1) | (x & 1);
+    t.reverso[i] = (uint16_t)r;
+  }
+
+  // Filtros triangulares igualmente espaçados na escala mel
+  double mmin = hz_para_mel(MEL_MIN_HZ), mmax = hz_para_mel(MEL_MAX_HZ);
+  double borda[BANDAS + 2];
+  for (int b = 0; b < BANDAS + 2; b++)
+    borda[b] = mel_para_hz(mmin + (mmax - mmin) * b / (BANDAS + 1)) * N_FFT / VERIFICADOR_TAXA;
+  for (int b = 0; b < BANDAS; b++)
+    for (int k = 0; k < BINS; k++) {
+      double sobe = (k - borda[b]) / (borda[b + 1] - borda[b]);
+      double desce = (borda[b + 2] - k) / (borda[b + 2] - borda[b + 1]);
+      double w = sobe < desce ? sobe : desce;
+      t.mel[b][k] = w > 0 ? (float)w : 0.0f;
+    }
+  for (int c = 0; c < C; c++)
+    for (int b = 0; b < BANDAS; b++)
+      t.dct[c][b] = (float)cos(M_PI * c * (b + 0.5) / BANDAS);
+  for (int c = 0; c < C; c++)
+    for (int b = 0; b < LOG_MEL_BANDAS; b++)
+      t.dct_pico[c][b] = (float)cos(M_PI * c * (b + 0.5) / LOG_MEL_BANDAS);
+  t.pronto = 1;
+}
+
+/**
+ * FFT complexa radix-2 in-place, dizimação no tempo, com real e imaginário em
+ * vetores separados: em cada estágio o laço interno anda em j contíguo sobre
+ * dados e giros, e o compilador o vetoriza (-O3).
+ */
+static void fft(float *restrict re, float *restrict im) {
+  for (int i = 0; i < N_FFT; i++) {
+    int r = t.reverso[i];
+    if (r > i) {
+      float a = re[i], b = im[i];
+      re[i] = re[r];
+      im[i] = im[r];
+      re[r] = a;
+      im[r] = b;
+    }
+  }
+  for (int h = 1; h < N_FFT; h <<= 1) {
+    const float *gr = t.giro_re + h - 1, *gi = t.giro_im + h - 1;
+    for (int k = 0; k < N_FFT; k += 2 * h) {
+      float *ar = re + k, *ai = im + k, *br = re + k + h, *bi = im + k + h;
+      for (int j = 0; j < h; j++) {
+        float xr = br[j] * gr[j] - bi[j] * gi[j];
+        float xi = br[j] * gi[j] + bi[j] * gr[j];
+        br[j] = ar[j] - xr;
+        bi[j] = ai[j] - xi;
+        ar[j] += xr;
+        ai[j] += xi;
+      }
+    }
+  }
+}
+
+// Tira de cada coeficiente a sua média nos n quadros (CMN)
+static void remover_media(float *q, int n) {
+  float media[C] = {0};
+  for (int i = 0; i < n; i++)
+    for (int c = 0; c < C; c++)
+      media[c] += q[i * C + c];
+  for (int i = 0; i < n; i++)
+    for (int c = 0; c < C; c++)
+      q[i * C + c] -= media[c] / n;
+}
+
+int verificador_caracteristicas(const int16_t *audio, size_t n, float *saida, int max_quadros, int cmn) {
+  preparar_tabelas();
+  if (n < QUADRO || max_quadros <= 0)
+    return 0;
+  int nq = (int)((n - QUADRO) / PASSO + 1);
+  float *coefs = malloc((size_t)nq * C * sizeof(float));
+  float *energia = malloc((size_t)nq * sizeof(float));
+  if (coefs == NULL || energia == NULL) {
+    free(coefs);
+    free(energia);
+    return 0;
+  }
+
+  float re[N_FFT], im[N_FFT], pot[BINS];
+  float maior = -INFINITY;
+  for (int q = 0; q < nq; q++) {
+    const int16_t *x = audio + (size_t)q * PASSO;
+    float anterior = q > 0 ? x[-1] : x[0];
+    for (int i = 0; i < QUADRO; i++) {
+      re[i] = (x[i] - PRE_ENFASE * anterior) * t.janela[i];
+      anterior = x[i];
+    }
+    memset(re + QUADRO, 0, (N_FFT - QUADRO) * sizeof(float));
+    memset(im, 0, sizeof(im));
+    fft(re, im);
+
+    float total = 1e-10f;
+    for (int k = 0; k < BINS; k++) {
+      pot[k] = re[k] * re[k] + im[k] * im[k];
+      total += pot[k];
+    }
+    float logmel[BANDAS];
+    for (int b = 0; b < BANDAS; b++) {
+      float e = 1e-10f;
+      for (int k = 0; k < BINS; k++)
+        e += t.mel[b][k] * pot[k];
+      logmel[b] = logf(e);
+    }
+    for (int c = 0; c < C; c++) {
+      float s = 0;
+      for (int b = 0; b < BANDAS; b++)
+        s += t.dct[c][b] * logmel[b];
+      coefs[q * C + c] = s;
+    }
+    energia[q] = 10.0f * log10f(total);
+    if (energia[q] > maior)
+      maior = energia[q];
+  }
+
+  // Só os quadros de fala
+  int nk = 0;
+  for (int q = 0; q < nq && nk < max_quadros; q++)
+    if (energia[q] >= maior - FAIXA_DB)
+      memcpy(saida + (size_t)nk++ * C, coefs + (size_t)q * C, C * sizeof(float));
+  if (cmn && nk > 0)
+    remover_media(saida, nk);
+  free(coefs);
+  free(energia);
+  return nk;
+}
+
+int verificador_log_mel(const uint16_t *adc, size_t n, uint8_t *saida, int max_quadros) {
+  log_mel_t *m = malloc(sizeof(*m));
+  if (m == NULL)
+    return 0;
+  log_mel_reset(m);
+  // Em pedaços de um passo: nenhum pedaço completa mais de um quadro
+  int quadros = 0;
+  for (size_t i = 0; i < n && quadros < max_quadros; i += LOG_MEL_PASSO) {
+    uint k = n - i < LOG_MEL_PASSO ? (uint)(n - i) : LOG_MEL_PASSO;
+    quadros += (int)log_mel_processar(m, adc + i, k, saida + (size_t)quadros * LOG_MEL_BANDAS);
+  }
+  free(m);
+  return quadros;
+}
+
+int verificador_caracteristicas_mel(const uint8_t *mel, int quadros, float *saida, int max_quadros, int cmn) {
+  preparar_tabelas();
+  // Cada byte é 8·log2 da energia da banda: ln = byte · ln2/8
+  const float ln_passo = (float)(M_LN2 / 8.0), db_passo = (float)(10.0 * M_LN2 / (8.0 * M_LN10));
+  float *energia = malloc((size_t)(quadros > 0 ? quadros : 1) * sizeof(float));
+  if (energia == NULL)
+    return 0;
+  float maior = -INFINITY;
+  for (int q = 0; q < quadros; q++) {
+    const uint8_t *v = mel + (size_t)q * LOG_MEL_BANDAS;
+    uint8_t topo = 0;
+    for (int b = 0; b < LOG_MEL_BANDAS; b++)
+      if (v[b] > topo)
+        topo = v[b];
+    float total = 0;  // relativa à banda mais forte, para a soma não estourar
+    for (int b = 0; b < LOG_MEL_BANDAS; b++)
+      total += exp2f((v[b] - topo) / 8.0f);
+    energia[q] = topo * db_passo + 10.0f * log10f(total);
+    if (energia[q] > maior)
+      maior = energia[q];
+  }
+
+  int nk = 0;
+  for (int q = 0; q < quadros && nk < max_quadros; q++) {
+    if (energia[q] < maior - FAIXA_DB)
+      continue;
+    const uint8_t *v = mel + (size_t)q * LOG_MEL_BANDAS;
+    for (int c = 0; c < C; c++) {
+      float s = 0;
+      for (int b = 0; b < LOG_MEL_BANDAS; b++)
+        s += t.dct_pico[c][b] * v[b];
+      saida[(size_t)nk * C + c] = s * ln_passo;
+    }
+    nk++;
+  }
+  if (cmn && nk > 0)
+    remover_media(saida, nk);
+  free(energia);
+  return nk;
+}
+
+static float distancia_quadros(const float *a, const float *b) {
+  float s = 0;
+  for (int c = 0; c < C; c++) {
+    float d = a[c] - b[c];
+    s += d * d;
+  }
+  return sqrtf(s);
+}
+
+/**
+ * Passos (i-1, j) e (i, j-1) com peso 1 e diagonal com peso 2: todo caminho
+ * soma na + nb de peso, então dividir por isso normaliza. Faixa de
+ * Sakoe-Chiba de 1/4 do maior tamanho em volta da diagonal esticada.
+ */
+float verificador_dtw(const float *a, int na, const float *b, int nb, float limite) {
+  if (na <= 0 || nb <= 0)
+    return INFINITY;
+  float *linhas = malloc(2 * (size_t)nb * sizeof(float));
+  if (linhas == NULL)
+    return INFINITY;
+  float *ant = linhas, *atual = linhas + nb;
+  float teto = limite * (float)(na + nb);
+  int faixa = (na > nb ? na : nb) / 4 + 1;
+
+  for (int i = 0; i < na; i++) {
+    int centro = (int)((long)i * nb / na);
+    int j0 = centro - faixa < 0 ? 0 : centro - faixa;
+    int j1 = centro + faixa >= nb ? nb - 1 : centro + faixa;
+    for (int j = 0; j < nb; j++)
+      atual[j] = INFINITY;
+    float menor = INFINITY;
+    for (int j = j0; j <= j1; j++) {
+      float d = distancia_quadros(a + i * C, b + j * C);
+      float v;
+      if (i == 0 && j == 0) {
+        v = 2 * d;
+      } else {
+        v = INFINITY;
+        if (i > 0 && ant[j] + d < v)
+          v = ant[j] + d;
+        if (j > 0 && atual[j - 1] + d < v)
+          v = atual[j - 1] + d;
+        if (i > 0 && j > 0 && ant[j - 1] + 2 * d < v)
+          v = ant[j - 1] + 2 * d;
+      }
+      atual[j] = v;
+      if (v < menor)
+        menor = v;
+    }
+    if (menor > teto) {  // o custo só cresce linha a linha
+      free(linhas);
+      return INFINITY;
+    }
+    float *tmp = ant;
+    ant = atual;
+    atual = tmp;
+  }
+  float custo = ant[nb - 1];
+  free(linhas);
+  return custo > teto ? INFINITY : custo / (float)(na + nb);
+}
+
+static uint32_t ler_u32(const uint8_t *p) {
+  return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static float ler_f32(const uint8_t *p) {
+  uint32_t u = ler_u32(p);
+  float f;
+  memcpy(&f, &u, sizeof(f));
+  return f;
+}
+
+verificador_t *verificador_abrir(const char *caminho_modelo) {
+  FILE *f = fopen(caminho_modelo, "rb");
+  if (f == NULL)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  long tam = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t *dados = tam > 0 ? malloc((size_t)tam) : NULL;
+  size_t lidos = dados ? fread(dados, 1, (size_t)tam, f) : 0;
+  fclose(f);
+  int versao = lidos >= TAM_CABECALHO_V1 ? dados[4] | dados[5] << 8 : 0;
+  size_t cabecalho = versao == 1 ? TAM_CABECALHO_V1 : TAM_CABECALHO;
+  if (lidos != (size_t)tam || (size_t)tam < cabecalho || memcmp(dados, "SPLM", 4) != 0 ||
+      (versao != 1 && versao != VERSAO) || dados[6] != C || dados[7] != VERIFICADOR_LETRAS) {
+    free(dados);
+    return NULL;
+  }
+
+  verificador_t *v = calloc(1, sizeof(*v));
+  v->custo_max = ler_f32(dados + 8);
+  v->custo_max_letra = ler_f32(dados + 12);
+  v->origem = versao == 1 ? VERIFICADOR_ORIGEM_AUDIO : dados[16];
+  size_t pos = cabecalho;
+  for (int l = 0; l < VERIFICADOR_LETRAS; l++) {
+    if (pos + 2 > (size_t)tam)
+      goto invalido;
+    int nq = dados[pos] | dados[pos + 1] << 8;
+    pos += 2;
+    if (pos + (size_t)nq * C * 4 > (size_t)tam)
+      goto invalido;
+    v->quadros[l] = nq;
+    if (nq > 0) {
+      v->modelos[l] = malloc((size_t)nq * C * sizeof(float));
+      for (int i = 0; i < nq * C; i++, pos += 4)
+        v->modelos[l][i] = ler_f32(dados + pos);
+    }
+  }
+  free(dados);
+  return v;
+
+invalido:
+  free(dados);
+  verificador_fechar(v);
+  return NULL;
+}
+
+void verificador_fechar(verificador_t *v) {
+  if (v == NULL)
+    return;
+  for (int l = 0; l < VERIFICADOR_LETRAS; l++)
+    free(v->modelos[l]);
+  free(v);
+}
+
+int verificador_origem(const verificador_t *v) {
+  return v->origem;
+}
+
+float verificador_custo_max(const verificador_t *v) {
+  return v->custo_max;
+}
+
+float verificador_custo_max_letra(const verificador_t *v) {
+  return v->custo_max_letra;
+}
+
+/**
+ * Modelos das letras da palavra em sequência, com cmn a média tirada da palavra
+ * inteira, como na fala (cada letra sozinha teria outra média); 0 se faltar algum.
+ */
+static int montar_palavra(const verificador_t *v, const char *palavra, int cmn, float **buf, size_t *cap) {
+  size_t nq = 0;
+  for (const char *p = palavra; *p; p++) {
+    if (*p < 'a' || *p > 'z' || v->quadros[*p - 'a'] == 0)
+      return 0;
+    nq += (size_t)v->quadros[*p - 'a'];
+  }
+  if (nq * C > *cap) {
+    float *novo = realloc(*buf, nq * C * sizeof(float));
+    if (novo == NULL)
+      return 0;
+    *buf = novo;
+    *cap = nq * C;
+  }
+  size_t pos = 0;
+  for (const char *p = palavra; *p; p++) {
+    int l = *p - 'a';
+    memcpy(*buf + pos, v->modelos[l], (size_t)v->quadros[l] * C * sizeof(float));
+    pos += (size_t)v->quadros[l] * C;
+  }
+  if (cmn)
+    remover_media(*buf, (int)nq);
+  return (int)nq;
+}
+
+// A fala a pontuar: áudio a 16 kHz ou quadros log-mel da Pico, conforme a origem do modelo
+typedef struct {
+  const int16_t *audio;
+  size_t n;
+  const uint8_t *mel;
+  int quadros_mel;
+} fala_t;
+
+static int pontuar(const verificador_t *v, const fala_t *f, const char *const *candidatas,
+                   int n_candidatas, float *custos, int cmn) {
+  for (int i = 0; i < n_candidatas; i++)
+    custos[i] = INFINITY;
+  if ((f->mel != NULL) != (v->origem == VERIFICADOR_ORIGEM_PICO))
+    return -1;  // características de uma origem contra modelos de outra
+  int max_quadros = f->mel ? f->quadros_mel : (int)(f->n / PASSO + 1);
+  float *fala = malloc((size_t)(max_quadros > 0 ? max_quadros : 1) * C * sizeof(float));
+  if (fala == NULL)
+    return -1;
+  int nf = f->mel ? verificador_caracteristicas_mel(f->mel, f->quadros_mel, fala, max_quadros, cmn)
+                  : verificador_caracteristicas(f->audio, f->n, fala, max_quadros, cmn);
+
+  float *modelo = NULL;
+  size_t cap = 0;
+  int melhor = -1;
+  for (int i = 0; i < n_candidatas && nf > 0; i++) {
+    int nm = montar_palavra(v, candidatas[i], cmn, &modelo, &cap);
+    if (nm == 0)
+      continue;
+    float limite = melhor < 0 ? INFINITY : custos[melhor] * FOLGA_DESISTIR;
+    custos[i] = verificador_dtw(fala, nf, modelo, nm, limite);
+    if (custos[i] < INFINITY && (melhor < 0 || custos[i] < custos[melhor]))
+      melhor = i;
+  }
+  free(modelo);
+  free(fala);
+  return melhor;
+}
+
+static const char *const letras[VERIFICADOR_LETRAS] = {
+    "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m",
+    "n", "o", "p", "q", "r", "s", "t", "u", "v", "w", "x", "y", "z"};
+
+int verificador_pontuar(const verificador_t *v, const int16_t *audio, size_t n,
+                        const char *const *candidatas, int n_candidatas, float *custos) {
+  fala_t f = {.audio = audio, .n = n};
+  return pontuar(v, &f, candidatas, n_candidatas, custos, 1);
+}
+
+int verificador_letra(const verificador_t *v, const int16_t *audio, size_t n, float *custos) {
+  fala_t f = {.audio = audio, .n = n};
+  // Sem CMN: numa letra só (uma vogal parada, "a", "e"...) a média é quase todo o sinal
+  return pontuar(v, &f, letras, VERIFICADOR_LETRAS, custos, 0);
+}
+
+int verificador_pontuar_mel(const verificador_t *v, const uint8_t *mel, int quadros,
+                            const char *const *candidatas, int n_candidatas, float *custos) {
+  fala_t f = {.mel = mel, .quadros_mel = quadros};
+  return pontuar(v, &f, candidatas, n_candidatas, custos, 1);
+}
+
+int verificador_letra_mel(const verificador_t *v, const uint8_t *mel, int quadros, float *custos) {
+  fala_t f = {.mel = mel, .quadros_mel = quadros};
+  return pontuar(v, &f, letras, VERIFICADOR_LETRAS, custos, 0);
+}
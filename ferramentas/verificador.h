@@ -0,0 +1,92 @@
+// ferramentas/verificador.h
+
+#ifndef VERIFICADOR_H
+#define VERIFICADOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Verificação local da resposta, sem ASR na nuvem: a palavra esperada é
+// conhecida, então basta medir se a fala soletrada parece mais com ela do que
+// com as palavras parecidas do dicionário. Características MFCC (FFT própria)
+// e DTW contra a concatenação dos modelos de cada letra, construídos offline
+// a partir de gravações (python/verificador.py construir). Compilada como
+// biblioteca compartilhada para o python/verificador.py (ctypes).
+//
+// Com o codec CODEC_LOG_MEL a Pico não manda áudio, só as características
+// log-mel (microfone/log_mel.h); um modelo de origem "pico" é construído com
+// o mesmo código do firmware e pontua esses quadros direto (funções *_mel).
+
+#define VERIFICADOR_TAXA 16000  // áudio de entrada: o que sai do dsp_voz
+#define VERIFICADOR_COEFS 13    // coeficientes por quadro de 10 ms
+#define VERIFICADOR_LETRAS 26
+
+// De onde vêm as características do modelo (e as que ele aceita)
+#define VERIFICADOR_ORIGEM_AUDIO 0  // MFCC do áudio a 16 kHz (verificador_caracteristicas)
+#define VERIFICADOR_ORIGEM_PICO  1  // cepstro dos quadros log-mel da Pico (verificador_caracteristicas_mel)
+
+typedef struct verificador verificador_t;
+
+/**
+ * MFCC de cada quadro de 25 ms (passo de 10 ms) com energia a até 25 dB da
+ * do quadro mais forte; com cmn, sem a média de cada coeficiente (o canal e
+ * o microfone somem junto). Escreve até max_quadros * VERIFICADOR_COEFS
+ * floats e retorna quantos quadros escreveu.
+ */
+int verificador_caracteristicas(const int16_t *audio, size_t n, float *saida, int max_quadros, int cmn);
+
+/**
+ * Custo de DTW entre duas sequências de características, normalizado pelo
+ * tamanho das duas (comparável entre palavras de tamanhos diferentes). Desiste
+ * e retorna INFINITY assim que o custo passar de "limite".
+ */
+float verificador_dtw(const float *a, int na, const float *b, int nb, float limite);
+
+/**
+ * Os quadros log-mel que a Pico calcularia para estas amostras de 12 bits do
+ * ADC (o mesmo microfone/log_mel.c): até max_quadros * LOG_MEL_BANDAS bytes.
+ * Retorna quantos quadros escreveu.
+ */
+int verificador_log_mel(const uint16_t *adc, size_t n, uint8_t *saida, int max_quadros);
+
+/**
+ * Cepstro (DCT do log) de cada quadro log-mel da Pico, com a mesma seleção de
+ * quadros de fala e o mesmo cmn de verificador_caracteristicas().
+ */
+int verificador_caracteristicas_mel(const uint8_t *mel, int quadros, float *saida, int max_quadros, int cmn);
+
+// Carrega um modelo de letras (formato em verificador.c); NULL se inválido
+verificador_t *verificador_abrir(const char *caminho_modelo);
+void verificador_fechar(verificador_t *v);
+
+// VERIFICADOR_ORIGEM_AUDIO ou VERIFICADOR_ORIGEM_PICO
+int verificador_origem(const verificador_t *v);
+
+// Custo acima do qual nem a melhor candidata conta como fala reconhecida (0 = sem limite)
+float verificador_custo_max(const verificador_t *v);
+// O mesmo para verificador_letra(), uma letra sozinha
+float verificador_custo_max_letra(const verificador_t *v);
+
+/**
+ * Custo da fala contra cada candidata (palavra a-z: os modelos das letras em
+ * sequência). INFINITY para candidatas com letra sem modelo ou que ficaram
+ * muito atrás da melhor (mais de 50% acima: o DTW desiste cedo). Vale pôr a
+ * mais provável primeiro. Retorna o índice da melhor, ou -1.
+ */
+int verificador_pontuar(const verificador_t *v, const int16_t *audio, size_t n,
+                        const char *const *candidatas, int n_candidatas, float *custos);
+
+/**
+ * Uma letra falada sozinha (um segmento da soletração) contra os modelos das
+ * VERIFICADOR_LETRAS letras: custos[l] como em verificador_pontuar. Retorna a
+ * letra mais provável (0 = 'a'), ou -1.
+ */
+int verificador_letra(const verificador_t *v, const int16_t *audio, size_t n, float *custos);
+
+// O mesmo que verificador_pontuar() e verificador_letra(), a partir dos quadros
+// log-mel da Pico; só com modelos de origem VERIFICADOR_ORIGEM_PICO
+int verificador_pontuar_mel(const verificador_t *v, const uint8_t *mel, int quadros,
+                            const char *const *candidatas, int n_candidatas, float *custos);
+int verificador_letra_mel(const verificador_t *v, const uint8_t *mel, int quadros, float *custos);
+
+#endif
@@ -0,0 +1,48 @@
+// jogo/eventos.c
+
+#include "eventos.h"
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+
+static evento_t fila[EVENTOS_CAPACIDADE];
+static volatile uint32_t head = 0;
+static volatile uint32_t tail = 0;
+
+/**
+ * Enfileira um evento. Chamado de IRQs (GPIO, alarmes, USB) e do laço
+ * principal, então a reserva do slot é feita com as interrupções desligadas.
+ * Retorna false se a fila está cheia e o evento foi descartado.
+ */
+bool eventos_post(uint8_t tipo, uint8_t arg) {
+  return eventos_post_em(tipo, arg, time_us_32());
+}
+
+// Como eventos_post(), mas com o instante original do evento (ex.: borda do botão)
+bool eventos_post_em(uint8_t tipo, uint8_t arg, uint32_t t_us) {
+  uint32_t status = save_and_disable_interrupts();
+  bool ok = head - tail < EVENTOS_CAPACIDADE;
+  if (ok) {
+    evento_t *ev = &fila[head % EVENTOS_CAPACIDADE];
+    ev->tipo = tipo;
+    ev->arg = arg;
+    ev->t_us = t_us;
+    head = head + 1;
+  }
+  restore_interrupts(status);
+  return ok;
+}
+
+bool eventos_pop(evento_t *ev) {
+  uint32_t status = save_and_disable_interrupts();
+  bool ok = head != tail;
+  if (ok) {
+    *ev = fila[tail % EVENTOS_CAPACIDADE];
+    tail = tail + 1;
+  }
+  restore_interrupts(status);
+  return ok;
+}
+
+bool eventos_vazio(void) {
+  return head == tail;
+}
@@ -0,0 +1,32 @@
+// jogo/eventos.h
+
+#ifndef EVENTOS_H
+#define EVENTOS_H
+
+#include "pico/stdlib.h"
+
+typedef enum {
+    EV_BOTAO_A = 1,      // botão A pressionado
+    EV_BOTAO_B,          // botão B pressionado
+    EV_BOTAO_B_LONGO,    // botão B segurado (reinicia o jogo)
+    EV_LINHA_SERIAL,     // linha completa recebida do host
+    EV_TEMPORIZADOR,     // alarme agendado pelo jogo venceu
+    EV_CAPTURA_FIM,      // o VAD encerrou a gravação sozinho
+    EV_CAPTURA_PARADA,   // a captura desligada terminou de sair pela serial
+} evento_tipo_t;
+
+typedef struct {
+    uint8_t tipo;
+    uint8_t arg;
+    uint32_t t_us;       // instante em que o evento aconteceu (time_us_32)
+} evento_t;
+
+// Fila de eventos do core0: pode ser alimentada por IRQs e pelo laço principal
+#define EVENTOS_CAPACIDADE 16
+
+bool eventos_post(uint8_t tipo, uint8_t arg);
+bool eventos_post_em(uint8_t tipo, uint8_t arg, uint32_t t_us);
+bool eventos_pop(evento_t *ev);
+bool eventos_vazio(void);
+
+#endif
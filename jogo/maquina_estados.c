@@ -0,0 +1,30 @@
+// jogo/maquina_estados.c
+
+#include "maquina_estados.h"
+
+void maquina_init(maquina_t *m, const transicao_t *tabela, uint num, uint8_t estado_inicial) {
+  m->estado = estado_inicial;
+  m->tabela = tabela;
+  m->num_transicoes = num;
+  m->ao_mudar = NULL;
+}
+
+bool maquina_despachar(maquina_t *m, const evento_t *ev) {
+  for (uint i = 0; i < m->num_transicoes; i++) {
+    const transicao_t *t = &m->tabela[i];
+    if ((t->estado != m->estado && t->estado != MAQUINA_QUALQUER) || t->evento != ev->tipo)
+      continue;
+    if (t->guarda && !t->guarda(ev))
+      continue;
+
+    uint8_t de = m->estado;
+    // O estado muda antes da ação, para que ela possa consultar o destino
+    m->estado = t->proximo;
+    if (t->acao)
+      t->acao(ev);
+    if (m->ao_mudar)
+      m->ao_mudar(de, m->estado, ev);
+    return true;
+  }
+  return false;
+}
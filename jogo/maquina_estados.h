@@ -0,0 +1,43 @@
+// jogo/maquina_estados.h
+
+#ifndef MAQUINA_ESTADOS_H
+#define MAQUINA_ESTADOS_H
+
+#include "pico/stdlib.h"
+#include "eventos.h"
+
+/*
+ * Máquina de estados dirigida por tabela. Para cada evento, a primeira
+ * transição com o estado atual, o mesmo tipo de evento e guarda verdadeira
+ * (ou sem guarda) é executada: roda a ação e muda para o próximo estado.
+ * Eventos sem transição no estado atual são ignorados.
+ * Transições com estado MAQUINA_QUALQUER valem em todos os estados; ponha-as
+ * no fim da tabela para que as específicas tenham prioridade.
+ */
+
+#define MAQUINA_QUALQUER 0xFF
+
+typedef bool (*guarda_t)(const evento_t *ev);
+typedef void (*acao_t)(const evento_t *ev);
+
+typedef struct {
+    uint8_t estado;
+    uint8_t evento;
+    guarda_t guarda;    // NULL = sempre
+    acao_t acao;        // NULL = só muda de estado
+    uint8_t proximo;
+} transicao_t;
+
+typedef struct {
+    uint8_t estado;
+    const transicao_t *tabela;
+    uint num_transicoes;
+    void (*ao_mudar)(uint8_t de, uint8_t para, const evento_t *ev); // opcional, para log/trace
+} maquina_t;
+
+void maquina_init(maquina_t *m, const transicao_t *tabela, uint num, uint8_t estado_inicial);
+
+// Retorna true se alguma transição foi executada
+bool maquina_despachar(maquina_t *m, const evento_t *ev);
+
+#endif
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include "pico/stdlib.h"
 #include "pico/binary_info.h"
@@ -7,9 +8,19 @@
 #include "hardware/gpio.h"
 #include "hardware/i2c.h"
 #include "hardware/uart.h"
+#include "hardware/sync.h"
 #include "display/ssd1306_i2c.h"
 #include "matriz_led/neopixel_pio.h"
+#include "matriz_led/animacao.h"
 #include "buzzer/buzzer_pwm.h"
+#include "microfone/pipeline_audio.h"
+#include "comunicacao/linha_serial.h"
+#include "rastreio/rastreio.h"
+#include "entrada/botoes.h"
+#include "jogo/eventos.h"
+#include "jogo/maquina_estados.h"
+#include "dicionario/dicionario.h"
+#include "bench/bench_firmware.h"
 
 // Área de renderização do display
 struct render_area frame_area = {
@@ -19,99 +30,489 @@ struct render_area frame_area = {
     end_page : SSD1306_NUM_PAGES - 1
     };
 
-// Buffer para o display
+// Buffer para o display (limpe com SSD1306_clear para o render só mandar o que mudou)
 uint8_t buf[SSD1306_BUF_LEN];
 
 #define BUTTON_PIN_A 5
 #define BUTTON_PIN_B 6
 #define BUZZER_PIN_A 21
 
+// Tons do buzzer em Hz (os mesmos que o beep antigo produzia com clock fixo)
+#define TOM_CONTAGEM     2480
+#define TOM_CONTAGEM_FIM 2098
+#define TOM_ACERTO       2289
+#define TOM_ERRO         1907
+
+static const nota_t JINGLE_ACERTO[] = {
+    {TOM_ACERTO, 400, BUZZER_VOLUME_MAX, BUZZER_ENV_PLANO},
+    {0,          200, 0,                 BUZZER_ENV_PLANO},
+    {TOM_ACERTO, 400, BUZZER_VOLUME_MAX, BUZZER_ENV_PLANO},
+};
+
 #define ADC_PIN 28
 #define SAMPLE_RATE_HZ 8000
-#define MAX_LINE_LEN 128
+#define AUDIO_CODEC CODEC_IMA_ADPCM // CODEC_PCM8, CODEC_MULAW, CODEC_IMA_ADPCM ou CODEC_LOG_MEL (só características)
+
+// Detector de voz: corta o silêncio inicial e encerra a gravação sozinho
+const vad_config_t vad_config = VAD_CONFIG_PADRAO;
 
 volatile bool capturando = false;
-volatile bool analisando = false;
+bool parando_captura = false; // desligada, mas o quadro de fim ainda não saiu
 
 // Variáveis globais de nível
 int nivel = 1;
 const int tempo_por_nivel[] = {10, 5, 3}; // segs de contagem para cada nível
+const int letras_por_nivel[] = {5, 6, 7}; // tamanho da palavra sorteada em cada nível
 const int max_nivel = 3; // limite máximo de níveis
 
-bool audio_sample_callback(repeating_timer_t *t) {
-    if (!capturando) return true;
+// Fluxo do jogo: cada estado só espera eventos, nenhum bloqueia o laço principal
+enum {
+    ESTADO_ESPERANDO,        // "pressione B", espera o pedido de palavra
+    ESTADO_PEDINDO_PALAVRA,  // pedir_palavra enviado ao host (o índice dele ou sem palavras na flash)
+    ESTADO_CONTAGEM,         // contagem regressiva na matriz de LEDs
+    ESTADO_AGUARDANDO_A,     // "pressione A" para começar a soletrar
+    ESTADO_GRAVANDO,         // áudio indo para o host
+    ESTADO_ANALISANDO,       // esperando o resultado do reconhecimento
+    ESTADO_MOSTRANDO_ERRO,   // resposta errada na tela antes do GAME OVER
+    ESTADO_LIBERANDO_CAPTURA, // A apertado com a captura anterior ainda saindo pela serial
+};
+
+#define GRAVACAO_MINIMA_US 400000  // A só encerra a gravação depois desse tempo
+#define TEMPO_ERRO_MS 5000         // tempo mostrando a resposta errada
+
+char palavra[100];                 // sorteada do dicionário (ou recebida do host)
+bool host_sorteia = false;         // o host anunciou o índice de dificuldade ("indice <níveis>"): as palavras vêm dele
+#define BRILHO_ANEL 143 // brilho percebido do anel de progresso, o mesmo dos desenhos da matriz
+#define SOLETRADO_MAX 15           // letras que cabem numa linha do display
+char soletrado[SOLETRADO_MAX + 1]; // veredito do host para cada letra já dita ('?' incerta, '_' falta)
+int letras_ditas = 0;
+char linha_serial[LINHA_SERIAL_MAX]; // última linha completa recebida
+linha_serial_t entrada_serial;
+
+int contagem = 0;                  // número mostrado na matriz durante a contagem
+alarm_id_t alarme_jogo = 0;
+uint32_t inicio_gravacao_us = 0;
+uint32_t pedido_a_us = 0;          // quando "pressione A" apareceu, para medir a reação
+uint botao_a, botao_b;
+evento_t aperto_a;                 // A que esperou a captura anterior terminar de sair
+
+maquina_t jogo;
+
+// Liga/desliga a captura no core1. Desligar não espera: o laço principal posta
+// EV_CAPTURA_PARADA quando o quadro de fim sair pela serial
+void set_captura(bool ligar) {
+    capturando = ligar;
+    if (ligar) {
+        audio_pipeline_start(AUDIO_CODEC, &vad_config);
+    } else {
+        audio_pipeline_stop();
+        parando_captura = true;
+    }
+}
+
+// ---------- Fontes de eventos ----------
+
+int64_t alarme_jogo_callback(alarm_id_t id, void *user_data) {
+    alarme_jogo = 0;
+    eventos_post(EV_TEMPORIZADOR, 0);
+    return 0;
+}
+
+void agendar_temporizador(uint32_t ms) {
+    if (alarme_jogo)
+        cancel_alarm(alarme_jogo);
+    alarme_jogo = add_alarm_in_ms(ms, alarme_jogo_callback, NULL, true);
+}
+
+// Traduz os eventos do subsistema de botões para eventos do jogo, com o instante da borda.
+// A vale no aperto (o tempo de reação conta dele); B só ao soltar, e só se não foi
+// um aperto longo: segurar B reinicia o jogo sem antes sortear ou pedir uma palavra.
+void ler_botoes() {
+    botao_evento_t b;
+    while (botoes_pop(&b)) {
+        if (b.tipo == BOTAO_PRESSIONADO && b.botao == botao_a)
+            eventos_post_em(EV_BOTAO_A, 0, b.t_us);
+        else if (b.tipo == BOTAO_CURTO && b.botao == botao_b)
+            eventos_post_em(EV_BOTAO_B, 0, b.t_us);
+        else if (b.tipo == BOTAO_LONGO && b.botao == botao_b)
+            eventos_post_em(EV_BOTAO_B_LONGO, 0, b.t_us);
+    }
+}
 
-    uint16_t raw = adc_read();
-    uint8_t sample = raw >> 4; // 12 bits → 8 bits
-    putchar_raw(sample);
+// Só acorda o laço principal; a leitura dos caracteres acontece fora da IRQ
+void serial_callback(void *param) {
+    __sev();
+}
+
+// "indice <níveis>": o host tem o índice com a dificuldade das palavras e a escada
+// adaptativa; daí em diante a palavra é pedida a ele em vez de sorteada da flash.
+// Ele repete o anúncio a cada linha "palavra" (a Pico pode ter reiniciado).
+bool comando_host(const char *linha) {
+    if (strncmp(linha, "indice ", 7) != 0)
+        return false;
+    host_sorteia = true;
     return true;
 }
 
+// Monta as linhas recebidas do host; cada linha não vazia vira um EV_LINHA_SERIAL,
+// menos os comandos do rastro ("trace", "stats") e o anúncio do índice do host,
+// tratados aqui mesmo.
+// Retorna true se postou uma linha (pode haver mais caracteres esperando).
+bool ler_serial() {
+    int ch;
+    while ((ch = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (linha_serial_alimentar(&entrada_serial, (char)ch)) {
+            rastreio_instante(RT_SERIAL_RX, strlen(entrada_serial.linha));
+            rastreio_cont.linhas_rx++;
+            if (rastreio_comando(entrada_serial.linha) || comando_host(entrada_serial.linha))
+                continue;
+            strcpy(linha_serial, entrada_serial.linha);
+            eventos_post(EV_LINHA_SERIAL, 0);
+            return true; // a próxima linha só é lida depois que esta for tratada
+        }
+    }
+    return false;
+}
+
+// Cada mudança de estado do jogo vai para o rastro
+void registrar_transicao(uint8_t de, uint8_t para, const evento_t *ev) {
+    rastreio_instante(RT_TRANSICAO, (uint16_t)(de << 8 | para));
+}
+
+// "letra <posição> <letra>": veredito do host para uma letra, durante a soletração
+bool ler_letra(int *pos, char *c) {
+    if (strncmp(linha_serial, "letra ", 6) != 0)
+        return false;
+    char *fim;
+    long p = strtol(linha_serial + 6, &fim, 10);
+    if (fim == linha_serial + 6 || fim[0] != ' ' || fim[1] == '\0' || fim[2] != '\0' || p < 0)
+        return false;
+    *pos = (int)p;
+    *c = fim[1];
+    return true;
+}
+
+// ---------- Guardas ----------
+
+bool palavra_na_flash(const evento_t *ev) {
+    return dicionario_total(letras_por_nivel[nivel-1]) > 0;
+}
+
+// Sorteia na flash, a não ser que o host tenha o índice de dificuldade
+bool palavra_no_dicionario(const evento_t *ev) {
+    return !host_sorteia && palavra_na_flash(ev);
+}
+
+bool contagem_em_andamento(const evento_t *ev) {
+    return contagem > 0;
+}
+
+bool captura_parando(const evento_t *ev) {
+    return parando_captura;
+}
+
+bool gravacao_minima(const evento_t *ev) {
+    return ev->t_us - inicio_gravacao_us >= GRAVACAO_MINIMA_US;
+}
+
+bool resposta_certa(const evento_t *ev) {
+    return strstr(linha_serial, palavra) != NULL;
+}
+
+bool linha_de_letra(const evento_t *ev) {
+    int pos;
+    char c;
+    return ler_letra(&pos, &c);
+}
+
+// A próxima letra, certa ou incerta ('?'): só mostra
+bool letra_esperada(const evento_t *ev) {
+    int pos;
+    char c;
+    return ler_letra(&pos, &c) && pos == letras_ditas && pos < (int)strlen(palavra) &&
+           (c == palavra[pos] || c == '?');
+}
+
+// A próxima letra é a última da palavra, certa, e nenhuma ficou incerta
+bool ultima_letra_certa(const evento_t *ev) {
+    return letra_esperada(ev) && linha_serial[strlen(linha_serial) - 1] != '?' &&
+           letras_ditas == (int)strlen(palavra) - 1 && strchr(soletrado, '?') == NULL;
+}
+
+// A próxima letra, errada (ou sobrando) com certeza: encerra a rodada
+bool letra_errada(const evento_t *ev) {
+    int pos;
+    char c;
+    return ler_letra(&pos, &c) && pos == letras_ditas && c != '?';
+}
+
+// ---------- Ações ----------
+
+void tela_inicial(const evento_t *ev) {
+    SSD1306_clear(buf);
+    WriteString(buf, 5, 8, "pressione B");
+    WriteString(buf, 5, 24, "para iniciar");
+    WriteString(buf, 5, 40, "o jogo");
+    render_async(buf, &frame_area);
+    animacao_tocar(&ANIM_SETA_DIREITA);
+}
+
+void pedir_palavra(const evento_t *ev) {
+    printf("pedir_palavra %d\n", nivel);
+    animacao_tocar(&ANIM_GIRANDO);
+}
+
+// Mostra um número da contagem; o beep toca em segundo plano, junto com o render
+void passo_contagem() {
+    agendar_temporizador(1000);
+    animacao_digito(contagem);
+    if (contagem > 0)
+        buzzer_nota(contagem > 5 ? TOM_CONTAGEM : TOM_CONTAGEM_FIM, 500, BUZZER_VOLUME_MAX, BUZZER_ENV_DECAI);
+    else
+        buzzer_nota(TOM_ERRO, 1000, BUZZER_VOLUME_MAX, BUZZER_ENV_PLANO);
+}
+
+void comecar_contagem() {
+    SSD1306_clear(buf);
+    WriteString(buf, 0, 32, palavra);
+    render_async(buf, &frame_area);
+
+    contagem = tempo_por_nivel[nivel-1];
+    passo_contagem();
+}
+
+// Palavra do dicionário na flash; a linha "palavra" avisa o host do que esperar
+void sortear_palavra(const evento_t *ev) {
+    dicionario_sortear(letras_por_nivel[nivel-1], palavra);
+    printf("palavra %d %s\n", nivel, palavra);
+    comecar_contagem();
+}
+
+// B de novo sem resposta ao pedir_palavra: o host sumiu, volta à flash
+void sortear_sem_host(const evento_t *ev) {
+    host_sorteia = false;
+    sortear_palavra(ev);
+}
+
+void iniciar_contagem(const evento_t *ev) {
+    strncpy(palavra, linha_serial, sizeof(palavra) - 1);
+    palavra[sizeof(palavra) - 1] = '\0';
+    comecar_contagem();
+}
+
+void continuar_contagem(const evento_t *ev) {
+    contagem--;
+    passo_contagem();
+}
+
+void pedir_botao_a(const evento_t *ev) {
+    SSD1306_clear(buf);
+    WriteString(buf, 5, 8, "pressione A");
+    WriteString(buf, 5, 24, "para iniciar");
+    WriteString(buf, 5, 40, "a soletrar");
+    render_async(buf, &frame_area);
+    animacao_tocar(&ANIM_SETA_ESQUERDA);
+    pedido_a_us = time_us_32();
+}
+
+// Letras já ditas na linha de cima, sobre o que estiver na tela
+void desenhar_soletrado() {
+    WriteString(buf, 5, 8, soletrado);
+    render_async(buf, &frame_area);
+}
+
+void iniciar_gravacao(const evento_t *ev) {
+    inicio_gravacao_us = ev->t_us;
+    set_captura(true);
+
+    size_t n = strlen(palavra) < SOLETRADO_MAX ? strlen(palavra) : SOLETRADO_MAX;
+    memset(soletrado, '_', n);
+    soletrado[n] = '\0';
+    letras_ditas = 0;
+
+    // Tempo de reação medido na borda do botão, não no fim do debounce
+    uint32_t reacao_ms = (ev->t_us - pedido_a_us) / 1000;
+    printf("reacao_ms %lu\n", (unsigned long)reacao_ms);
+
+    char texto[20];
+    snprintf(texto, sizeof(texto), "reacao %lu ms", (unsigned long)reacao_ms);
+    SSD1306_clear(buf);
+    WriteString(buf, 5, 32, "gravando...");
+    WriteString(buf, 5, 48, texto);
+    desenhar_soletrado();
+    animacao_vu();
+}
+
+// Anel da matriz com as letras já confirmadas; antes da primeira, o cometa girando
+void mostrar_progresso() {
+    if (letras_ditas == 0)
+        animacao_tocar(&ANIM_GIRANDO);
+    else
+        animacao_progresso(letras_ditas, strlen(palavra), 0, 0, BRILHO_ANEL);
+}
+
+// A chegou antes de a captura anterior terminar de sair: grava quando ela sair,
+// com o tempo de reação contado do aperto
+void guardar_aperto_a(const evento_t *ev) {
+    aperto_a = *ev;
+}
+
+void iniciar_gravacao_adiada(const evento_t *ev) {
+    iniciar_gravacao(&aperto_a);
+}
+
+void encerrar_gravacao(const evento_t *ev) {
+    set_captura(false);
+    SSD1306_clear(buf);
+    WriteString(buf, 5, 24, "audio gravado");
+    WriteString(buf, 5, 40, "processando...");
+    desenhar_soletrado();
+    mostrar_progresso();
+}
+
+// Sem beep: durante a captura ele entraria no microfone
+void mostrar_letra(const evento_t *ev) {
+    int pos;
+    char c;
+    if (!ler_letra(&pos, &c))
+        return; // só chega aqui pelas guardas de letra, que já validaram a linha
+    if (pos < SOLETRADO_MAX)
+        soletrado[pos] = c;
+    letras_ditas++;
+    desenhar_soletrado();
+    if (!capturando)
+        mostrar_progresso(); // gravando, a matriz é do VU
+}
+
+// Todas as letras certas: não precisa esperar o fim da fala
+void completar_soletracao(const evento_t *ev) {
+    mostrar_letra(ev);
+    if (capturando)
+        encerrar_gravacao(ev);
+}
+
+void mostrar_acerto(const evento_t *ev) {
+    SSD1306_clear(buf);
+    WriteString(buf, 5, 8, "Parabens!");
+    WriteString(buf, 5, 24, "Certa resposta");
+    render_async(buf, &frame_area);
+    animacao_tocar(&ANIM_CERTO);
+    buzzer_tocar(JINGLE_ACERTO, count_of(JINGLE_ACERTO));
+
+    if (nivel <= max_nivel) {
+        nivel++;
+        if (nivel == 2) {
+            WriteString(buf, 5, 40, "prroximo nivel=");
+            WriteString(buf, 5, 56, "Nivel 2, 5 segs");
+            render_async(buf, &frame_area);
+        } else if (nivel == 3) {
+            WriteString(buf, 5, 40, "prroximo nivel=");
+            WriteString(buf, 5, 56, "Nivel 3, 3 segs");
+            render_async(buf, &frame_area);
+        } else {
+            nivel = 1;
+            WriteString(buf, 5, 40, "Jogo completo!");
+            WriteString(buf, 5, 56, "Pressione B");
+            render_async(buf, &frame_area);
+        }
+    }
+}
+
+void mostrar_erro(const evento_t *ev) {
+    SSD1306_clear(buf);
+    WriteString(buf, 5, 8, "a resposta foi=");
+    WriteString(buf, 5, 24, linha_serial);
+    WriteString(buf, 5, 40, "a palavra era=");
+    WriteString(buf, 5, 56, palavra);
+    render_async(buf, &frame_area);
+    animacao_tocar(&ANIM_ERRADO);
+    buzzer_nota(TOM_ERRO, 1000, BUZZER_VOLUME_MAX, BUZZER_ENV_PLANO);
+    agendar_temporizador(TEMPO_ERRO_MS);
+}
+
+// Letra errada: a resposta mostrada é o que foi soletrado até ela
+void errar_letra(const evento_t *ev) {
+    int pos;
+    char c;
+    if (!ler_letra(&pos, &c)) {
+        pos = 0; // não acontece (a guarda letra_errada já leu a linha); só a letra
+        c = '?';
+    }
+    if (capturando)
+        set_captura(false);
+    snprintf(linha_serial, sizeof(linha_serial), "%.*s%c",
+             pos < SOLETRADO_MAX ? pos : SOLETRADO_MAX, soletrado, c);
+    mostrar_erro(ev);
+}
+
 // Função para resetar jogo
-void reset_jogo() {
+void reset_jogo(const evento_t *ev) {
     nivel = 1;
-    memset(buf, 0, SSD1306_BUF_LEN);
+    SSD1306_clear(buf);
     WriteString(buf, 20, 24, "GAME OVER");
-    render(buf, &frame_area);
-}
-
-void process_received_line(char* line, char* buffer) {
-    if (strstr(line, buffer) != NULL) {
-        memset(buf, 0, SSD1306_BUF_LEN);
-        WriteString(buf, 5, 8, "Parabens!");
-        WriteString(buf, 5, 24, "Certa resposta");
-        render(buf, &frame_area);
-        npWriteV();
-        beep(BUZZER_PIN_A, 120, 400);
-        sleep_ms(200);
-        beep(BUZZER_PIN_A, 120, 400);
-
-        if (nivel <= max_nivel) {
-            nivel++;
-            if (nivel == 2) {
-                WriteString(buf, 5, 40, "prroximo nivel=");
-                WriteString(buf, 5, 56, "Nivel 2, 5 segs");
-                render(buf, &frame_area);
-            } else if (nivel == 3) {
-                WriteString(buf, 5, 40, "prroximo nivel=");
-                WriteString(buf, 5, 56, "Nivel 3, 3 segs");
-                render(buf, &frame_area);
-            } else {
-                nivel = 1;
-                WriteString(buf, 5, 40, "Jogo completo!");
-                WriteString(buf, 5, 56, "Pressione B");
-                render(buf, &frame_area);
-            }
-        }
-        analisando = false; // sai do loop e vai pro próximo
-    } else {
-        memset(buf, 0, SSD1306_BUF_LEN);
-        WriteString(buf, 5, 8, "a resposta foi=");
-        WriteString(buf, 5, 24, line);
-        WriteString(buf, 5, 40, "a palavra era=");
-        WriteString(buf, 5, 56, buffer);
-        render(buf, &frame_area);
-        npWriteX();
-        beep(BUZZER_PIN_A, 100, 1000);
-        sleep_ms(5000);
-        reset_jogo();
-        analisando = false; // volta para pedir palavra de novo
+    render_async(buf, &frame_area);
+    animacao_apagar();
+}
+
+// B segurado: abandona a rodada em qualquer estado e volta à tela inicial. O host
+// fica sabendo antes do FIM da captura, para não julgar a rodada abandonada.
+void reiniciar_jogo(const evento_t *ev) {
+    if (alarme_jogo) {
+        cancel_alarm(alarme_jogo);
+        alarme_jogo = 0;
     }
+    printf("cancelar\n");
+    if (capturando)
+        set_captura(false);
+    buzzer_cancelar();
+    nivel = 1;
+    tela_inicial(ev);
 }
 
+// esperando → palavra sorteada → contagem → gravando → analisando → resultado/game over
+// Durante a gravação e a análise, o host manda o veredito de cada letra ("letra
+// <pos> <c>"): todas certas ou uma errada encerram a rodada antes do fim da fala.
+const transicao_t transicoes[] = {
+    // estado                  evento           guarda                  ação                próximo
+    {ESTADO_ESPERANDO,        EV_BOTAO_B,      palavra_no_dicionario,  sortear_palavra,    ESTADO_CONTAGEM},
+    {ESTADO_ESPERANDO,        EV_BOTAO_B,      NULL,                   pedir_palavra,      ESTADO_PEDINDO_PALAVRA},
+    {ESTADO_PEDINDO_PALAVRA,  EV_BOTAO_B,      palavra_na_flash,       sortear_sem_host,   ESTADO_CONTAGEM},
+    {ESTADO_PEDINDO_PALAVRA,  EV_BOTAO_B,      NULL,                   pedir_palavra,      ESTADO_PEDINDO_PALAVRA},
+    {ESTADO_PEDINDO_PALAVRA,  EV_LINHA_SERIAL, NULL,                   iniciar_contagem,   ESTADO_CONTAGEM},
+    {ESTADO_CONTAGEM,         EV_TEMPORIZADOR, contagem_em_andamento,  continuar_contagem, ESTADO_CONTAGEM},
+    {ESTADO_CONTAGEM,         EV_TEMPORIZADOR, NULL,                   pedir_botao_a,      ESTADO_AGUARDANDO_A},
+    {ESTADO_AGUARDANDO_A,     EV_BOTAO_A,      captura_parando,        guardar_aperto_a,   ESTADO_LIBERANDO_CAPTURA},
+    {ESTADO_AGUARDANDO_A,     EV_BOTAO_A,      NULL,                   iniciar_gravacao,   ESTADO_GRAVANDO},
+    {ESTADO_LIBERANDO_CAPTURA, EV_CAPTURA_PARADA, NULL,                iniciar_gravacao_adiada, ESTADO_GRAVANDO},
+    {ESTADO_GRAVANDO,         EV_BOTAO_A,      gravacao_minima,        encerrar_gravacao,  ESTADO_ANALISANDO},
+    {ESTADO_GRAVANDO,         EV_CAPTURA_FIM,  NULL,                   encerrar_gravacao,  ESTADO_ANALISANDO},
+    {ESTADO_GRAVANDO,         EV_LINHA_SERIAL, ultima_letra_certa,     completar_soletracao, ESTADO_ANALISANDO},
+    {ESTADO_GRAVANDO,         EV_LINHA_SERIAL, letra_esperada,         mostrar_letra,      ESTADO_GRAVANDO},
+    {ESTADO_GRAVANDO,         EV_LINHA_SERIAL, letra_errada,           errar_letra,        ESTADO_MOSTRANDO_ERRO},
+    {ESTADO_ANALISANDO,       EV_LINHA_SERIAL, ultima_letra_certa,     completar_soletracao, ESTADO_ANALISANDO},
+    {ESTADO_ANALISANDO,       EV_LINHA_SERIAL, letra_esperada,         mostrar_letra,      ESTADO_ANALISANDO},
+    {ESTADO_ANALISANDO,       EV_LINHA_SERIAL, letra_errada,           errar_letra,        ESTADO_MOSTRANDO_ERRO},
+    {ESTADO_ANALISANDO,       EV_LINHA_SERIAL, linha_de_letra,         NULL,               ESTADO_ANALISANDO},
+    {ESTADO_ANALISANDO,       EV_LINHA_SERIAL, resposta_certa,         mostrar_acerto,     ESTADO_ESPERANDO},
+    {ESTADO_ANALISANDO,       EV_LINHA_SERIAL, NULL,                   mostrar_erro,       ESTADO_MOSTRANDO_ERRO},
+    {ESTADO_MOSTRANDO_ERRO,   EV_TEMPORIZADOR, NULL,                   reset_jogo,         ESTADO_ESPERANDO},
+    {MAQUINA_QUALQUER,        EV_BOTAO_B_LONGO, NULL,                  reiniciar_jogo,     ESTADO_ESPERANDO},
+};
+
 int main()
 {
     stdio_init_all();
     sleep_ms(5000);
 
-    // ADC - Microfone
-    adc_init();
-    adc_gpio_init(ADC_PIN);
-    adc_select_input(2); // GPIO28 = ADC2
+    // ADC - Microfone (GPIO28 = ADC2): captura, DMA e codec rodam no core1
+    audio_pipeline_init(ADC_PIN, SAMPLE_RATE_HZ);
 
     // matriz de led
     npInit(7); // ou LED_PIN, se definir no header
 
+    // buzzer: as notas tocam em segundo plano, por alarmes
+    pwm_init_buzzer(BUZZER_PIN_A);
+
     //configuração do display ssd1306
     i2c_init(i2c_default, 400 * 1000);
     gpio_set_function(PICO_DEFAULT_I2C_SDA_PIN, GPIO_FUNC_I2C);
@@ -120,128 +521,53 @@ int main()
     gpio_pull_up(PICO_DEFAULT_I2C_SCL_PIN);
     SSD1306_init();
 
-    memset(buf, 0, SSD1306_BUF_LEN);
+    SSD1306_clear(buf);
     calc_render_area_buflen(&frame_area);
 
-    render(buf, &frame_area);
+#ifdef FIRMWARE_BENCH
+    bench_firmware_rodar(buf, &frame_area, BUZZER_PIN_A);
+    SSD1306_clear(buf);
+#endif
 
-    // Botão
-    gpio_init(BUTTON_PIN_A);
-    gpio_set_dir(BUTTON_PIN_A, GPIO_IN);
-    gpio_pull_up(BUTTON_PIN_A);
-    gpio_init(BUTTON_PIN_B);
-    gpio_set_dir(BUTTON_PIN_B, GPIO_IN);
-    gpio_pull_up(BUTTON_PIN_B);
+    // Matriz de LEDs: daqui em diante só pelas animações
+    animacao_init();
 
-    // Inicia amostragem periódica
-    repeating_timer_t timer;
-    add_repeating_timer_us(-1000000 / SAMPLE_RATE_HZ, audio_sample_callback, NULL, &timer);
+    render_async(buf, &frame_area);
 
-    char buffer[100];
-    int idx = 0;
-    bool esperando = true;
+    // Botões: IRQ de borda + debounce por alarme, eventos com carimbo de tempo
+    botao_a = botoes_adicionar(BUTTON_PIN_A);
+    botao_b = botoes_adicionar(BUTTON_PIN_B);
 
-    char input_line[MAX_LINE_LEN];
-    int input_pos = 0;
+    stdio_set_chars_available_callback(serial_callback, NULL);
 
-    memset(buf, 0, SSD1306_BUF_LEN);
-    WriteString(buf, 5, 8, "pressione B");
-    WriteString(buf, 5, 24, "para iniciar");
-    WriteString(buf, 5, 40, "o jogo");
-    render(buf, &frame_area);
-    npWriteRigth();
+    maquina_init(&jogo, transicoes, count_of(transicoes), ESTADO_ESPERANDO);
+    jogo.ao_mudar = registrar_transicao;
+    tela_inicial(NULL);
 
     while (true) {
-        if (esperando && !gpio_get(BUTTON_PIN_B)) {
-            printf("pedir_palavra %d\n", nivel);
-            esperando = false;  // evita múltiplos envios com botão pressionado
+        bool linha_nova = ler_serial();
+        ler_botoes();
+
+        // Quadros de áudio do core1 para a USB; o fim pelo VAD vira evento
+        audio_pipeline_poll();
+        if (capturando && !audio_pipeline_capturando()) {
+            capturando = false;
+            eventos_post(EV_CAPTURA_FIM, 0);
         }
-
-        // Lê resposta do PC
-        int ch = getchar_timeout_us(0);
-        if (ch != PICO_ERROR_TIMEOUT) {
-            if (ch == '\n' || ch == '\r') {
-                buffer[idx] = '\0';
-                memset(buf, 0, SSD1306_BUF_LEN);
-                WriteString(buf, 0, 32, buffer);
-                render(buf, &frame_area);
-                idx = 0;
-
-                int tempo = tempo_por_nivel[nivel-1] + 1;
-
-                //desnhando na matriz de led
-                for (uint8_t i = tempo; i > 0; i--) {
-                    npWriteNumber(i-1);
-                    beep(BUZZER_PIN_A, (i-1 > 5 ? 130 : (i-1 > 0 ? 110 : 100)), (i-1 > 0 ? 500 : 1000));
-                    sleep_ms(i-1 > 0 ? 500 : 0);
-                }
-
-                memset(buf, 0, SSD1306_BUF_LEN);
-                WriteString(buf, 5, 8, "pressione A");
-                WriteString(buf, 5, 24, "para iniciar");
-                WriteString(buf, 5, 40, "a soletrar");
-                render(buf, &frame_area);
-
-                npWriteLeft();
-
-                while (gpio_get(BUTTON_PIN_A))
-                {
-                    sleep_ms(10);
-                }
-
-                sleep_ms(10);
-                
-                capturando = !capturando;  // inverte estado
-                memset(buf, 0, SSD1306_BUF_LEN);
-                WriteString(buf, 5, 32, "gravando...");
-                render(buf, &frame_area);
-                npWriteFace();
-
-                // Aplica o debounce após a ação inicial do botão
-                sleep_ms(400);
-
-                while (gpio_get(BUTTON_PIN_A))
-                {
-                    sleep_ms(10);
-                }
-
-                sleep_ms(10);
-
-                capturando = !capturando;  // inverte estado
-                analisando = !analisando;
-                memset(buf, 0, SSD1306_BUF_LEN);
-                WriteString(buf, 5, 24, "audio gravado");
-                WriteString(buf, 5, 40, "processando...");
-                render(buf, &frame_area);
-
-                // Aplica o debounce após a ação inicial do botão
-                sleep_ms(400);
-
-                while (analisando)
-                {
-                    int c = getchar_timeout_us(0);  // 0 = sem esperar
-                    if (c != PICO_ERROR_TIMEOUT) {
-                        if (c == '\n' || c == '\r') {
-                            input_line[input_pos] = '\0';
-                            process_received_line(input_line, buffer);
-                            input_pos = 0;
-                        } else if (input_pos < MAX_LINE_LEN - 1) {
-                            input_line[input_pos++] = (char)c;
-                        }
-                    }
-                    sleep_ms(10);
-                }
-
-            } else if (idx < sizeof(buffer) - 1) {
-                buffer[idx++] = (char)ch;
-            }
+        if (parando_captura && audio_pipeline_idle()) {
+            parando_captura = false;
+            eventos_post(EV_CAPTURA_PARADA, 0);
         }
 
-        // Espera botão soltar
-        if (gpio_get(BUTTON_PIN_B)) {
-            esperando = true;
+        evento_t ev;
+        while (eventos_pop(&ev)) {
+            rastreio_instante(RT_EVENTO, ev.tipo);
+            maquina_despachar(&jogo, &ev);
         }
 
-        sleep_ms(10);
+        // Dorme até a próxima interrupção (botão, alarme, USB) ou __sev() do core1.
+        // Parando a captura, não: o core1 libera o pipeline sem acordar ninguém
+        if (!linha_nova && eventos_vazio() && !parando_captura)
+            __wfe();
     }
 }
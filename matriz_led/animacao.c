@@ -0,0 +1,238 @@
+// matriz_led/animacao.c
+
+#include "animacao.h"
+#include "hardware/sync.h"
+#include "neopixel_pio.h"
+#include "microfone/pipeline_audio.h"
+
+#define NUM_LEDS 25
+
+// Índice do LED na coordenada (x, y), com y = 0 no topo: as linhas da
+// BitDogLab são em serpentina e o LED 24 fica no canto superior esquerdo
+#define IDX(x, y) (24 - ((y) * 5 + (((y) & 1) ? 4 - (x) : (x))))
+#define B(x, y) (1u << IDX(x, y))
+
+// Uma linha do desenho, da esquerda para a direita
+#define L(y, a, b, c, d, e) \
+  ((a) ? B(0, y) : 0) | ((b) ? B(1, y) : 0) | ((c) ? B(2, y) : 0) | ((d) ? B(3, y) : 0) | ((e) ? B(4, y) : 0)
+
+#define QUADRO(m, r, g, b) {(m), ANIMACAO_GAMA(r), ANIMACAO_GAMA(g), ANIMACAO_GAMA(b)}
+#define NIVEL(v, k) ((v) * (k) / 8)
+
+// Acende em 8 passos; PULSO acende e apaga
+#define ACENDER(m, r, g, b)                                                                     \
+  QUADRO(m, NIVEL(r, 1), NIVEL(g, 1), NIVEL(b, 1)), QUADRO(m, NIVEL(r, 2), NIVEL(g, 2), NIVEL(b, 2)), \
+  QUADRO(m, NIVEL(r, 3), NIVEL(g, 3), NIVEL(b, 3)), QUADRO(m, NIVEL(r, 4), NIVEL(g, 4), NIVEL(b, 4)), \
+  QUADRO(m, NIVEL(r, 5), NIVEL(g, 5), NIVEL(b, 5)), QUADRO(m, NIVEL(r, 6), NIVEL(g, 6), NIVEL(b, 6)), \
+  QUADRO(m, NIVEL(r, 7), NIVEL(g, 7), NIVEL(b, 7)), QUADRO(m, r, g, b)
+#define APAGAR(m, r, g, b)                                                                      \
+  QUADRO(m, NIVEL(r, 7), NIVEL(g, 7), NIVEL(b, 7)), QUADRO(m, NIVEL(r, 6), NIVEL(g, 6), NIVEL(b, 6)), \
+  QUADRO(m, NIVEL(r, 5), NIVEL(g, 5), NIVEL(b, 5)), QUADRO(m, NIVEL(r, 4), NIVEL(g, 4), NIVEL(b, 4)), \
+  QUADRO(m, NIVEL(r, 3), NIVEL(g, 3), NIVEL(b, 3)), QUADRO(m, NIVEL(r, 2), NIVEL(g, 2), NIVEL(b, 2)), \
+  QUADRO(m, NIVEL(r, 1), NIVEL(g, 1), NIVEL(b, 1)), QUADRO(m, 0, 0, 0)
+#define PULSO(m, r, g, b) ACENDER(m, r, g, b), APAGAR(m, r, g, b)
+
+// 143 percebido dá 80 no fio, o brilho que os desenhos sempre usaram
+#define CHEIO 143
+
+// ---------- desenhos ----------
+
+#define G_0 (L(0, 0,1,1,1,0) | L(1, 0,1,0,1,0) | L(2, 0,1,0,1,0) | L(3, 0,1,0,1,0) | L(4, 0,1,1,1,0))
+#define G_1 (L(0, 0,0,0,1,0) | L(1, 0,0,0,1,0) | L(2, 0,0,0,1,0) | L(3, 0,0,0,1,0) | L(4, 0,0,0,1,0))
+#define G_2 (L(0, 0,1,1,1,0) | L(1, 0,0,0,1,0) | L(2, 0,1,1,1,0) | L(3, 0,1,0,0,0) | L(4, 0,1,1,1,0))
+#define G_3 (L(0, 0,1,1,1,0) | L(1, 0,0,0,1,0) | L(2, 0,1,1,1,0) | L(3, 0,0,0,1,0) | L(4, 0,1,1,1,0))
+#define G_4 (L(0, 0,1,0,1,0) | L(1, 0,1,0,1,0) | L(2, 0,1,1,1,0) | L(3, 0,0,0,1,0) | L(4, 0,0,0,1,0))
+#define G_5 (L(0, 0,1,1,1,0) | L(1, 0,1,0,0,0) | L(2, 0,1,1,1,0) | L(3, 0,0,0,1,0) | L(4, 0,1,1,1,0))
+#define G_6 (L(0, 0,1,1,1,0) | L(1, 0,1,0,0,0) | L(2, 0,1,1,1,0) | L(3, 0,1,0,1,0) | L(4, 0,1,1,1,0))
+#define G_7 (L(0, 0,1,1,1,0) | L(1, 0,0,0,1,0) | L(2, 0,0,0,1,0) | L(3, 0,0,0,1,0) | L(4, 0,0,0,1,0))
+#define G_8 (L(0, 0,1,1,1,0) | L(1, 0,1,0,1,0) | L(2, 0,1,1,1,0) | L(3, 0,1,0,1,0) | L(4, 0,1,1,1,0))
+#define G_9 (L(0, 0,1,1,1,0) | L(1, 0,1,0,1,0) | L(2, 0,1,1,1,0) | L(3, 0,0,0,1,0) | L(4, 0,1,1,1,0))
+#define G_10 (L(0, 1,0,1,1,1) | L(1, 1,0,1,0,1) | L(2, 1,0,1,0,1) | L(3, 1,0,1,0,1) | L(4, 1,0,1,1,1))
+
+#define G_SETA_ESQ (L(0, 0,0,1,0,0) | L(1, 0,1,1,0,0) | L(2, 1,1,1,1,1) | L(3, 0,1,1,0,0) | L(4, 0,0,1,0,0))
+#define G_SETA_DIR (L(0, 0,0,1,0,0) | L(1, 0,0,1,1,0) | L(2, 1,1,1,1,1) | L(3, 0,0,1,1,0) | L(4, 0,0,1,0,0))
+#define G_V        (L(0, 0,0,0,0,0) | L(1, 0,0,0,0,1) | L(2, 0,0,0,1,0) | L(3, 1,0,1,0,0) | L(4, 0,1,0,0,0))
+#define G_X        (L(0, 1,0,0,0,1) | L(1, 0,1,0,1,0) | L(2, 0,0,1,0,0) | L(3, 0,1,0,1,0) | L(4, 1,0,0,0,1))
+
+// Borda da matriz no sentido horário, a partir do canto superior esquerdo
+#define A(i) B_ANEL_##i
+#define B_ANEL_0 B(0, 0)
+#define B_ANEL_1 B(1, 0)
+#define B_ANEL_2 B(2, 0)
+#define B_ANEL_3 B(3, 0)
+#define B_ANEL_4 B(4, 0)
+#define B_ANEL_5 B(4, 1)
+#define B_ANEL_6 B(4, 2)
+#define B_ANEL_7 B(4, 3)
+#define B_ANEL_8 B(4, 4)
+#define B_ANEL_9 B(3, 4)
+#define B_ANEL_10 B(2, 4)
+#define B_ANEL_11 B(1, 4)
+#define B_ANEL_12 B(0, 4)
+#define B_ANEL_13 B(0, 3)
+#define B_ANEL_14 B(0, 2)
+#define B_ANEL_15 B(0, 1)
+
+static const uint32_t anel[16] = {
+    A(0), A(1), A(2), A(3), A(4), A(5), A(6), A(7), A(8), A(9), A(10), A(11), A(12), A(13), A(14), A(15),
+};
+
+// Cometa de três LEDs dando a volta na borda
+#define COMETA(a, b, c) QUADRO(A(a) | A(b) | A(c), 0, 0, CHEIO)
+
+// ---------- tabelas ----------
+
+static const quadro_led_t q_seta_esq[] = {PULSO(G_SETA_ESQ, 0, 0, CHEIO)};
+static const quadro_led_t q_seta_dir[] = {PULSO(G_SETA_DIR, 0, 0, CHEIO)};
+static const quadro_led_t q_certo[] = {ACENDER(G_V, 0, CHEIO, 0)};
+static const quadro_led_t q_errado[] = {ACENDER(G_X, CHEIO, 0, 0)};
+static const quadro_led_t q_girando[] = {
+    COMETA(0, 15, 14), COMETA(1, 0, 15),  COMETA(2, 1, 0),    COMETA(3, 2, 1),
+    COMETA(4, 3, 2),   COMETA(5, 4, 3),   COMETA(6, 5, 4),    COMETA(7, 6, 5),
+    COMETA(8, 7, 6),   COMETA(9, 8, 7),   COMETA(10, 9, 8),   COMETA(11, 10, 9),
+    COMETA(12, 11, 10), COMETA(13, 12, 11), COMETA(14, 13, 12), COMETA(15, 14, 13),
+};
+
+static const quadro_led_t q_digitos[11][8] = {
+    {ACENDER(G_0, CHEIO, 0, 0)}, {ACENDER(G_1, CHEIO, 0, 0)}, {ACENDER(G_2, CHEIO, 0, 0)},
+    {ACENDER(G_3, CHEIO, 0, 0)}, {ACENDER(G_4, CHEIO, 0, 0)}, {ACENDER(G_5, CHEIO, 0, 0)},
+    {ACENDER(G_6, 0, CHEIO, 0)}, {ACENDER(G_7, 0, CHEIO, 0)}, {ACENDER(G_8, 0, CHEIO, 0)},
+    {ACENDER(G_9, 0, CHEIO, 0)}, {ACENDER(G_10, 0, CHEIO, 0)},
+};
+
+const animacao_t ANIM_SETA_ESQUERDA = {q_seta_esq, count_of(q_seta_esq), 2, true};
+const animacao_t ANIM_SETA_DIREITA = {q_seta_dir, count_of(q_seta_dir), 2, true};
+const animacao_t ANIM_GIRANDO = {q_girando, count_of(q_girando), 2, true};
+const animacao_t ANIM_CERTO = {q_certo, count_of(q_certo), 1, false};
+const animacao_t ANIM_ERRADO = {q_errado, count_of(q_errado), 1, false};
+
+// ---------- motor ----------
+
+typedef enum { MODO_PARADO, MODO_QUADROS, MODO_VU } modo_t;
+
+static struct repeating_timer timer;
+static bool timer_ativo = false;
+static modo_t modo = MODO_PARADO;
+static animacao_t atual;  // cópia: a dos dígitos é montada na hora
+static uint quadro_atual, passo;
+static quadro_led_t na_tela;
+
+static void desenhar(const quadro_led_t *q) {
+  if (q->mascara == na_tela.mascara && q->r == na_tela.r && q->g == na_tela.g && q->b == na_tela.b)
+    return;
+  for (uint i = 0; i < NUM_LEDS; i++) {
+    if (q->mascara & (1u << i))
+      npSetLED(i, q->r, q->g, q->b);
+    else
+      npSetLED(i, 0, 0, 0);
+  }
+  npWrite();
+  na_tela = *q;
+}
+
+// Barras de baixo para cima; limiares em escala aproximadamente logarítmica
+static quadro_led_t quadro_vu(uint16_t nivel) {
+  static const uint16_t limiares[5] = {24, 64, 160, 400, 1000};
+  static const uint32_t linhas[5] = {
+      L(4, 1,1,1,1,1), L(3, 1,1,1,1,1), L(2, 1,1,1,1,1), L(1, 1,1,1,1,1), L(0, 1,1,1,1,1),
+  };
+  quadro_led_t q = {0, 0, 0, 0};
+  uint barras = 0;
+
+  while (barras < 5 && nivel >= limiares[barras])
+    q.mascara |= linhas[barras++];
+  // verde, amarelo perto do topo, vermelho saturando
+  q.r = barras >= 5 ? ANIMACAO_GAMA(CHEIO) : barras >= 4 ? ANIMACAO_GAMA(CHEIO / 2) : 0;
+  q.g = barras >= 5 ? 0 : ANIMACAO_GAMA(CHEIO);
+  return q;
+}
+
+// Roda no IRQ do timer; devolve false quando não há mais o que animar
+static bool proximo_quadro(struct repeating_timer *t) {
+  switch (modo) {
+    case MODO_VU: {
+      quadro_led_t q = quadro_vu(audio_pipeline_nivel());
+      desenhar(&q);
+      return true;
+    }
+    case MODO_QUADROS:
+      if (++passo < atual.passos_por_quadro)
+        return true;
+      passo = 0;
+      if (quadro_atual + 1 < atual.num_quadros)
+        quadro_atual++;
+      else if (atual.repetir)
+        quadro_atual = 0;
+      else
+        break; // último quadro já na tela
+      desenhar(&atual.quadros[quadro_atual]);
+      return true;
+    default:
+      break;
+  }
+  timer_ativo = false;
+  return false;
+}
+
+// Troca o que está tocando e desenha o primeiro quadro na hora
+static void comecar(modo_t novo, const animacao_t *a) {
+  uint32_t status = save_and_disable_interrupts();
+  modo = novo;
+  if (a)
+    atual = *a;
+  quadro_atual = 0;
+  passo = 0;
+  if (novo == MODO_QUADROS)
+    desenhar(&atual.quadros[0]);
+  else if (novo == MODO_VU) {
+    quadro_led_t q = quadro_vu(audio_pipeline_nivel());
+    desenhar(&q);
+  }
+
+  bool anima = novo == MODO_VU || (novo == MODO_QUADROS && (atual.num_quadros > 1 || atual.repetir));
+  if (anima && !timer_ativo)
+    timer_ativo = add_repeating_timer_us(-1000000 / ANIMACAO_FPS, proximo_quadro, NULL, &timer);
+  restore_interrupts(status);
+}
+
+void animacao_init(void) {
+  quadro_led_t apagado = {0, 0, 0, 0};
+  na_tela.mascara = 1; // força o primeiro desenho
+  desenhar(&apagado);
+}
+
+void animacao_tocar(const animacao_t *a) {
+  comecar(MODO_QUADROS, a);
+}
+
+void animacao_digito(uint n) {
+  if (n > 10) return; // evita valores inválidos
+  animacao_t a = {q_digitos[n], count_of(q_digitos[n]), 1, false};
+  comecar(MODO_QUADROS, &a);
+}
+
+void animacao_vu(void) {
+  comecar(MODO_VU, NULL);
+}
+
+void animacao_progresso(uint feito, uint total, uint8_t r, uint8_t g, uint8_t b) {
+  static quadro_led_t q;
+  uint acesos = total ? (feito >= total ? 16 : feito * 16 / total) : 0;
+
+  uint32_t status = save_and_disable_interrupts();
+  q.mascara = 0;
+  for (uint i = 0; i < acesos; i++)
+    q.mascara |= anel[i];
+  q.r = ANIMACAO_GAMA(r);
+  q.g = ANIMACAO_GAMA(g);
+  q.b = ANIMACAO_GAMA(b);
+  animacao_t a = {&q, 1, 1, false};
+  comecar(MODO_QUADROS, &a);
+  restore_interrupts(status);
+}
+
+void animacao_apagar(void) {
+  static const quadro_led_t apagado = {0, 0, 0, 0};
+  animacao_t a = {&apagado, 1, 1, false};
+  comecar(MODO_QUADROS, &a);
+}
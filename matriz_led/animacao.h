@@ -0,0 +1,56 @@
+// matriz_led/animacao.h
+
+#ifndef ANIMACAO_H
+#define ANIMACAO_H
+
+#include "pico/stdlib.h"
+
+/*
+ * Animações da matriz 5x5 tocadas por um repeating_timer a ANIMACAO_FPS.
+ * Os quadros são tabelas montadas em tempo de compilação (máscara de 25 bits
+ * + cor já com a correção de gama), então cada passo só copia um quadro; se
+ * ele não mudou, nem o npWrite() acontece. Quando a animação para no último
+ * quadro o timer é desligado até a próxima.
+ *
+ * Todo desenho na matriz passa por aqui: depois de animacao_init() não chame
+ * npSetLED()/npWrite() direto.
+ */
+
+#define ANIMACAO_FPS 30
+
+typedef struct {
+  uint32_t mascara; // bit i = LED i aceso
+  uint8_t r, g, b;  // valor no fio (gama já aplicada)
+} quadro_led_t;
+
+typedef struct {
+  const quadro_led_t *quadros;
+  uint8_t num_quadros;
+  uint8_t passos_por_quadro; // quantos ticks do timer cada quadro fica
+  bool repetir;              // senão para no último quadro
+} animacao_t;
+
+// Brilho percebido (0..255) para o valor no fio, gama 2
+#define ANIMACAO_GAMA(v) ((uint8_t)(((uint32_t)(v) * (v) + 254) / 255))
+
+extern const animacao_t ANIM_SETA_ESQUERDA; // "pressione A", pulsando
+extern const animacao_t ANIM_SETA_DIREITA;  // "pressione B", pulsando
+extern const animacao_t ANIM_GIRANDO;       // esperando o host
+extern const animacao_t ANIM_CERTO;
+extern const animacao_t ANIM_ERRADO;
+
+void animacao_init(void);
+void animacao_tocar(const animacao_t *a);
+
+// Dígito da contagem (0..10) acendendo; 0 a 5 em vermelho, o resto em verde
+void animacao_digito(uint n);
+
+// VU do microfone ao vivo (audio_pipeline_nivel), barras de baixo para cima
+void animacao_vu(void);
+
+// Anel da borda preenchido na proporção feito/total
+void animacao_progresso(uint feito, uint total, uint8_t r, uint8_t g, uint8_t b);
+
+void animacao_apagar(void);
+
+#endif
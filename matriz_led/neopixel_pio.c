@@ -4,10 +4,15 @@
 #include "pico/stdlib.h"
 #include "hardware/pio.h"
 #include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "hardware/sync.h"
 #include "ws2818b.pio.h"
+#include "rastreio/rastreio.h"
 
 #define LED_COUNT 25
 #define LED_PIN 7
+#define LED_FREQ_HZ 800000
+#define RESET_US 100       // sinal de RESET do datasheet (mínimo 50 us), com folga
 
 // Definição de pixel GRB
 struct pixel_t {
@@ -16,12 +21,45 @@ struct pixel_t {
 typedef struct pixel_t pixel_t;
 typedef pixel_t npLED_t; // Mudança de nome de "struct pixel_t" para "npLED_t" por clareza.
 
-// Declaração do buffer de pixels que formam a matriz.
+// Declaração do buffer de pixels que formam a matriz (é onde os padrões desenham).
 npLED_t leds[LED_COUNT];
 
+// Quadros empacotados para o DMA, um pixel por palavra: enquanto um sai pelo
+// fio o outro recebe o próximo, então um quadro nunca muda no meio do envio.
+static uint32_t quadros[2][LED_COUNT];
+static uint quadro_livre = 0;
+static volatile bool ocupado = false;  // DMA enviando ou no intervalo de reset
+static volatile bool pendente = false; // quadro_livre tem um quadro esperando a vez
+
 // Variáveis para uso da máquina PIO.
 PIO np_pio;
 uint sm;
+static int dma_leds = -1;
+
+static void enviar_quadro(uint i);
+
+// Fim do quadro no fio + RESET: a fita já travou as cores, pode mandar o próximo
+static int64_t fim_do_reset(alarm_id_t id, void *user_data) {
+  rastreio_fim(RT_NPWRITE, 0);
+  ocupado = false;
+  if (pendente) {
+    pendente = false;
+    enviar_quadro(quadro_livre);
+  }
+  return 0;
+}
+
+// Chamado com as interrupções desligadas ou de dentro do alarme
+static void enviar_quadro(uint i) {
+  ocupado = true;
+  quadro_livre = i ^ 1;
+  rastreio_inicio(RT_NPWRITE, i);
+  dma_channel_transfer_from_buffer_now(dma_leds, quadros[i], LED_COUNT);
+
+  // O DMA só alimenta a FIFO; o fio leva 24 bits por LED a LED_FREQ_HZ
+  uint32_t fio_us = (LED_COUNT * 24 * 1000000u + LED_FREQ_HZ - 1) / LED_FREQ_HZ;
+  add_alarm_in_us(fio_us + RESET_US, fim_do_reset, NULL, true);
+}
 
 /**
  * Inicializa a máquina PIO para controle da matriz de LEDs.
@@ -40,7 +78,16 @@ void npInit(uint pin) {
   }
 
   // Inicia programa na máquina PIO obtida.
-  ws2818b_program_init(np_pio, sm, offset, pin, 800000.f);
+  ws2818b_program_init(np_pio, sm, offset, pin, (float)LED_FREQ_HZ);
+
+  // DMA de palavras de 32 bits para a FIFO TX, no ritmo em que a PIO as consome
+  dma_leds = dma_claim_unused_channel(true);
+  dma_channel_config c = dma_channel_get_default_config(dma_leds);
+  channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+  channel_config_set_read_increment(&c, true);
+  channel_config_set_write_increment(&c, false);
+  channel_config_set_dreq(&c, pio_get_dreq(np_pio, sm, true));
+  dma_channel_configure(dma_leds, &c, &np_pio->txf[sm], quadros[0], 0, false);
 
   // Limpa buffer de pixels.
   for (uint i = 0; i < LED_COUNT; ++i) {
@@ -68,135 +115,28 @@ void npClear() {
 }
 
 /**
- * Escreve os dados do buffer nos LEDs.
+ * Escreve os dados do buffer nos LEDs sem esperar: empacota o quadro e o
+ * entrega ao DMA. Se o anterior ainda estiver saindo, este vai logo depois do
+ * reset; chamadas nesse meio tempo só substituem o quadro que está esperando.
  */
 void npWrite() {
-  // Escreve cada dado de 8-bits dos pixels em sequência no buffer da máquina PIO.
-  for (uint i = 0; i < LED_COUNT; ++i) {
-    pio_sm_put_blocking(np_pio, sm, leds[i].G);
-    pio_sm_put_blocking(np_pio, sm, leds[i].R);
-    pio_sm_put_blocking(np_pio, sm, leds[i].B);
-  }
-  sleep_us(100); // Espera 100us, sinal de RESET do datasheet.
-}
-
-// Mapas de LEDs para cada dígito
-static const uint8_t leds0[]  = {23, 22, 21, 18, 16, 13, 11, 8, 6, 1, 2, 3};
-static const uint8_t leds1[]  = {21, 18, 11, 8, 1};
-static const uint8_t leds2[]  = {23, 22, 21, 18, 13, 12, 11, 6, 1, 2, 3};
-static const uint8_t leds3[]  = {23, 22, 21, 18, 13, 12, 11, 8, 1, 2, 3};
-static const uint8_t leds4[]  = {23, 21, 18, 16, 13, 12, 11, 8, 1};
-static const uint8_t leds5[]  = {23, 22, 21, 16, 13, 12, 11, 8, 1, 2, 3};
-static const uint8_t leds6[]  = {23, 22, 21, 16, 13, 12, 11, 6, 8, 1, 2, 3};
-static const uint8_t leds7[]  = {23, 22, 21, 18, 11, 8, 1};
-static const uint8_t leds8[]  = {23, 22, 21, 16, 18, 13, 12, 11, 6, 8, 1, 2, 3};
-static const uint8_t leds9[]  = {23, 22, 21, 16, 18, 13, 12, 11, 8, 1, 2, 3};
-static const uint8_t leds10[] = {24, 15, 14, 5, 4, 22, 21, 20, 24, 17, 19, 12, 10, 7, 9, 0, 1, 2};
-
-// Array com os padrões (r, g, b podem ser diferentes para cada dígito)
-static const DigitPattern digits[] = {
-    {leds0,  sizeof(leds0),  80, 0, 0},  // 0 vermelho
-    {leds1,  sizeof(leds1),  80, 0, 0},  // 1 vermelho
-    {leds2,  sizeof(leds2),  80, 0, 0},  // 2 vermelho
-    {leds3,  sizeof(leds3),  80, 0, 0},  // 3 vermelho
-    {leds4,  sizeof(leds4),  80, 0, 0},  // 4 vermelho
-    {leds5,  sizeof(leds5),  80, 0, 0},  // 5 vermelho
-    {leds6,  sizeof(leds6),   0, 80, 0}, // 6 verde
-    {leds7,  sizeof(leds7),   0, 80, 0}, // 7 verde
-    {leds8,  sizeof(leds8),   0, 80, 0}, // 8 verde
-    {leds9,  sizeof(leds9),   0, 80, 0}, // 9 verde
-    {leds10, sizeof(leds10),  0, 80, 0}  // 10 verde
-};
-
-void npWriteNumber(uint8_t number) {
-    if (number > 10) return; // evita valores inválidos
+  uint32_t status = save_and_disable_interrupts();
 
-    npClear();
-    const DigitPattern *d = &digits[number];
-
-    for (uint8_t i = 0; i < d->count; i++) {
-        npSetLED(d->leds[i], d->r, d->g, d->b);
-    }
-
-    npWrite();
-}
-
-void npWriteLeft(){
-  npClear();
-
-  npSetLED(22, 0, 0, 80);
-  npSetLED(16, 0, 0, 80);
-  npSetLED(17, 0, 0, 80);
-  npSetLED(14, 0, 0, 80);
-  npSetLED(13, 0, 0, 80);
-  npSetLED(12, 0, 0, 80);
-  npSetLED(11, 0, 0, 80);
-  npSetLED(10, 0, 0, 80);
-  npSetLED(6, 0, 0, 80);
-  npSetLED(7, 0, 0, 80);
-  npSetLED(2, 0, 0, 80);
-
-  npWrite();
-}
-
-void npWriteRigth(){
-  npClear();
-
-  npSetLED(22, 0, 0, 80);
-  npSetLED(18, 0, 0, 80);
-  npSetLED(17, 0, 0, 80);
-  npSetLED(14, 0, 0, 80);
-  npSetLED(13, 0, 0, 80);
-  npSetLED(12, 0, 0, 80);
-  npSetLED(11, 0, 0, 80);
-  npSetLED(10, 0, 0, 80);
-  npSetLED(8, 0, 0, 80);
-  npSetLED(7, 0, 0, 80);
-  npSetLED(2, 0, 0, 80);
-
-  npWrite();
-}
-
-void npWriteFace(){
-  npClear();
-
-  npSetLED(16, 0, 0, 80);
-  npSetLED(18, 0, 0, 80);
-  npSetLED(13, 0, 0, 80);
-  npSetLED(11, 0, 0, 80);
-  npSetLED(5, 0, 0, 80);
-  npSetLED(9, 0, 0, 80);
-  npSetLED(1, 0, 0, 80);
-  npSetLED(2, 0, 0, 80);
-  npSetLED(3, 0, 0, 80);
+  // A máquina tira os 24 bits de cima de cada palavra, deslocando para a
+  // esquerda: G, R e B saem nessa ordem e cada um com o MSB primeiro, como a
+  // fita lê
+  uint32_t *q = quadros[quadro_livre];
+  for (uint i = 0; i < LED_COUNT; ++i)
+    q[i] = (uint32_t)leds[i].G << 24 | (uint32_t)leds[i].R << 16 | (uint32_t)leds[i].B << 8;
 
-  npWrite();
+  if (ocupado)
+    pendente = true;
+  else
+    enviar_quadro(quadro_livre);
+  restore_interrupts(status);
 }
 
-void npWriteX(){
-  npClear();
-
-  npSetLED(24, 80, 0, 0);
-  npSetLED(20, 80, 0, 0);
-  npSetLED(16, 80, 0, 0);
-  npSetLED(18, 80, 0, 0);
-  npSetLED(12, 80, 0, 0);
-  npSetLED(8, 80, 0, 0);
-  npSetLED(6, 80, 0, 0);
-  npSetLED(4, 80, 0, 0);
-  npSetLED(0, 80, 0, 0);
-
-  npWrite();
+// Verdadeiro enquanto houver quadro no fio, no reset ou esperando a vez
+bool npBusy() {
+  return ocupado;
 }
-
-void npWriteV(){
-  npClear();
-
-  npSetLED(19, 0, 80, 0);
-  npSetLED(11, 0, 80, 0);
-  npSetLED(7, 0, 80, 0);
-  npSetLED(5, 0, 80, 0);
-  npSetLED(3, 0, 80, 0);
-
-  npWrite();
-}
\ No newline at end of file
@@ -0,0 +1,141 @@
+// microfone/codec_audio.c
+
+#include "codec_audio.h"
+#include "pico/stdlib.h"
+
+// Tabelas padrão do IMA-ADPCM (DVI)
+static const int16_t adpcm_step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t adpcm_index_table[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+// Expoente do mu-law indexado pelos 8 bits mais altos da magnitude (com bias)
+static const uint8_t mulaw_exp_table[256] = {
+    0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7
+};
+
+#define MULAW_BIAS 0x84
+#define MULAW_CLIP 32635
+
+static codec_audio_t codec = CODEC_PCM8;
+static int32_t adpcm_predito = 0;
+static int32_t adpcm_indice = 0;
+static log_mel_t log_mel;
+
+// Amostra de 12 bits sem sinal (meio da escala = silêncio) para 16 bits com sinal
+static inline int32_t adc_para_s16(uint16_t raw) {
+  return ((int32_t)raw - 2048) << 4;
+}
+
+static inline uint8_t mulaw_encode(int32_t s) {
+  // Sinal e magnitude sem desvio: m = 0 ou -1
+  int32_t m = s >> 31;
+  int32_t mag = (s ^ m) - m;
+  mag = (mag > MULAW_CLIP ? MULAW_CLIP : mag) + MULAW_BIAS;
+
+  uint32_t exp = mulaw_exp_table[(mag >> 7) & 0xFF];
+  uint32_t mant = (mag >> (exp + 3)) & 0x0F;
+  return ~((m & 0x80) | (exp << 4) | mant);
+}
+
+static inline uint8_t adpcm_encode(int32_t s) {
+  int32_t step = adpcm_step_table[adpcm_indice];
+  int32_t diff = s - adpcm_predito;
+
+  int32_t m = diff >> 31;
+  uint32_t code = m & 8;
+  diff = (diff ^ m) - m;
+
+  // Aproximação sucessiva em 3 bits usando máscaras em vez de desvios;
+  // vpdiff reproduz exatamente o que o decodificador vai reconstruir
+  int32_t vpdiff = step >> 3;
+  int32_t k;
+
+  k = -(diff >= step);
+  code |= 4 & k; diff -= step & k; vpdiff += step & k;
+  step >>= 1;
+  k = -(diff >= step);
+  code |= 2 & k; diff -= step & k; vpdiff += step & k;
+  step >>= 1;
+  k = -(diff >= step);
+  code |= 1 & k; vpdiff += step & k;
+
+  adpcm_predito += (vpdiff ^ m) - m;
+  if (adpcm_predito > 32767) adpcm_predito = 32767;
+  else if (adpcm_predito < -32768) adpcm_predito = -32768;
+
+  adpcm_indice += adpcm_index_table[code];
+  if (adpcm_indice < 0) adpcm_indice = 0;
+  else if (adpcm_indice > 88) adpcm_indice = 88;
+
+  return code;
+}
+
+void codec_reset(codec_audio_t novo) {
+  codec = novo;
+  adpcm_predito = 0;
+  adpcm_indice = 0;
+  log_mel_reset(&log_mel);
+}
+
+codec_audio_t codec_atual(void) {
+  return codec;
+}
+
+uint codec_encode_block(const uint16_t *amostras, uint n, uint8_t *saida) {
+  switch (codec) {
+    case CODEC_MULAW:
+      for (uint i = 0; i < n; i++)
+        saida[i] = mulaw_encode(adc_para_s16(amostras[i]));
+      return n;
+
+    case CODEC_IMA_ADPCM: {
+      saida[0] = adpcm_predito & 0xFF;
+      saida[1] = (adpcm_predito >> 8) & 0xFF;
+      saida[2] = adpcm_indice;
+      uint8_t *p = saida + CODEC_ADPCM_HEADER_LEN;
+
+      // Duas amostras por byte, a primeira no nibble baixo (ordem do IMA/DVI);
+      // n é par, então nenhum nibble é enchimento
+      for (uint i = 0; i + 1 < n; i += 2)
+        *p++ = adpcm_encode(adc_para_s16(amostras[i])) | (adpcm_encode(adc_para_s16(amostras[i + 1])) << 4);
+      return p - saida;
+    }
+
+    case CODEC_LOG_MEL:
+      return log_mel_processar(&log_mel, amostras, n, saida) * LOG_MEL_BANDAS;
+
+    case CODEC_PCM8:
+    default:
+      for (uint i = 0; i < n; i++)
+        saida[i] = amostras[i] >> 4; // 12 bits → 8 bits
+      return n;
+  }
+}
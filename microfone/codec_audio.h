@@ -0,0 +1,34 @@
+// microfone/codec_audio.h
+
+#ifndef CODEC_AUDIO_H
+#define CODEC_AUDIO_H
+
+#include "pico/stdlib.h"
+#include "log_mel.h"
+
+// Os valores coincidem com o formato anunciado no quadro PROTO_INICIO
+typedef enum {
+    CODEC_PCM8      = 0,  // 8 bits sem sinal (12 bits truncados), 8 kB/s
+    CODEC_MULAW     = 1,  // G.711 mu-law, ~14 bits de faixa dinâmica em 8 bits
+    CODEC_IMA_ADPCM = 2,  // IMA-ADPCM, 4 bits/amostra, 4 kB/s
+    CODEC_LOG_MEL   = 3,  // sem áudio: só características log-mel (log_mel.h), 1,25 kB/s
+} codec_audio_t;
+
+// Cabeçalho de cada bloco ADPCM: preditor (int16 LE) + índice do passo (u8)
+#define CODEC_ADPCM_HEADER_LEN 3
+
+// Tamanho máximo da saída codificada para n amostras (uma amostra pode
+// completar um quadro log-mel)
+#define CODEC_MAX_BYTES(n) ((n) + CODEC_ADPCM_HEADER_LEN + LOG_MEL_BANDAS)
+
+void codec_reset(codec_audio_t codec);
+
+// Codifica n amostras de 12 bits do ADC em saida; retorna o número de bytes escritos.
+// Cada bloco ADPCM carrega o estado do preditor, então pode ser decodificado sozinho;
+// n tem que ser par (a última amostra de um n ímpar fica de fora).
+// No log-mel, só os quadros completados (0 bytes se nenhum: a janela continua no próximo).
+uint codec_encode_block(const uint16_t *amostras, uint n, uint8_t *saida);
+
+codec_audio_t codec_atual(void);
+
+#endif
@@ -0,0 +1,104 @@
+// microfone/fft_fixo.c
+
+#include "fft_fixo.h"
+#include "pico/stdlib.h"
+
+// cos(2πk/256) em Q15 (1.0 saturado em 32767); sen(θ) = cos(θ - π/2)
+static const int16_t cosseno[FFT_FIXO_N] = {
+     32767,  32758,  32729,  32679,  32610,  32522,  32413,  32286,
+     32138,  31972,  31786,  31581,  31357,  31114,  30853,  30572,
+     30274,  29957,  29622,  29269,  28899,  28511,  28106,  27684,
+     27246,  26791,  26320,  25833,  25330,  24812,  24279,  23732,
+     23170,  22595,  22006,  21403,  20788,  20160,  19520,  18868,
+     18205,  17531,  16846,  16151,  15447,  14733,  14010,  13279,
+     12540,  11793,  11039,  10279,   9512,   8740,   7962,   7180,
+      6393,   5602,   4808,   4011,   3212,   2411,   1608,    804,
+         0,   -804,  -1608,  -2411,  -3212,  -4011,  -4808,  -5602,
+     -6393,  -7180,  -7962,  -8740,  -9512, -10279, -11039, -11793,
+    -12540, -13279, -14010, -14733, -15447, -16151, -16846, -17531,
+    -18205, -18868, -19520, -20160, -20788, -21403, -22006, -22595,
+    -23170, -23732, -24279, -24812, -25330, -25833, -26320, -26791,
+    -27246, -27684, -28106, -28511, -28899, -29269, -29622, -29957,
+    -30274, -30572, -30853, -31114, -31357, -31581, -31786, -31972,
+    -32138, -32286, -32413, -32522, -32610, -32679, -32729, -32758,
+    -32768, -32758, -32729, -32679, -32610, -32522, -32413, -32286,
+    -32138, -31972, -31786, -31581, -31357, -31114, -30853, -30572,
+    -30274, -29957, -29622, -29269, -28899, -28511, -28106, -27684,
+    -27246, -26791, -26320, -25833, -25330, -24812, -24279, -23732,
+    -23170, -22595, -22006, -21403, -20788, -20160, -19520, -18868,
+    -18205, -17531, -16846, -16151, -15447, -14733, -14010, -13279,
+    -12540, -11793, -11039, -10279,  -9512,  -8740,  -7962,  -7180,
+     -6393,  -5602,  -4808,  -4011,  -3212,  -2411,  -1608,   -804,
+         0,    804,   1608,   2411,   3212,   4011,   4808,   5602,
+      6393,   7180,   7962,   8740,   9512,  10279,  11039,  11793,
+     12540,  13279,  14010,  14733,  15447,  16151,  16846,  17531,
+     18205,  18868,  19520,  20160,  20788,  21403,  22006,  22595,
+     23170,  23732,  24279,  24812,  25330,  25833,  26320,  26791,
+     27246,  27684,  28106,  28511,  28899,  29269,  29622,  29957,
+     30274,  30572,  30853,  31114,  31357,  31581,  31786,  31972,
+     32138,  32286,  32413,  32522,  32610,  32679,  32729,  32758,
+};
+
+// Giro W^e = cos - j·sen aplicado a (xr + j·xi), com arredondamento
+#define GIRAR(xr, xi, c, s, yr, yi)                        \
+  do {                                                     \
+    yr = ((xr) * (c) + (xi) * (s) + (1 << 14)) >> 15;      \
+    yi = ((xi) * (c) - (xr) * (s) + (1 << 14)) >> 15;      \
+  } while (0)
+
+/**
+ * Dizimação na frequência: a borboleta de cada estágio combina os quatro
+ * quartos do grupo e gira três das saídas; ao fim os índices ficam com os
+ * dígitos de base 4 invertidos, o que a troca final desfaz. A soma dos quatro
+ * termos cabe em 18 bits e sai dividida por 4, então nada estoura.
+ */
+void __not_in_flash_func(fft_fixo)(int16_t *re, int16_t *im) {
+  for (uint grupo = FFT_FIXO_N; grupo >= 4; grupo >>= 2) {
+    uint q = grupo >> 2;
+    uint passo = FFT_FIXO_N / grupo;
+    for (uint j = 0; j < q; j++) {
+      uint e1 = j * passo, e2 = 2 * e1, e3 = 3 * e1;  // 3·e1 < 3N/4: sem volta
+      int32_t c1 = cosseno[e1], s1 = cosseno[(e1 - FFT_FIXO_N / 4) & (FFT_FIXO_N - 1)];
+      int32_t c2 = cosseno[e2], s2 = cosseno[(e2 - FFT_FIXO_N / 4) & (FFT_FIXO_N - 1)];
+      int32_t c3 = cosseno[e3], s3 = cosseno[(e3 - FFT_FIXO_N / 4) & (FFT_FIXO_N - 1)];
+      for (uint k = j; k < FFT_FIXO_N; k += grupo) {
+        int16_t *r = re + k, *i = im + k;
+        int32_t t0r = r[0] + r[2 * q], t0i = i[0] + i[2 * q];
+        int32_t t1r = r[0] - r[2 * q], t1i = i[0] - i[2 * q];
+        int32_t t2r = r[q] + r[3 * q], t2i = i[q] + i[3 * q];
+        int32_t t3r = r[q] - r[3 * q], t3i = i[q] - i[3 * q];
+        int32_t xr, xi, yr, yi;
+
+        r[0] = (t0r + t2r) >> 2;
+        i[0] = (t0i + t2i) >> 2;
+        xr = (t1r + t3i) >> 2;  // (a - jb - c + jd) W^e1
+        xi = (t1i - t3r) >> 2;
+        GIRAR(xr, xi, c1, s1, yr, yi);
+        r[q] = yr;
+        i[q] = yi;
+        xr = (t0r - t2r) >> 2;  // (a - b + c - d) W^e2
+        xi = (t0i - t2i) >> 2;
+        GIRAR(xr, xi, c2, s2, yr, yi);
+        r[2 * q] = yr;
+        i[2 * q] = yi;
+        xr = (t1r - t3i) >> 2;  // (a + jb - c - jd) W^e3
+        xi = (t1i + t3r) >> 2;
+        GIRAR(xr, xi, c3, s3, yr, yi);
+        r[3 * q] = yr;
+        i[3 * q] = yi;
+      }
+    }
+  }
+
+  // 4 dígitos de base 4 (8 bits) em ordem inversa
+  for (uint k = 0; k < FFT_FIXO_N; k++) {
+    uint r = (k & 0x03) << 6 | (k & 0x0C) << 2 | (k & 0x30) >> 2 | (k & 0xC0) >> 6;
+    if (r > k) {
+      int16_t a = re[k], b = im[k];
+      re[k] = re[r];
+      im[k] = im[r];
+      re[r] = a;
+      im[r] = b;
+    }
+  }
+}
@@ -0,0 +1,25 @@
+// microfone/fft_fixo.h
+
+#ifndef FFT_FIXO_H
+#define FFT_FIXO_H
+
+#include "pico/stdlib.h"
+
+/*
+ * FFT complexa de 256 pontos em ponto fixo (Q15), radix-4: 4 estágios de
+ * 64 borboletas em vez de 8 estágios de radix-2. No M0+ a multiplicação de
+ * 32 bits é de um ciclo e o que pesa são os loads e stores: cada amostra
+ * passa pela memória metade das vezes (e há 25% menos giros). Tabelas na
+ * flash, laço na RAM.
+ */
+
+#define FFT_FIXO_N 256
+
+/**
+ * Transformada direta no lugar, real e imaginário em vetores separados, saída
+ * em ordem natural. Cada estágio divide por 4 (sem estouro para qualquer
+ * entrada int16), então a saída é a DFT dividida por FFT_FIXO_N.
+ */
+void fft_fixo(int16_t *re, int16_t *im);
+
+#endif
@@ -0,0 +1,144 @@
+// microfone/log_mel.c
+
+#include "log_mel.h"
+#include <string.h>
+#include "pico/stdlib.h"
+
+#define BINS (FFT_FIXO_N / 2 + 1)
+#define FORA 0xFF                  // bin fora de todos os filtros
+#define PRE_ENFASE_Q15 31785       // 0,97
+#define PISO_LOG2_Q3 (8 * 8)       // 8 oitavas: abaixo disso é o chiado do ADC
+
+// Metade de uma janela de Hamming de 256 pontos (simétrica), Q15
+static const int16_t hamming[LOG_MEL_JANELA / 2] = {
+      2621,   2626,   2640,   2663,   2695,   2736,   2786,   2845,
+      2913,   2990,   3077,   3172,   3275,   3388,   3509,   3639,
+      3778,   3924,   4080,   4243,   4415,   4595,   4782,   4978,
+      5181,   5392,   5610,   5836,   6069,   6308,   6555,   6809,
+      7069,   7336,   7608,   7888,   8173,   8463,   8760,   9061,
+      9368,   9681,   9998,  10319,  10645,  10976,  11310,  11648,
+     11990,  12336,  12685,  13036,  13391,  13748,  14108,  14470,
+     14833,  15199,  15566,  15934,  16303,  16674,  17044,  17416,
+     17787,  18158,  18529,  18900,  19270,  19639,  20006,  20372,
+     20737,  21100,  21461,  21819,  22175,  22528,  22878,  23226,
+     23569,  23910,  24246,  24578,  24907,  25231,  25550,  25864,
+     26174,  26478,  26778,  27071,  27359,  27641,  27917,  28187,
+     28450,  28707,  28957,  29201,  29437,  29666,  29888,  30103,
+     30310,  30509,  30701,  30885,  31060,  31228,  31387,  31538,
+     31681,  31815,  31941,  32058,  32166,  32265,  32356,  32438,
+     32510,  32574,  32629,  32674,  32711,  32738,  32757,  32766,
+};
+
+/*
+ * Filtros mel: o bin k está na subida do filtro banda[k] (peso[k]/256) e na
+ * descida do anterior (1 - peso[k]/256). Bordas em 100 Hz · ... · 4 kHz,
+ * igualmente espaçadas em mel = 2595·log10(1 + f/700), 31,25 Hz por bin.
+ */
+static const uint8_t banda[BINS] = {
+    255, 255, 255, 255,   0,   0,   1,   1,   2,   2,   2,   3,   3,   3,   4,   4,
+      4,   5,   5,   5,   5,   6,   6,   6,   7,   7,   7,   7,   8,   8,   8,   8,
+      8,   9,   9,   9,   9,   9,  10,  10,  10,  10,  10,  11,  11,  11,  11,  11,
+     11,  12,  12,  12,  12,  12,  12,  13,  13,  13,  13,  13,  13,  14,  14,  14,
+     14,  14,  14,  14,  14,  15,  15,  15,  15,  15,  15,  15,  15,  16,  16,  16,
+     16,  16,  16,  16,  16,  17,  17,  17,  17,  17,  17,  17,  17,  17,  17,  18,
+     18,  18,  18,  18,  18,  18,  18,  18,  18,  19,  19,  19,  19,  19,  19,  19,
+     19,  19,  19,  19,  20,  20,  20,  20,  20,  20,  20,  20,  20,  20,  20,  20,
+    255,
+};
+
+static const uint8_t peso[BINS] = {
+      0,   0,   0,   0,  90, 204,  57, 161,   9, 105, 201,  38, 126, 214,  43, 124,
+    205,  28, 102, 177, 251,  64, 133, 201,  13,  76, 139, 202,   8,  66, 124, 181,
+    239,  38,  91, 144, 198, 251,  44,  93, 142, 191, 240,  30,  75, 120, 165, 210,
+    255,  40,  81, 123, 164, 205, 247,  29,  67, 105, 143, 181, 219,   1,  36,  71,
+    106, 141, 176, 211, 246,  22,  55,  87, 119, 151, 183, 215, 247,  21,  51,  80,
+    110, 139, 169, 198, 228,   1,  28,  55,  82, 110, 137, 164, 191, 218, 245,  15,
+     40,  65,  90, 114, 139, 164, 189, 214, 239,   7,  30,  53,  76,  99, 122, 145,
+    168, 190, 213, 236,   3,  24,  45,  66,  87, 108, 129, 150, 171, 192, 213, 234,
+      0,
+};
+
+// 8·log2(1 + (i + 0,5)/32): a parte fracionária do log2 a partir de 5 bits da mantissa
+static const uint8_t log2_frac_q3[32] = {
+    0, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 4, 4, 4, 4, 5,
+    5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7, 7, 8, 8, 8,
+};
+
+static int16_t re[FFT_FIXO_N], im[FFT_FIXO_N];  // um extrator por vez (core1)
+
+static inline uint32_t log2_q3(uint64_t x) {
+  if (x == 0)
+    return 0;
+  uint p = 63 - __builtin_clzll(x);
+  uint f = (uint)(p >= 5 ? x >> (p - 5) : x << (5 - p)) & 31;
+  return p * 8 + log2_frac_q3[f];
+}
+
+/**
+ * Um quadro: sem o DC, com ponto flutuante em bloco (a janela é deslocada até
+ * o maior valor encostar em 15 bits, e o deslocamento volta no log), para o
+ * silêncio não se perder no arredondamento da FFT.
+ */
+static void __not_in_flash_func(calcular_quadro)(const int16_t *x, uint8_t *saida) {
+  int32_t soma = 0;
+  for (uint i = 0; i < LOG_MEL_JANELA; i++)
+    soma += x[i];
+  int32_t media = soma / LOG_MEL_JANELA;
+
+  int32_t anterior = x[0] - media, maior = 0;
+  for (uint i = 0; i < LOG_MEL_JANELA; i++) {
+    int32_t v = x[i] - media;
+    int32_t y = v - ((PRE_ENFASE_Q15 * anterior) >> 15);
+    anterior = v;
+    re[i] = (int16_t)(y > INT16_MAX ? INT16_MAX : y < INT16_MIN ? INT16_MIN : y);
+    int32_t a = y < 0 ? -y : y;
+    if (a > maior)
+      maior = a;
+  }
+  uint escala = 0;
+  while (escala < 15 && (maior << (escala + 1)) <= INT16_MAX)
+    escala++;
+  for (uint i = 0; i < LOG_MEL_JANELA; i++) {
+    int32_t w = hamming[i < LOG_MEL_JANELA / 2 ? i : LOG_MEL_JANELA - 1 - i];
+    re[i] = (int16_t)((((int32_t)re[i] << escala) * w) >> 15);
+    im[i] = 0;
+  }
+
+  fft_fixo(re, im);
+
+  uint64_t energia[LOG_MEL_BANDAS] = {0};
+  for (uint k = 0; k < BINS; k++) {
+    uint b = banda[k];
+    if (b == FORA)
+      continue;
+    uint32_t p = (uint32_t)(re[k] * re[k]) + (uint32_t)(im[k] * im[k]);
+    if (b < LOG_MEL_BANDAS)
+      energia[b] += (uint64_t)p * peso[k];
+    if (b > 0)
+      energia[b - 1] += (uint64_t)p * (256 - peso[k]);
+  }
+
+  // Potência em LSB² do ADC: entrada com 4 bits a mais (12 → 16) e "escala",
+  // FFT dividida por 256 e pesos em Q8: log2 = log2(energia) - 2·escala
+  for (uint b = 0; b < LOG_MEL_BANDAS; b++) {
+    int32_t v = (int32_t)log2_q3(energia[b]) - 16 * (int32_t)escala - PISO_LOG2_Q3;
+    saida[b] = (uint8_t)(v < 0 ? 0 : v > 255 ? 255 : v);
+  }
+}
+
+void log_mel_reset(log_mel_t *m) {
+  m->cheias = 0;
+}
+
+uint log_mel_processar(log_mel_t *m, const uint16_t *amostras, uint n, uint8_t *saida) {
+  uint quadros = 0;
+  for (uint i = 0; i < n; i++) {
+    m->amostras[m->cheias++] = (int16_t)(((int32_t)amostras[i] - 2048) << 4);
+    if (m->cheias == LOG_MEL_JANELA) {
+      calcular_quadro(m->amostras, saida + quadros++ * LOG_MEL_BANDAS);
+      memmove(m->amostras, m->amostras + LOG_MEL_PASSO, (LOG_MEL_JANELA - LOG_MEL_PASSO) * sizeof(int16_t));
+      m->cheias = LOG_MEL_JANELA - LOG_MEL_PASSO;
+    }
+  }
+  return quadros;
+}
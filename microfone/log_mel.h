@@ -0,0 +1,37 @@
+// microfone/log_mel.h
+
+#ifndef LOG_MEL_H
+#define LOG_MEL_H
+
+#include "pico/stdlib.h"
+#include "fft_fixo.h"
+
+/*
+ * Características log-mel em ponto fixo, calculadas na Pico para só elas
+ * irem pela USB (codec CODEC_LOG_MEL). Janelas de 32 ms com passo de 16 ms
+ * a 8 kHz, pré-ênfase, Hamming, FFT radix-4 (fft_fixo.h) e 20 filtros
+ * triangulares na escala mel entre 100 Hz e 4 kHz. Cada banda vira um byte:
+ * 8·log2 da energia em LSB² do ADC, menos 64 (1 passo = 0,38 dB; 0 = piso).
+ * 20 bytes a cada 16 ms são 1,25 kB/s, contra 4 kB/s do ADPCM e 16 kB/s do
+ * PCM de 16 bits que o host reconstrói.
+ *
+ * O mesmo código roda no host (ferramentas/, contra os headers de sim/include)
+ * para os modelos de letras saírem das mesmas características.
+ */
+
+#define LOG_MEL_JANELA FFT_FIXO_N  // 32 ms a 8 kHz
+#define LOG_MEL_PASSO  128         // 16 ms
+#define LOG_MEL_BANDAS 20
+
+typedef struct {
+    int16_t amostras[LOG_MEL_JANELA];  // janela em formação, já em 16 bits com sinal
+    uint cheias;
+} log_mel_t;
+
+void log_mel_reset(log_mel_t *m);
+
+// Consome n amostras de 12 bits do ADC e escreve LOG_MEL_BANDAS bytes em
+// saida para cada quadro completado; retorna quantos quadros escreveu
+uint log_mel_processar(log_mel_t *m, const uint16_t *amostras, uint n, uint8_t *saida);
+
+#endif
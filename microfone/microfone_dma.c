@@ -0,0 +1,163 @@
+// microfone/microfone_dma.c
+
+#include "microfone_dma.h"
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "rastreio/rastreio.h"
+
+// Dois buffers em ping-pong: enquanto o DMA enche um, o outro pode ser lido.
+// O bloco de número n sempre fica em mic_buf[n & 1].
+static uint16_t mic_buf[2][MIC_BLOCK_SAMPLES] __attribute__((aligned(4)));
+
+static uint dma_chan[2];
+static uint adc_input;
+
+static volatile uint32_t blocos_cheios = 0; // incrementado pela IRQ do DMA
+static volatile bool rodando = false;
+static uint32_t blocos_lidos = 0;
+static uint32_t blocos_perdidos = 0;
+static uint amostras_parciais = 0;          // bloco incompleto deixado pelo mic_stop()
+static volatile uint32_t t_bloco_us[2];     // quando cada buffer terminou de encher
+static uint32_t t_parada_us;
+static uint32_t t_lido_us;                  // instante do último bloco devolvido
+
+/**
+ * IRQ de fim de bloco: re-arma o canal que terminou (o outro já foi disparado
+ * pelo chain_to) e avisa o consumidor. É a única interrupção por bloco.
+ */
+static void mic_dma_irq_handler(void) {
+  for (uint i = 0; i < 2; i++) {
+    if (dma_channel_get_irq1_status(dma_chan[i])) {
+      dma_channel_acknowledge_irq1(dma_chan[i]);
+      dma_channel_set_write_addr(dma_chan[i], mic_buf[i], false);
+      t_bloco_us[i] = time_us_32();
+      blocos_cheios++;
+      rastreio_instante(RT_BLOCO_ADC, (uint16_t)blocos_cheios);
+    }
+  }
+}
+
+/**
+ * Inicializa ADC + DMA. O relógio de amostragem vem do divisor do ADC,
+ * então o período entre amostras é exato e independe da CPU.
+ */
+void mic_init(uint gpio, uint sample_rate_hz) {
+  adc_init();
+  adc_gpio_init(gpio);
+  adc_input = gpio - 26; // GPIO26..29 = ADC0..3
+  adc_select_input(adc_input);
+  adc_set_round_robin(1u << adc_input);
+
+  // FIFO ligada, DREQ a cada amostra, sem bit de erro e sem reduzir para 8 bits
+  adc_fifo_setup(true, true, 1, false, false);
+
+  // Cada conversão leva (1 + div) ciclos do clock de 48 MHz do ADC
+  adc_set_clkdiv(48000000.f / sample_rate_hz - 1.f);
+
+  dma_chan[0] = dma_claim_unused_channel(true);
+  dma_chan[1] = dma_claim_unused_channel(true);
+
+  for (uint i = 0; i < 2; i++) {
+    dma_channel_config c = dma_channel_get_default_config(dma_chan[i]);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, DREQ_ADC);
+    channel_config_set_chain_to(&c, dma_chan[i ^ 1]);
+
+    dma_channel_configure(dma_chan[i], &c, mic_buf[i], &adc_hw->fifo, MIC_BLOCK_SAMPLES, false);
+    dma_channel_set_irq1_enabled(dma_chan[i], true);
+  }
+
+  irq_add_shared_handler(DMA_IRQ_1, mic_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(DMA_IRQ_1, true);
+}
+
+void mic_start(void) {
+  if (rodando) return;
+
+  adc_run(false);
+  adc_fifo_drain();
+
+  blocos_cheios = 0;
+  blocos_lidos = 0;
+  blocos_perdidos = 0;
+  amostras_parciais = 0;
+
+  dma_channel_set_write_addr(dma_chan[1], mic_buf[1], false);
+  dma_channel_set_trans_count(dma_chan[1], MIC_BLOCK_SAMPLES, false);
+  dma_channel_set_write_addr(dma_chan[0], mic_buf[0], false);
+  dma_channel_set_trans_count(dma_chan[0], MIC_BLOCK_SAMPLES, true); // dispara o canal A
+
+  rodando = true;
+  adc_run(true);
+}
+
+void mic_stop(void) {
+  if (!rodando) return;
+
+  adc_run(false);
+  t_parada_us = time_us_32();
+  // Deixa o DMA esvaziar a FIFO; uma IRQ de bloco pendente é atendida aqui mesmo
+  while (!adc_fifo_is_empty())
+    tight_loop_contents();
+
+  uint ativo = blocos_cheios & 1;
+  amostras_parciais = MIC_BLOCK_SAMPLES - dma_channel_hw_addr(dma_chan[ativo])->transfer_count;
+
+  // Abortar com a IRQ habilitada pode gerar uma IRQ espúria (errata RP2040-E13)
+  for (uint i = 0; i < 2; i++) {
+    dma_channel_set_irq1_enabled(dma_chan[i], false);
+    dma_channel_abort(dma_chan[i]);
+    dma_channel_acknowledge_irq1(dma_chan[i]);
+    dma_channel_set_irq1_enabled(dma_chan[i], true);
+  }
+
+  adc_fifo_drain();
+  rodando = false;
+}
+
+bool mic_is_running(void) {
+  return rodando;
+}
+
+uint mic_read_block(uint16_t *dst) {
+  uint32_t cheios = blocos_cheios;
+
+  // Com só dois buffers, atrasar dois blocos significa que o mais antigo já foi sobrescrito
+  if (cheios - blocos_lidos > 1) {
+    blocos_perdidos += cheios - blocos_lidos - 1;
+    blocos_lidos = cheios - 1;
+  }
+
+  if (blocos_lidos != cheios) {
+    const uint16_t *src = mic_buf[blocos_lidos & 1];
+    for (uint i = 0; i < MIC_BLOCK_SAMPLES; i++)
+      dst[i] = src[i];
+    t_lido_us = t_bloco_us[blocos_lidos & 1];
+    blocos_lidos++;
+    return MIC_BLOCK_SAMPLES;
+  }
+
+  if (!rodando && amostras_parciais > 0) {
+    uint n = amostras_parciais;
+    const uint16_t *src = mic_buf[cheios & 1];
+    for (uint i = 0; i < n; i++)
+      dst[i] = src[i];
+    amostras_parciais = 0;
+    t_lido_us = t_parada_us;
+    return n;
+  }
+
+  return 0;
+}
+
+uint32_t mic_block_time_us(void) {
+  return t_lido_us;
+}
+
+uint32_t mic_dropped_blocks(void) {
+  return blocos_perdidos;
+}
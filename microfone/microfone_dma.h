@@ -0,0 +1,30 @@
+// microfone/microfone_dma.h
+
+#ifndef MICROFONE_DMA_H
+#define MICROFONE_DMA_H
+
+#include "pico/stdlib.h"
+
+// Amostras por bloco de DMA (256 amostras = 32 ms a 8 kHz)
+#define MIC_BLOCK_SAMPLES 256
+
+// Configura o ADC em modo livre (round-robin) e os dois canais de DMA em ping-pong
+void mic_init(uint gpio, uint sample_rate_hz);
+
+// Liga/desliga a captura. Ao parar, o bloco parcial fica disponível para leitura.
+void mic_start(void);
+void mic_stop(void);
+bool mic_is_running(void);
+
+// Copia o próximo bloco pronto (amostras de 12 bits) para dst.
+// Retorna o número de amostras copiadas, ou 0 se não há bloco pronto.
+uint mic_read_block(uint16_t *dst);
+
+// Instante (time_us_32) em que a última amostra do bloco devolvido por
+// mic_read_block() foi convertida; serve para medir a latência até a USB
+uint32_t mic_block_time_us(void);
+
+// Blocos perdidos porque o consumidor não os leu a tempo
+uint32_t mic_dropped_blocks(void);
+
+#endif
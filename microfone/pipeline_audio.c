@@ -0,0 +1,305 @@
+// microfone/pipeline_audio.c
+
+#include "pipeline_audio.h"
+#include "microfone_dma.h"
+#include "vad.h"
+#include "comunicacao/anel_spsc.h"
+#include "comunicacao/protocolo_serial.h"
+#include "rastreio/rastreio.h"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+
+// Mensagens de controle pela FIFO entre os cores
+#define CMD_PRONTO  0x01u  // core1 → core0: ADC/DMA inicializados
+#define CMD_INICIAR 0x02u  // core0 → core1: bits 8..15 = codec
+#define CMD_PARAR   0x03u  // core0 → core1
+#define CMD_FIM_VAD 0x04u  // core1 → core0: o VAD encerrou a captura sozinho
+
+// Blocos crus guardados antes do início da fala (pre-roll)
+#define PRE_ROLL_MAX_BLOCOS 4
+
+// Um slot da fila: um quadro já codificado, pronto para o protocolo serial
+typedef struct {
+    uint8_t tipo;           // PROTO_INICIO, PROTO_AUDIO, PROTO_MEL, PROTO_VAD ou PROTO_FIM
+    uint16_t len;
+    uint32_t arg0, arg1;    // INICIO: taxa, formato; FIM: total de amostras, blocos perdidos;
+                            // AUDIO/MEL: arg0 = instante da captura (mic_block_time_us)
+    uint8_t dados[CODEC_MAX_BYTES(MIC_BLOCK_SAMPLES)];
+} slot_audio_t;
+
+static slot_audio_t slots[AUDIO_PIPELINE_SLOTS];
+static anel_spsc_t fila;
+
+static uint mic_gpio;
+static uint taxa_hz;
+
+// Estado do core0
+static volatile bool parada_pendente = false;  // limpo pelo core1 ao publicar o FIM
+static bool capturando = false;
+static vad_config_t vad_cfg;                   // lido pelo core1 depois do CMD_INICIAR
+static bool vad_cfg_ativo;
+static uint32_t latencias[AUDIO_PIPELINE_LATENCIAS];  // ADC→USB em us, anel dos mais recentes
+static uint32_t latencias_total;
+static volatile uint16_t nivel;  // pico a pico do último bloco, para o VU da matriz
+
+// Estado do core1
+static uint16_t bloco[MIC_BLOCK_SAMPLES];
+static uint32_t total_amostras;
+static uint32_t descartados;  // blocos perdidos por fila cheia (core0 atrasado)
+static vad_t vad;
+static bool vad_ativo;
+static uint16_t pre_roll[PRE_ROLL_MAX_BLOCOS][MIC_BLOCK_SAMPLES];
+static uint16_t pre_roll_n[PRE_ROLL_MAX_BLOCOS];
+static uint32_t pre_roll_t[PRE_ROLL_MAX_BLOCOS];
+static uint32_t pre_roll_blocos;  // quantos blocos de silêncio já passaram pelo pre-roll
+static uint32_t pre_roll_max;
+
+/**
+ * Publica um quadro de controle, esperando espaço na fila se necessário.
+ * Só INICIO e FIM passam por aqui, então nunca se perdem.
+ */
+static void publicar_controle(uint8_t tipo, uint32_t arg0, uint32_t arg1) {
+  slot_audio_t *s;
+  while ((s = anel_spsc_reservar(&fila)) == NULL)
+    __wfe();
+  s->tipo = tipo;
+  s->len = 0;
+  s->arg0 = arg0;
+  s->arg1 = arg1;
+  anel_spsc_publicar(&fila);
+}
+
+// Core1: codifica direto no slot da fila; se a fila estiver cheia o bloco é descartado.
+// No log-mel o bloco vira quadros de características (PROTO_MEL), não áudio.
+static void publicar_audio(const uint16_t *amostras, uint n, uint32_t t_us) {
+  slot_audio_t *s = anel_spsc_reservar(&fila);
+  if (s == NULL) {
+    descartados++;
+    rastreio_cont.slots_descartados++;
+    return;
+  }
+  s->tipo = codec_atual() == CODEC_LOG_MEL ? PROTO_MEL : PROTO_AUDIO;
+  s->arg0 = t_us;
+  // ADPCM só em blocos pares: o quadro não diz quantas amostras tem, e um
+  // nibble de enchimento viraria amostra no host. Só o bloco parcial do fim
+  // pode ser ímpar, e perde a última amostra.
+  if (codec_atual() == CODEC_IMA_ADPCM)
+    n &= ~1u;
+  rastreio_inicio(RT_CODEC, n);
+  s->len = codec_encode_block(amostras, n, s->dados);
+  rastreio_fim(RT_CODEC, n);
+  total_amostras += n;
+  if (s->len > 0) // sem quadro completo o slot fica reservado para o próximo bloco
+    anel_spsc_publicar(&fila);
+}
+
+// Core1: decisão do VAD no fluxo: evento (u8), bloco (u32), energia (u32), piso (u32)
+static void publicar_vad(vad_evento_t ev) {
+  slot_audio_t *s;
+  while ((s = anel_spsc_reservar(&fila)) == NULL)
+    __wfe();
+  uint32_t campos[3] = {vad.blocos, vad.energia, vad.piso};
+  s->tipo = PROTO_VAD;
+  s->dados[0] = ev;
+  for (uint i = 0; i < 3; i++)
+    for (uint b = 0; b < 4; b++)
+      s->dados[1 + 4 * i + b] = campos[i] >> (8 * b);
+  s->len = 13;
+  anel_spsc_publicar(&fila);
+}
+
+static void encerrar_captura(void) {
+  mic_stop();
+  rastreio_cont.blocos_perdidos += mic_dropped_blocks();
+  nivel = 0;
+  publicar_controle(PROTO_FIM, total_amostras, mic_dropped_blocks() + descartados);
+  parada_pendente = false;
+}
+
+/**
+ * Core1: passa cada bloco pelo VAD. O silêncio inicial fica só no pre-roll;
+ * ao confirmar a fala, o pre-roll sai antes do bloco atual, e o fim da fala
+ * (ou a falta dela) encerra a captura sem esperar o botão.
+ */
+static void processar_bloco(const uint16_t *amostras, uint n, uint32_t t_us) {
+  uint16_t menor = 0xFFFF, maior = 0;
+  for (uint i = 0; i < n; i++) {
+    if (amostras[i] < menor) menor = amostras[i];
+    if (amostras[i] > maior) maior = amostras[i];
+  }
+  nivel = maior - menor;
+
+  if (!vad_ativo) {
+    publicar_audio(amostras, n, t_us);
+    return;
+  }
+
+  vad_evento_t ev = vad_processar(&vad, amostras, n, taxa_hz);
+  switch (ev) {
+    case VAD_SILENCIO: {
+      uint slot = pre_roll_blocos++ % PRE_ROLL_MAX_BLOCOS;
+      for (uint i = 0; i < n; i++)
+        pre_roll[slot][i] = amostras[i];
+      pre_roll_n[slot] = n;
+      pre_roll_t[slot] = t_us;
+      break;
+    }
+    case VAD_INICIO_FALA: {
+      publicar_vad(ev);
+      uint guardados = pre_roll_blocos < pre_roll_max ? pre_roll_blocos : pre_roll_max;
+      for (uint32_t b = pre_roll_blocos - guardados; b < pre_roll_blocos; b++) {
+        uint slot = b % PRE_ROLL_MAX_BLOCOS;
+        publicar_audio(pre_roll[slot], pre_roll_n[slot], pre_roll_t[slot]);
+      }
+      publicar_audio(amostras, n, t_us);
+      break;
+    }
+    case VAD_FALA:
+      publicar_audio(amostras, n, t_us);
+      break;
+    case VAD_FIM_FALA:
+    case VAD_SEM_FALA:
+      publicar_vad(ev);
+      if (ev == VAD_FIM_FALA)
+        publicar_audio(amostras, n, t_us);
+      encerrar_captura();
+      while (mic_read_block(bloco) > 0)
+        ; // descarta o bloco parcial
+      multicore_fifo_push_blocking(CMD_FIM_VAD);
+      break;
+  }
+}
+
+static void escoar_blocos(void) {
+  uint n;
+  while (mic_is_running() && (n = mic_read_block(bloco)) > 0)
+    processar_bloco(bloco, n, mic_block_time_us());
+}
+
+static void core1_main(void) {
+  // O handler de DMA do microfone fica registrado no NVIC do core1
+  mic_init(mic_gpio, taxa_hz);
+  multicore_fifo_push_blocking(CMD_PRONTO);
+
+  while (true) {
+    while (multicore_fifo_rvalid()) {
+      uint32_t cmd = multicore_fifo_pop_blocking();
+      switch (cmd & 0xFF) {
+        case CMD_INICIAR:
+          total_amostras = 0;
+          descartados = 0;
+          codec_reset((codec_audio_t)((cmd >> 8) & 0xFF));
+          vad_ativo = vad_cfg_ativo;
+          if (vad_ativo) {
+            vad_reset(&vad, &vad_cfg);
+            pre_roll_blocos = 0;
+            // Também guarda os blocos de confirmação, que o VAD ainda chamou de silêncio
+            pre_roll_max = (vad_cfg.pre_roll_ms * (taxa_hz / 1000) + MIC_BLOCK_SAMPLES - 1) / MIC_BLOCK_SAMPLES + 1;
+            if (pre_roll_max > PRE_ROLL_MAX_BLOCOS)
+              pre_roll_max = PRE_ROLL_MAX_BLOCOS;
+          }
+          publicar_controle(PROTO_INICIO, taxa_hz, codec_atual());
+          mic_start();
+          break;
+        case CMD_PARAR:
+          if (mic_is_running()) {
+            mic_stop();
+            uint n;
+            while ((n = mic_read_block(bloco)) > 0) // inclui o bloco parcial
+              processar_bloco(bloco, n, mic_block_time_us());
+            if (!vad_ativo || !vad.encerrado)
+              encerrar_captura();
+          }
+          parada_pendente = false;
+          nivel = 0;
+          break;
+      }
+    }
+
+    escoar_blocos();
+
+    // Acorda com a IRQ de bloco do DMA ou com o __sev() de um comando do core0
+    __wfe();
+  }
+}
+
+void audio_pipeline_init(uint gpio, uint sample_rate_hz) {
+  mic_gpio = gpio;
+  taxa_hz = sample_rate_hz;
+  anel_spsc_init(&fila, slots, sizeof(slot_audio_t), AUDIO_PIPELINE_SLOTS);
+
+  multicore_launch_core1(core1_main);
+  while (multicore_fifo_pop_blocking() != CMD_PRONTO)
+    tight_loop_contents();
+}
+
+void audio_pipeline_start(codec_audio_t codec, const vad_config_t *vad) {
+  if (capturando) return;
+  capturando = true;
+  vad_cfg_ativo = vad != NULL;
+  if (vad)
+    vad_cfg = *vad;
+  __dmb(); // a configuração do VAD precisa estar visível antes do comando
+  multicore_fifo_push_blocking(CMD_INICIAR | ((uint32_t)codec << 8));
+}
+
+void audio_pipeline_stop(void) {
+  if (!capturando) return;
+  capturando = false;
+  parada_pendente = true;
+  multicore_fifo_push_blocking(CMD_PARAR);
+}
+
+uint audio_pipeline_poll(void) {
+  while (multicore_fifo_rvalid()) {
+    if (multicore_fifo_pop_blocking() == CMD_FIM_VAD)
+      capturando = false;
+  }
+
+  uint enviados = 0;
+  slot_audio_t *s;
+  while ((s = anel_spsc_frente(&fila)) != NULL) {
+    switch (s->tipo) {
+      case PROTO_INICIO:
+        proto_send_start(s->arg0, s->arg1);
+        break;
+      case PROTO_FIM:
+        proto_send_stop(s->arg0, s->arg1);
+        break;
+      case PROTO_AUDIO:
+      case PROTO_MEL:
+        proto_send(s->tipo, s->dados, s->len);
+        latencias[latencias_total++ % AUDIO_PIPELINE_LATENCIAS] = time_us_32() - s->arg0;
+        break;
+      default:
+        proto_send(s->tipo, s->dados, s->len);
+        break;
+    }
+    anel_spsc_liberar(&fila);
+    enviados++;
+  }
+  return enviados;
+}
+
+bool audio_pipeline_capturando(void) {
+  return capturando;
+}
+
+bool audio_pipeline_idle(void) {
+  return !capturando && !parada_pendente && anel_spsc_vazio(&fila);
+}
+
+uint audio_pipeline_latencias(uint32_t *dst, uint max) {
+  uint n = latencias_total < AUDIO_PIPELINE_LATENCIAS ? latencias_total : AUDIO_PIPELINE_LATENCIAS;
+  if (n > max)
+    n = max;
+  for (uint i = 0; i < n; i++)
+    dst[i] = latencias[(latencias_total - n + i) % AUDIO_PIPELINE_LATENCIAS];
+  latencias_total = 0;
+  return n;
+}
+
+uint16_t audio_pipeline_nivel(void) {
+  return nivel;
+}
@@ -0,0 +1,48 @@
+// microfone/pipeline_audio.h
+
+#ifndef PIPELINE_AUDIO_H
+#define PIPELINE_AUDIO_H
+
+#include "pico/stdlib.h"
+#include "codec_audio.h"
+#include "vad.h"
+
+/*
+ * Captura e codificação de áudio no core1.
+ *
+ * O core1 é dono do ADC/DMA e do codec; cada bloco codificado vai para uma
+ * fila SPSC sem trava que o core0 esvazia para a USB (a pilha TinyUSB roda
+ * no core0). A FIFO entre os cores só carrega comandos de controle.
+ *
+ * Com o VAD ligado, o silêncio inicial não é enviado e a captura termina
+ * sozinha depois do hangover; o core0 fica sabendo por audio_pipeline_capturando().
+ */
+
+// Blocos de 32 ms que cabem na fila antes de o core1 começar a descartar
+#define AUDIO_PIPELINE_SLOTS 16
+
+// Quantas medidas de latência ADC→USB ficam guardadas (as mais recentes)
+#define AUDIO_PIPELINE_LATENCIAS 64
+
+void audio_pipeline_init(uint gpio, uint sample_rate_hz);
+// vad = NULL envia tudo e só para com audio_pipeline_stop()
+void audio_pipeline_start(codec_audio_t codec, const vad_config_t *vad);
+void audio_pipeline_stop(void);
+
+// Core0: envia os quadros prontos pela serial; retorna quantos foram enviados
+uint audio_pipeline_poll(void);
+
+// Falso depois de audio_pipeline_stop() ou quando o VAD encerrou a captura
+bool audio_pipeline_capturando(void);
+
+// Verdadeiro quando não há captura em andamento nem quadros esperando envio
+bool audio_pipeline_idle(void);
+
+// Latências ADC→USB (us, da última amostra do bloco até o quadro ser entregue
+// à USB) dos blocos mais recentes, da mais antiga para a mais nova. Zera a contagem.
+uint audio_pipeline_latencias(uint32_t *dst, uint max);
+
+// Nível do último bloco capturado (pico a pico, 0..4095); 0 fora da captura
+uint16_t audio_pipeline_nivel(void);
+
+#endif
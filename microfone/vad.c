@@ -0,0 +1,100 @@
+// microfone/vad.c
+
+#include "vad.h"
+#include "pico/stdlib.h"
+
+// Blocos usados para estimar o piso de ruído antes de aceitar fala
+#define VAD_BLOCOS_CALIBRACAO 3
+// Blocos consecutivos acima do limiar para confirmar o início da fala
+#define VAD_BLOCOS_CONFIRMACAO 2
+// Piso mínimo, para que um microfone muito silencioso não dispare com qualquer ruído
+#define VAD_PISO_MINIMO 64
+// Zona morta dos cruzamentos por zero (em LSBs do ADC), ignora o chiado
+#define VAD_ZCR_ZONA_MORTA 24
+// Fricativas (s, f, x, ch) têm pouca energia mas muitos cruzamentos por zero
+#define VAD_ZCR_FRICATIVA_Q8 77  // 0.30 cruzamentos por amostra, em Q8
+
+void vad_reset(vad_t *v, const vad_config_t *cfg) {
+  v->cfg = *cfg;
+  v->piso = VAD_PISO_MINIMO;
+  v->energia = 0;
+  v->zcr = 0;
+  v->blocos = 0;
+  v->blocos_fala = 0;
+  v->blocos_silencio = 0;
+  v->em_fala = false;
+  v->encerrado = false;
+}
+
+static inline uint32_t ms_para_blocos(uint ms, uint n, uint sample_rate_hz) {
+  return (ms * (sample_rate_hz / 1000) + n - 1) / n;
+}
+
+vad_evento_t vad_processar(vad_t *v, const uint16_t *amostras, uint n, uint sample_rate_hz) {
+  if (n == 0 || v->encerrado)
+    return v->em_fala ? VAD_FALA : VAD_SILENCIO;
+
+  // Média do bloco como estimativa do nível DC do microfone
+  uint32_t soma = 0;
+  for (uint i = 0; i < n; i++)
+    soma += amostras[i];
+  int32_t dc = soma / n;
+
+  // Energia e cruzamentos por zero, só com inteiros
+  uint32_t energia = 0;
+  uint32_t zcr = 0;
+  int32_t sinal_ant = 0;
+  for (uint i = 0; i < n; i++) {
+    int32_t x = (int32_t)amostras[i] - dc;
+    energia += (uint32_t)(x * x);
+    int32_t s = (x > VAD_ZCR_ZONA_MORTA) - (x < -VAD_ZCR_ZONA_MORTA);
+    zcr += (s != 0) & (s == -sinal_ant);
+    sinal_ant = s ? s : sinal_ant;
+  }
+  energia /= n;
+  v->energia = energia;
+  v->zcr = zcr;
+  v->blocos++;
+
+  uint32_t limiar = (v->piso * v->cfg.limiar_q4) >> 4;
+  uint32_t zcr_q8 = (zcr << 8) / n;
+  bool ativo = energia > limiar || (energia > 2 * v->piso && zcr_q8 > VAD_ZCR_FRICATIVA_Q8);
+
+  if (v->blocos <= VAD_BLOCOS_CALIBRACAO) {
+    // Calibração: o piso parte da maior energia desses blocos, o ruído do
+    // ambiente; se ela tiver sido um estalo, o piso desce rápido depois
+    ativo = false;
+    if (energia > v->piso)
+      v->piso = energia;
+  } else if (!ativo && !v->em_fala) {
+    // O piso só acompanha o ruído fora da fala: desce rápido, sobe devagar
+    if (energia < v->piso)
+      v->piso -= (v->piso - energia) >> 2;
+    else
+      v->piso += (energia - v->piso) >> 4;
+    if (v->piso < VAD_PISO_MINIMO)
+      v->piso = VAD_PISO_MINIMO;
+  }
+
+  if (!v->em_fala) {
+    v->blocos_fala = ativo ? v->blocos_fala + 1 : 0;
+    if (v->blocos_fala >= VAD_BLOCOS_CONFIRMACAO) {
+      v->em_fala = true;
+      v->blocos_silencio = 0;
+      return VAD_INICIO_FALA;
+    }
+    if (v->cfg.timeout_sem_fala_ms &&
+        v->blocos >= ms_para_blocos(v->cfg.timeout_sem_fala_ms, n, sample_rate_hz)) {
+      v->encerrado = true;
+      return VAD_SEM_FALA;
+    }
+    return VAD_SILENCIO;
+  }
+
+  v->blocos_silencio = ativo ? 0 : v->blocos_silencio + 1;
+  if (v->blocos_silencio >= ms_para_blocos(v->cfg.hangover_ms, n, sample_rate_hz)) {
+    v->encerrado = true;
+    return VAD_FIM_FALA;
+  }
+  return VAD_FALA;
+}
@@ -0,0 +1,47 @@
+// microfone/vad.h
+
+#ifndef VAD_H
+#define VAD_H
+
+#include "pico/stdlib.h"
+
+/*
+ * Detector de atividade de voz em ponto fixo, um veredito por bloco do DMA.
+ * Compara a energia de curto prazo e a taxa de cruzamentos por zero com um
+ * piso de ruído adaptativo: sobe devagar, desce rápido, e só é atualizado
+ * enquanto não há fala.
+ */
+
+typedef struct {
+    uint16_t hangover_ms;          // silêncio após a fala que encerra a captura
+    uint16_t timeout_sem_fala_ms;  // desiste se ninguém falar nesse tempo (0 = nunca)
+    uint16_t pre_roll_ms;          // silêncio mantido antes do início da fala
+    uint8_t limiar_q4;             // energia mínima da fala em relação ao piso (Q4: 48 = 3x)
+} vad_config_t;
+
+#define VAD_CONFIG_PADRAO { .hangover_ms = 1200, .timeout_sem_fala_ms = 8000, .pre_roll_ms = 64, .limiar_q4 = 48 }
+
+typedef enum {
+    VAD_SILENCIO    = 0,  // ainda não houve fala: o bloco pode ser descartado
+    VAD_INICIO_FALA = 1,  // primeiro bloco de fala confirmado
+    VAD_FALA        = 2,  // fala ou silêncio curto dentro do hangover
+    VAD_FIM_FALA    = 3,  // hangover esgotado: a captura pode terminar
+    VAD_SEM_FALA    = 4,  // timeout sem nenhuma fala
+} vad_evento_t;
+
+typedef struct {
+    vad_config_t cfg;
+    uint32_t piso;           // energia média do ruído (amostras de 12 bits ao quadrado)
+    uint32_t energia;        // energia do último bloco, para relatório
+    uint16_t zcr;            // cruzamentos por zero no último bloco
+    uint32_t blocos;         // blocos analisados desde o reset
+    uint32_t blocos_fala;    // blocos consecutivos acima do limiar
+    uint32_t blocos_silencio;
+    bool em_fala;
+    bool encerrado;
+} vad_t;
+
+void vad_reset(vad_t *v, const vad_config_t *cfg);
+vad_evento_t vad_processar(vad_t *v, const uint16_t *amostras, uint n, uint sample_rate_hz);
+
+#endif
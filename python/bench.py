@@ -0,0 +1,209 @@
+# Benchmarks: coleta as linhas JSON da suíte do firmware (bench/, opção
+# FIRMWARE_BENCH), mede o caminho de texto do host e compara duas rodadas.
+#
+#   python3 bench.py coletar COM7 -o base.jsonl          # Pico (ou a simulação: arquivo
+#   python3 bench.py coletar saida_serial.bin -o ...     # gravado com --serial)
+#   python3 bench.py host -o host.jsonl
+#   python3 bench.py comparar base.jsonl novo.jsonl --limiar 10
+#
+# Cada linha de resultado segue o esquema do firmware:
+#   {"bench", "plataforma", "unidade", "n", "min", "mediana", "p99", "max", "commit"}
+# e "comparar" sai com código 1 se alguma mediana piorou mais que o limiar.
+
+import argparse
+import json
+import math
+import os
+import subprocess
+import sys
+import time
+from array import array
+
+import protocolo_serial as proto
+from texto import normalize_string, levenshtein
+import distancia
+import dsp_voz
+
+BASE_DIR = os.path.dirname(os.path.abspath(__file__))
+FIM = "bench_fim"
+
+
+def commit_atual():
+    try:
+        return subprocess.run(["git", "rev-parse", "--short", "HEAD"], cwd=BASE_DIR,
+                              capture_output=True, text=True, check=True).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return "desconhecido"
+
+
+def resumir(nome, amostras, unidade, plataforma):
+    """min/mediana/p99/max pelo posto mais próximo, como bench/bench.c."""
+    v = sorted(amostras)
+    n = len(v)
+
+    def percentil(p):
+        posto = (n * p + 99) // 100
+        return v[max(posto, 1) - 1]
+
+    return {"bench": nome, "plataforma": plataforma, "unidade": unidade, "n": n,
+            "min": v[0], "mediana": percentil(50), "p99": percentil(99), "max": v[-1]}
+
+
+# ---------- coletar ----------
+def coletar(origem, timeout):
+    """Lê as linhas {"bench"...} da serial (porta) ou de uma gravação (arquivo) até bench_fim."""
+    dec = proto.DecodificadorSerial()
+    resultados = []
+
+    def consumir():
+        while dec.linhas:
+            linha = dec.linhas.popleft()
+            if linha.startswith('{"bench"'):
+                resultados.append(json.loads(linha))
+            elif linha == FIM:
+                return True
+        dec.quadros.clear()  # quadros de áudio do bench de latência
+        return False
+
+    if os.path.isfile(origem):
+        with open(origem, "rb") as f:
+            dec.alimentar(f.read())
+        dec.alimentar(b"\n")
+        consumir()
+        return resultados
+
+    import serial
+    with serial.Serial(origem, 115200, timeout=0.1) as ser:
+        limite = time.monotonic() + timeout
+        while time.monotonic() < limite:
+            proto.ler_serial(ser, dec)
+            if consumir():
+                break
+        else:
+            print(f"[WARN] {FIM} não chegou em {timeout} s", file=sys.stderr)
+    return resultados
+
+
+# ---------- host ----------
+def carregar_palavras():
+    pasta = os.path.join(BASE_DIR, "..", "dataset")
+    palavras = []
+    for nome in sorted(os.listdir(pasta)):
+        if nome.startswith("palavras_") and nome.endswith(".txt"):
+            with open(os.path.join(pasta, nome), encoding="utf-8") as f:
+                palavras += f.read().split()
+    return palavras
+
+
+def medir(fn, entradas, repeticoes):
+    """Tempo por chamada em ns; cada amostra é a média de uma passada sobre as entradas."""
+    amostras = []
+    for _ in range(repeticoes):
+        t0 = time.perf_counter_ns()
+        for e in entradas:
+            fn(*e)
+        amostras.append((time.perf_counter_ns() - t0) // len(entradas))
+    return amostras
+
+
+def bench_host(repeticoes, n_palavras):
+    palavras = carregar_palavras()[:n_palavras]
+    # Transcrições parecidas com as do ASR: letras soltas, maiúsculas, acentos
+    transcricoes = [(" ".join(p.upper()) + " é",) for p in palavras]
+    pares = [(p, palavras[(i * 7 + 1) % len(palavras)]) for i, p in enumerate(palavras)]
+
+    def caminho_completo(t, esperada):
+        return levenshtein(normalize_string(t), esperada)
+
+    casos = [
+        ("normalize_string", normalize_string, transcricoes),
+        ("levenshtein", levenshtein, pares),
+        ("normaliza_e_compara", caminho_completo, [(t[0], p) for t, p in zip(transcricoes, palavras)]),
+    ]
+    if distancia.NATIVA:
+        # Myers bit-paralelo via ctypes, com o limite usado no avaliador (k = 2)
+        casos.append(("levenshtein_myers", lambda a, b: distancia.levenshtein(a, b, 2), pares))
+    if dsp_voz.NATIVA:
+        # Captura de 3 s a 8 kHz, em quadros de 256 amostras, até o áudio pronto para o ASR
+        captura = array("h", (int(1500 + 6000 * math.sin(i * 0.35) * (i // 4000 % 2)) for i in range(24000)))
+
+        def pre_processar(amostras):
+            proc = dsp_voz.ProcessadorVoz(8000)
+            for i in range(0, len(amostras), 256):
+                proc.empurrar(amostras, i, min(i + 256, len(amostras)))
+            return proc.finalizar()
+
+        casos.append(("dsp_voz_captura_3s", pre_processar, [(captura,)]))
+    return [resumir(nome, medir(fn, entradas, repeticoes), "ns", "host-python")
+            for nome, fn, entradas in casos]
+
+
+# ---------- comparar ----------
+def ler_jsonl(caminho):
+    with open(caminho, encoding="utf-8") as f:
+        return {(r["plataforma"], r["bench"]): r for r in map(json.loads, filter(str.strip, f))}
+
+
+def comparar(base, novo, limiar):
+    a, b = ler_jsonl(base), ler_jsonl(novo)
+    piorou = False
+    print(f"{'bench':36} {'base':>12} {'novo':>12} {'var %':>8}")
+    for chave in sorted(a.keys() & b.keys()):
+        ma, mb = a[chave]["mediana"], b[chave]["mediana"]
+        var = (mb - ma) * 100.0 / ma if ma else 0.0
+        marca = ""
+        if var > limiar:
+            piorou = True
+            marca = "  << regressão"
+        nome = f"{chave[0]}/{chave[1]}"
+        print(f"{nome:36} {ma:>12} {mb:>12} {var:>+8.1f}{marca}")
+    for chave in sorted(a.keys() ^ b.keys()):
+        print(f"{chave[0]}/{chave[1]}: só em {'base' if chave in a else 'novo'}")
+    return 1 if piorou else 0
+
+
+def gravar(resultados, saida):
+    commit = commit_atual()
+    f = open(saida, "w", encoding="utf-8") if saida else sys.stdout
+    for r in resultados:
+        r.setdefault("commit", commit)
+        f.write(json.dumps(r, ensure_ascii=False) + "\n")
+    if saida:
+        f.close()
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Benchmarks do Soletrando (firmware e host)")
+    sub = ap.add_subparsers(dest="cmd", required=True)
+
+    c = sub.add_parser("coletar", help="lê os resultados do firmware (porta serial ou gravação)")
+    c.add_argument("origem")
+    c.add_argument("-o", "--saida")
+    c.add_argument("--timeout", type=float, default=60.0)
+
+    h = sub.add_parser("host", help="mede normalização e Levenshtein no host")
+    h.add_argument("-o", "--saida")
+    h.add_argument("--repeticoes", type=int, default=50)
+    h.add_argument("--palavras", type=int, default=500)
+
+    k = sub.add_parser("comparar", help="compara medianas de duas rodadas")
+    k.add_argument("base")
+    k.add_argument("novo")
+    k.add_argument("--limiar", type=float, default=10.0, help="piora máxima aceita em %%")
+
+    args = ap.parse_args()
+    if args.cmd == "coletar":
+        resultados = coletar(args.origem, args.timeout)
+        if not resultados:
+            print("[ERRO] nenhum resultado de bench encontrado", file=sys.stderr)
+            return 1
+        gravar(resultados, args.saida)
+    elif args.cmd == "host":
+        gravar(bench_host(args.repeticoes, args.palavras), args.saida)
+    else:
+        return comparar(args.base, args.novo, args.limiar)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
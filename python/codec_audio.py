@@ -0,0 +1,66 @@
+# Decodificadores dos formatos de áudio enviados pela Pico (ver microfone/codec_audio.c)
+
+from array import array
+
+PCM8 = 0x00
+MULAW = 0x01
+IMA_ADPCM = 0x02
+LOG_MEL = 0x03  # sem áudio: as características chegam em quadros protocolo_serial.MEL
+
+_ADPCM_STEP = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+]
+_ADPCM_INDEX = [-1, -1, -1, -1, 2, 4, 6, 8, -1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def _tabela_mulaw():
+    tabela = []
+    for u in range(256):
+        u = ~u & 0xFF
+        exp = (u >> 4) & 0x07
+        mant = u & 0x0F
+        mag = (((mant << 3) + 0x84) << exp) - 0x84
+        tabela.append(-mag if u & 0x80 else mag)
+    return tabela
+
+
+_MULAW = _tabela_mulaw()
+_PCM8 = [(b - 128) * 256 for b in range(256)]
+
+
+def _adpcm(payload: bytes, saida: array):
+    # A Pico só codifica blocos pares: cada byte são duas amostras
+    pred = int.from_bytes(payload[0:2], "little", signed=True)
+    idx = payload[2]
+    for byte in payload[3:]:
+        for code in (byte & 0x0F, byte >> 4):
+            step = _ADPCM_STEP[idx]
+            vpdiff = step >> 3
+            if code & 4:
+                vpdiff += step
+            if code & 2:
+                vpdiff += step >> 1
+            if code & 1:
+                vpdiff += step >> 2
+            pred = pred - vpdiff if code & 8 else pred + vpdiff
+            pred = max(-32768, min(32767, pred))
+            idx = max(0, min(88, idx + _ADPCM_INDEX[code]))
+            saida.append(pred)
+
+
+def decodificar(formato: int, payload: bytes, saida: array):
+    """Acrescenta em `saida` (array('h')) as amostras de 16 bits de um quadro de áudio."""
+    if formato == IMA_ADPCM:
+        _adpcm(payload, saida)
+    elif formato == MULAW:
+        saida.extend(_MULAW[b] for b in payload)
+    else:
+        saida.extend(_PCM8[b] for b in payload)
@@ -0,0 +1,130 @@
+# Distância de edição e busca das palavras do dicionário mais próximas de uma
+# transcrição. Usa a biblioteca nativa (ferramentas/distancia.c, Myers
+# bit-paralelo + filtro de assinatura) quando ela foi compilada; senão cai no
+# levenshtein de texto.py, com os mesmos filtros, bem mais lento.
+#
+#   python3 distancia.py ../dataset/palavras.idx kaza caza   # vizinhas de cada consulta
+
+import ctypes
+import glob
+import os
+import sys
+
+from texto import levenshtein as levenshtein_py
+
+BASE_DIR = os.path.dirname(os.path.abspath(__file__))
+MAX_LETRAS = 64
+
+
+def _carregar_biblioteca():
+    """DISTANCIA_LIB ou a libdistancia de algum diretório de build ao lado do repositório."""
+    candidatos = [os.environ.get("DISTANCIA_LIB", "")]
+    candidatos += sorted(glob.glob(os.path.join(BASE_DIR, "..", "*", "ferramentas", "libdistancia.*")))
+    for caminho in filter(None, candidatos):
+        try:
+            lib = ctypes.CDLL(caminho)
+        except OSError:
+            continue
+        lib.distancia_levenshtein.argtypes = [ctypes.c_char_p, ctypes.c_char_p, ctypes.c_int]
+        lib.distancia_levenshtein.restype = ctypes.c_int
+        lib.distancia_abrir.argtypes = [ctypes.c_char_p]
+        lib.distancia_abrir.restype = ctypes.c_void_p
+        lib.distancia_fechar.argtypes = [ctypes.c_void_p]
+        lib.distancia_palavra.argtypes = [ctypes.c_void_p, ctypes.c_uint32]
+        lib.distancia_palavra.restype = ctypes.c_char_p
+        lib.distancia_vizinhas.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int, ctypes.c_int,
+                                           ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(ctypes.c_uint8)]
+        lib.distancia_vizinhas.restype = ctypes.c_int
+        return lib
+    return None
+
+
+_lib = _carregar_biblioteca()
+NATIVA = _lib is not None
+
+
+def levenshtein(a, b, k=None):
+    """Distância entre duas palavras normalizadas; com k, qualquer valor acima vira k + 1."""
+    if k is None:
+        k = max(len(a), len(b))
+    if NATIVA and len(a) <= MAX_LETRAS:
+        return _lib.distancia_levenshtein(a.encode("ascii"), b.encode("ascii"), k)
+    if abs(len(a) - len(b)) > k:
+        return k + 1
+    return min(levenshtein_py(a, b), k + 1)
+
+
+def _assinatura(s):
+    """Como assinatura_de() em distancia.c: letras presentes e letras repetidas."""
+    m = 0
+    for c in s:
+        bit = 1 << (ord(c) - ord("a"))
+        m |= bit << 32 if m & bit else bit
+    return m
+
+
+class Vizinhas:
+    """Busca das palavras do índice (python/indice_palavras.py) mais próximas de uma consulta."""
+
+    def __init__(self, caminho_indice):
+        self._d = None
+        if NATIVA:
+            self._d = _lib.distancia_abrir(os.fsencode(caminho_indice))
+            if not self._d:
+                raise ValueError(f"{caminho_indice}: índice de palavras inválido")
+        else:
+            from indice_palavras import IndicePalavras
+            indice = IndicePalavras(caminho_indice)
+            self._por_tamanho = {}
+            for i in range(indice.num_palavras):
+                p = indice.entrada(i)[0]
+                self._por_tamanho.setdefault(len(p), []).append((p, _assinatura(p)))
+            for lista in self._por_tamanho.values():
+                lista.sort()
+            indice.fechar()
+
+    def fechar(self):
+        if self._d:
+            _lib.distancia_fechar(self._d)
+            self._d = None
+
+    def buscar(self, consulta, k=2, maximo=5):
+        """[(palavra, distância)] com distância <= k, das mais próximas para as mais distantes."""
+        if not consulta.isascii() or not consulta.isalpha() or len(consulta) > MAX_LETRAS:
+            return []
+        if self._d:
+            indices = (ctypes.c_uint32 * maximo)()
+            dists = (ctypes.c_uint8 * maximo)()
+            n = _lib.distancia_vizinhas(self._d, consulta.encode("ascii"), k, maximo, indices, dists)
+            return [(_lib.distancia_palavra(self._d, indices[i]).decode("ascii"), dists[i]) for i in range(n)]
+
+        aq = _assinatura(consulta)
+        m = len(consulta)
+        achadas = []
+        for n in range(m - k, m + k + 1):
+            for p, aw in self._por_tamanho.get(n, ()):
+                if max(bin(aq & ~aw).count("1"), bin(aw & ~aq).count("1")) > k:
+                    continue
+                dist = levenshtein_py(consulta, p)
+                if dist <= k:
+                    achadas.append((dist, abs(n - m), n, p))
+        achadas.sort()  # mesmo desempate da nativa: tamanho mais perto, mais curta, alfabética
+        return [(p, dist) for dist, _, _, p in achadas[:maximo]]
+
+
+def main():
+    if len(sys.argv) < 3:
+        print("uso: distancia.py palavras.idx consulta [consulta...]", file=sys.stderr)
+        return 2
+    import time
+    vizinhas = Vizinhas(sys.argv[1])
+    print(f"[INFO] biblioteca {'nativa' if NATIVA else 'Python (lenta)'}")
+    for consulta in sys.argv[2:]:
+        t0 = time.perf_counter()
+        achadas = vizinhas.buscar(consulta)
+        print(f"{consulta}: {achadas}  ({(time.perf_counter() - t0) * 1e3:.3f} ms)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
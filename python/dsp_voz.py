@@ -0,0 +1,235 @@
+# Pré-processamento da fala para o ASR, em memória e à medida que os blocos
+# chegam da Pico: remoção de DC, corte de silêncios, normalização de pico e
+# reamostragem polifásica para 16 kHz. Usa a biblioteca nativa
+# (ferramentas/dsp_voz.c) quando ela foi compilada; senão roda o mesmo
+# algoritmo em Python, bem mais lento. Substitui a ida e volta por arquivos
+# .wav com o pydub (normalize + split_on_silence, mesmos parâmetros).
+#
+#   python3 dsp_voz.py voz.wav voz_16k.wav    # processa um .wav de 8 kHz, 16 bits
+
+import ctypes
+import glob
+import math
+import os
+import sys
+import wave
+from array import array
+
+BASE_DIR = os.path.dirname(os.path.abspath(__file__))
+TAXA_SAIDA = 16000
+
+# Mesmos parâmetros de dsp_voz.c
+TAPS = 16
+LOTE = 256
+CORTE_DC_HZ = 20.0
+BLOCOS_POR_SEGUNDO = 100
+SILENCIO_MIN_BLOCOS = 70
+MARGEM_BLOCOS = 30
+PAUSA_MS = 200
+LIMIAR_DB = 14.0
+FOLGA_DB = 0.1
+
+
+def _carregar_biblioteca():
+    """DSP_VOZ_LIB ou a libdsp_voz de algum diretório de build ao lado do repositório."""
+    candidatos = [os.environ.get("DSP_VOZ_LIB", "")]
+    candidatos += sorted(glob.glob(os.path.join(BASE_DIR, "..", "*", "ferramentas", "libdsp_voz.*")))
+    for caminho in filter(None, candidatos):
+        try:
+            lib = ctypes.CDLL(caminho)
+        except OSError:
+            continue
+        lib.dsp_voz_criar.argtypes = [ctypes.c_int]
+        lib.dsp_voz_criar.restype = ctypes.c_void_p
+        lib.dsp_voz_destruir.argtypes = [ctypes.c_void_p]
+        lib.dsp_voz_empurrar.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t]
+        lib.dsp_voz_empurrar.restype = ctypes.c_int
+        lib.dsp_voz_finalizar.argtypes = [ctypes.c_void_p]
+        lib.dsp_voz_finalizar.restype = ctypes.c_size_t
+        lib.dsp_voz_saida.argtypes = [ctypes.c_void_p]
+        lib.dsp_voz_saida.restype = ctypes.c_void_p
+        return lib
+    return None
+
+
+_lib = _carregar_biblioteca()
+NATIVA = _lib is not None
+
+
+def _projetar_filtro(fator):
+    """Como projetar_filtro() em dsp_voz.c: fases já invertidas, ganho 1 em DC cada."""
+    n = fator * TAPS
+    c, fc = (n - 1) / 2.0, 0.45 / fator
+    h = []
+    for i in range(n):
+        x = 2.0 * fc * (i - c)
+        sinc = 1.0 if abs(x) < 1e-12 else math.sin(math.pi * x) / (math.pi * x)
+        w = 0.42 - 0.5 * math.cos(2.0 * math.pi * i / (n - 1)) + 0.08 * math.cos(4.0 * math.pi * i / (n - 1))
+        h.append(2.0 * fc * sinc * w)
+    fases = []
+    for p in range(fator):
+        soma = sum(h[p + k * fator] for k in range(TAPS))
+        fases.append([h[p + (TAPS - 1 - j) * fator] / soma for j in range(TAPS)])
+    return fases
+
+
+class ProcessadorVoz:
+    """Uma captura: empurrar() a cada quadro de áudio, finalizar() no quadro FIM."""
+
+    def __init__(self, taxa_entrada):
+        if taxa_entrada <= 0 or TAXA_SAIDA % taxa_entrada or TAXA_SAIDA // taxa_entrada > 4:
+            raise ValueError(f"taxa de entrada não suportada: {taxa_entrada} Hz")
+        self._d = None
+        if NATIVA:
+            self._d = _lib.dsp_voz_criar(taxa_entrada)
+            if not self._d:
+                raise MemoryError("dsp_voz_criar")
+            return
+        self.fator = TAXA_SAIDA // taxa_entrada
+        self.bloco = taxa_entrada // BLOCOS_POR_SEGUNDO
+        self.r = 1.0 - 2.0 * math.pi * CORTE_DC_HZ / taxa_entrada
+        self.fases = _projetar_filtro(self.fator)
+        self.x_ant = None
+        self.y_ant = 0.0
+        self.entrada = [0.0] * (TAPS - 1)
+        self.reamostrado = []
+        self.energias = []
+        self.soma_bloco = self.soma_total = 0.0
+        self.no_bloco = self.n_amostras = 0
+        self.pico = 0.0
+
+    def __del__(self):
+        if getattr(self, "_d", None):
+            _lib.dsp_voz_destruir(self._d)
+            self._d = None
+
+    def empurrar(self, amostras, inicio=0, fim=None):
+        """Processa amostras[inicio:fim] (array('h') nativo, 16 bits)."""
+        fim = len(amostras) if fim is None else fim
+        if fim <= inicio:
+            return
+        if self._d:
+            endereco, _ = amostras.buffer_info()
+            if _lib.dsp_voz_empurrar(self._d, endereco + inicio * amostras.itemsize, fim - inicio) != 0:
+                raise MemoryError("dsp_voz_empurrar")
+            return
+
+        if self.x_ant is None:
+            self.x_ant = float(amostras[inicio])
+        ini = len(self.entrada)
+        for i in range(inicio, fim):
+            x = float(amostras[i])
+            y = x - self.x_ant + self.r * self.y_ant
+            self.x_ant, self.y_ant = x, y
+            self.entrada.append(y)
+            self.pico = max(self.pico, abs(y))
+            self.soma_bloco += y * y
+            self.soma_total += y * y
+            self.no_bloco += 1
+            if self.no_bloco == self.bloco:
+                self._fechar_bloco()
+        self.n_amostras += fim - inicio
+        self._reamostrar(ini)
+
+    def _fechar_bloco(self):
+        self.energias.append(self.soma_bloco / self.no_bloco)
+        self.soma_bloco, self.no_bloco = 0.0, 0
+
+    def _reamostrar(self, ini):
+        x = self.entrada
+        for n in range(ini, len(x)):
+            janela = x[n - TAPS + 1:n + 1]
+            for coef in self.fases:
+                self.reamostrado.append(sum(h * v for h, v in zip(coef, janela)))
+
+    def finalizar(self):
+        """Áudio pronto para o ASR: bytes de 16 bits little-endian a 16 kHz (pode ser vazio)."""
+        if self._d:
+            n = _lib.dsp_voz_finalizar(self._d)
+            return ctypes.string_at(_lib.dsp_voz_saida(self._d), 2 * n) if n else b""
+        if self.n_amostras == 0:
+            return b""
+        if self.no_bloco:
+            self._fechar_bloco()
+        ini = len(self.entrada)
+        self.entrada += [0.0] * (TAPS - 1)
+        self._reamostrar(ini)
+
+        total = self.n_amostras * self.fator
+        por_bloco = self.bloco * self.fator
+        atraso = (self.fator * TAPS - 1) // 2
+        ganho = 32767.0 * 10 ** (-FOLGA_DB / 20) / self.pico if self.pico > 0 else 1.0
+        limiar = self.soma_total / self.n_amostras * 10 ** (-LIMIAR_DB / 10)
+        pausa = array("h", bytes(2 * (TAXA_SAIDA * PAUSA_MS // 1000)))
+        saida = array("h")
+
+        def copiar(de, ate):
+            for v in self.reamostrado[de + atraso:ate + atraso]:
+                saida.append(int(max(-32768.0, min(32767.0, round(v * ganho)))))
+
+        def trecho(de, ate):
+            if not saida:
+                saida.extend(pausa)
+            de = max(de - MARGEM_BLOCOS, 0)
+            ate = min(ate + MARGEM_BLOCOS, len(self.energias))
+            copiar(de * por_bloco, min(ate * por_bloco, total))
+            saida.extend(pausa)
+
+        # Trechos = o que sobra entre silêncios de SILENCIO_MIN_BLOCOS blocos ou mais
+        e = self.energias
+        inicio = b = 0
+        while b < len(e):
+            if e[b] >= limiar:
+                b += 1
+                continue
+            fim = b
+            while fim < len(e) and e[fim] < limiar:
+                fim += 1
+            if fim - b >= SILENCIO_MIN_BLOCOS:
+                if b > inicio:
+                    trecho(inicio, b)
+                inicio = fim
+            b = fim
+        if len(e) > inicio:
+            trecho(inicio, len(e))
+
+        if not saida:
+            copiar(0, total)  # nada além de silêncio: devolve tudo
+        if sys.byteorder != "little":
+            saida.byteswap()
+        return saida.tobytes()
+
+
+def main():
+    if len(sys.argv) != 3:
+        print("uso: dsp_voz.py entrada.wav saida.wav", file=sys.stderr)
+        return 2
+    import time
+    with wave.open(sys.argv[1], "rb") as wf:
+        if wf.getnchannels() != 1 or wf.getsampwidth() != 2:
+            print("[ERRO] esperado .wav mono de 16 bits", file=sys.stderr)
+            return 1
+        taxa = wf.getframerate()
+        amostras = array("h", wf.readframes(wf.getnframes()))
+    if sys.byteorder != "little":
+        amostras.byteswap()
+
+    t0 = time.perf_counter()
+    proc = ProcessadorVoz(taxa)
+    for i in range(0, len(amostras), LOTE):  # em blocos, como chegam da Pico
+        proc.empurrar(amostras, i, min(i + LOTE, len(amostras)))
+    saida = proc.finalizar()
+    dt = time.perf_counter() - t0
+
+    with wave.open(sys.argv[2], "wb") as wf:
+        wf.setnchannels(1)
+        wf.setsampwidth(2)
+        wf.setframerate(TAXA_SAIDA)
+        wf.writeframes(saida)
+    print(f"[INFO] {'nativa' if NATIVA else 'Python (lenta)'}: {len(amostras)} amostras a {taxa} Hz -> "
+          f"{len(saida) // 2} a {TAXA_SAIDA} Hz em {dt * 1e3:.2f} ms")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,141 @@
+# Compila o dataset num DAWG (grafo acíclico de palavras minimizado) para a
+# flash da Pico: dicionario/dicionario.c sorteia e procura palavras direto
+# nessas tabelas, sem descompactar nada. Chamado pelo CMake a cada build em
+# que o dataset muda; também roda à mão para ver o tamanho:
+#
+#   python3 gerar_dicionario.py ../dataset/palavras.txt -o dicionario_dados.c --min 5 --max 7
+#
+# Cada tamanho de palavra tem a sua raiz, então todas as palavras abaixo de um
+# nó têm o mesmo número de letras e um único contador por aresta basta para o
+# sorteio uniforme. Os sufixos iguais (-ção, -mente...) são compartilhados entre
+# tamanhos pela minimização. Formato das tabelas em dicionario/dicionario_dados.h.
+
+import argparse
+import os
+import sys
+
+from texto import normalize_string
+
+BITS_DESTINO = 22
+MAX_CONTAGEM = 0xFFFF
+FINAL = 0  # nó sem arestas onde todas as palavras terminam
+
+
+def carregar(caminho, minimo, maximo):
+    """Palavras normalizadas (a-z, minúsculas, sem acentos), sem repetição, por tamanho."""
+    por_tamanho = {}
+    with open(caminho, encoding="utf-8") as f:
+        for bruta in f.read().split():
+            p = normalize_string(bruta)
+            if minimo <= len(p) <= maximo and p.isascii() and p.isalpha():
+                por_tamanho.setdefault(len(p), set()).add(p)
+    return {n: sorted(ps) for n, ps in sorted(por_tamanho.items())}
+
+
+class Dawg:
+    """Minimização por registro: cada nó é identificado pela tupla (letra, filho) das arestas."""
+
+    def __init__(self):
+        self.registro = {(): FINAL}
+        self.nos = [()]          # id -> arestas
+        self.contagem = [1]      # id -> palavras abaixo do nó
+
+    def construir(self, palavras, profundidade=0):
+        """palavras: ordenadas, todas do mesmo tamanho; devolve o id do nó mínimo."""
+        if profundidade == len(palavras[0]):
+            return FINAL
+        arestas = []
+        inicio = 0
+        while inicio < len(palavras):
+            letra = palavras[inicio][profundidade]
+            fim = inicio
+            while fim < len(palavras) and palavras[fim][profundidade] == letra:
+                fim += 1
+            arestas.append((letra, self.construir(palavras[inicio:fim], profundidade + 1)))
+            inicio = fim
+        chave = tuple(arestas)
+        no = self.registro.get(chave)
+        if no is None:
+            no = len(self.nos)
+            self.registro[chave] = no
+            self.nos.append(chave)
+            self.contagem.append(sum(self.contagem[f] for _, f in arestas))
+        return no
+
+
+def serializar(dawg, raizes):
+    """Arestas contíguas por nó, em largura a partir das raízes (vizinhos ficam perto na flash)."""
+    primeira = {FINAL: 0}
+    ordem = []
+    fila = [r for _, r in raizes]
+    proxima = 1  # a aresta 0 é reservada: destino 0 = fim da palavra
+    while fila:
+        seguinte = []
+        for no in fila:
+            if no in primeira:
+                continue
+            primeira[no] = proxima
+            proxima += len(dawg.nos[no])
+            ordem.append(no)
+            seguinte += [f for _, f in dawg.nos[no]]
+        fila = seguinte
+
+    if proxima >= 1 << BITS_DESTINO:
+        sys.exit(f"[ERRO] {proxima} arestas não cabem em {BITS_DESTINO} bits")
+
+    arestas = [0]
+    contagens = [0]
+    for no in ordem:
+        filhos = dawg.nos[no]
+        for i, (letra, filho) in enumerate(filhos):
+            if dawg.contagem[filho] > MAX_CONTAGEM:
+                sys.exit(f"[ERRO] {dawg.contagem[filho]} palavras abaixo de uma aresta (máx. {MAX_CONTAGEM})")
+            ultima = 1 << 31 if i == len(filhos) - 1 else 0
+            arestas.append(ultima | (ord(letra) - ord("a") + 1) << BITS_DESTINO | primeira[filho])
+            contagens.append(dawg.contagem[filho])
+    return arestas, contagens, primeira
+
+
+def escrever_c(saida, origem, raizes, dawg, arestas, contagens, primeira):
+    with open(saida, "w", encoding="utf-8") as f:
+        f.write(f"// Gerado por python/gerar_dicionario.py a partir de {os.path.basename(origem)}; não edite.\n\n")
+        f.write('#include "dicionario/dicionario_dados.h"\n\n')
+        f.write(f"const dicionario_raiz_t dicionario_raizes[{len(raizes)}] = {{\n")
+        for letras, raiz in raizes:
+            f.write(f"    {{{letras}, {primeira[raiz]}, {dawg.contagem[raiz]}}},\n")
+        f.write("};\n")
+        f.write(f"const uint dicionario_num_raizes = {len(raizes)};\n\n")
+        for nome, tipo, valores, fmt in (("dicionario_arestas", "uint32_t", arestas, "0x{:08x}"),
+                                          ("dicionario_contagens", "uint16_t", contagens, "{}")):
+            f.write(f"const {tipo} {nome}[{len(valores)}] = {{\n")
+            for i in range(0, len(valores), 8):
+                f.write("    " + ", ".join(fmt.format(v) for v in valores[i:i + 8]) + ",\n")
+            f.write("};\n\n")
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Gera as tabelas do dicionário (DAWG) da Pico")
+    ap.add_argument("dataset")
+    ap.add_argument("-o", "--saida", required=True)
+    ap.add_argument("--min", type=int, default=5, help="menor tamanho de palavra incluído")
+    ap.add_argument("--max", type=int, default=7, help="maior tamanho de palavra incluído")
+    args = ap.parse_args()
+
+    por_tamanho = carregar(args.dataset, args.min, args.max)
+    if not por_tamanho:
+        sys.exit("[ERRO] nenhuma palavra no intervalo pedido")
+
+    sys.setrecursionlimit(10000)
+    dawg = Dawg()
+    raizes = [(n, dawg.construir(ps)) for n, ps in por_tamanho.items()]
+    arestas, contagens, primeira = serializar(dawg, raizes)
+    escrever_c(args.saida, args.dataset, raizes, dawg, arestas, contagens, primeira)
+
+    total = sum(len(ps) for ps in por_tamanho.values())
+    print(f"dicionario: {total} palavras ({args.min}..{args.max} letras), {len(dawg.nos)} nós, "
+          f"{len(arestas)} arestas, {len(arestas) * 6} bytes")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,135 @@
+# Leitor do índice binário de palavras (gerado por ferramentas/indexar_palavras.c).
+# O arquivo é mapeado com mmap e nada é lido antes de ser usado: abrir é
+# instantâneo e cada sorteio custa O(1), por mais rica que seja a pontuação
+# de dificuldade (ela é toda calculada pelo indexador).
+#
+#   ./build/ferramentas/indexar_palavras dataset/palavras.txt dataset/palavras.idx
+#   python3 indice_palavras.py ../dataset/palavras.idx 6    # níveis e sorteios de 6 letras
+
+import bisect
+import mmap
+import os
+import random
+import struct
+import sys
+
+CABECALHO = struct.Struct("<4sHBBIIIIIII4x")
+ENTRADA = struct.Struct("<IBBH")
+ALIAS = struct.Struct("<II")
+INICIAIS = 26
+
+CAMINHO_PADRAO = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "dataset", "palavras.idx")
+
+
+class IndicePalavras:
+    def __init__(self, caminho=CAMINHO_PADRAO):
+        with open(caminho, "rb") as f:
+            self.mm = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        (magic, versao, self.letras_max, self.niveis, self.num_palavras, self.off_baldes,
+         self.off_entradas, self.off_textos, _, self.off_pesos, self.off_amostragem) = CABECALHO.unpack_from(self.mm)
+        if magic != b"SPIX" or versao != 2:
+            raise ValueError(f"{caminho}: índice de palavras inválido")
+        self.tamanhos = self.letras_max + 1
+
+        # Pesos acumulados por nível (escolhe o tamanho) e por tamanho (escolhe o nível):
+        # niveis x tamanhos u32, lidos uma vez
+        pesos = struct.unpack_from(f"<{self.niveis * self.tamanhos}I", self.mm, self.off_pesos)
+        self._acum_nivel = [self._acumular(pesos[n * self.tamanhos:(n + 1) * self.tamanhos])
+                            for n in range(self.niveis)]
+        self._acum_letras = [self._acumular(pesos[l::self.tamanhos]) for l in range(self.tamanhos)]
+
+    @staticmethod
+    def _acumular(valores):
+        acum, soma = [], 0
+        for v in valores:
+            soma += v
+            acum.append(soma)
+        return acum
+
+    def fechar(self):
+        self.mm.close()
+
+    def _balde(self, b):
+        return struct.unpack_from("<I", self.mm, self.off_baldes + 4 * b)[0]
+
+    def faixa(self, nivel, letras=None, inicial=None):
+        """(início, fim) das entradas de um nível; letras e inicial estreitam a faixa."""
+        if not 0 <= nivel < self.niveis or (letras is not None and not 0 <= letras <= self.letras_max):
+            return 0, 0
+        if letras is None:
+            b, n = nivel * self.tamanhos * INICIAIS, self.tamanhos * INICIAIS
+        elif inicial is None:
+            b, n = (nivel * self.tamanhos + letras) * INICIAIS, INICIAIS
+        else:
+            b, n = (nivel * self.tamanhos + letras) * INICIAIS + ord(inicial) - ord("a"), 1
+        return self._balde(b), self._balde(b + n)
+
+    def total(self, nivel=None, letras=None):
+        if nivel is not None:
+            ini, fim = self.faixa(nivel, letras)
+            return fim - ini
+        if letras is None:
+            return self.num_palavras
+        return sum(self.total(n, letras) for n in range(self.niveis))
+
+    def entrada(self, i):
+        """(normalizada, original, pontuação de dificuldade) da i-ésima entrada."""
+        texto, letras, n_orig, pontuacao = ENTRADA.unpack_from(self.mm, self.off_entradas + ENTRADA.size * i)
+        pos = self.off_textos + texto
+        normalizada = self.mm[pos:pos + letras].decode("ascii")
+        original = self.mm[pos + letras:pos + letras + n_orig].decode("utf-8")
+        return normalizada, original, pontuacao
+
+    @staticmethod
+    def _escolher(acum, rng):
+        """Índice sorteado proporcionalmente aos pesos acumulados; None se todos forem 0."""
+        if not acum or acum[-1] == 0:
+            return None
+        return bisect.bisect_right(acum, rng.randrange(acum[-1]))
+
+    def sortear(self, nivel=None, letras=None, inicial=None, rng=random):
+        """
+        Palavra do nível (0 = mais fácil) e/ou tamanho pedidos; None se não houver.
+        Dentro de cada (nível, letras) o sorteio segue os pesos do indexador
+        (tabela de alias); com a inicial fixada ele é uniforme no balde.
+        """
+        if nivel is None and letras is None:
+            raise ValueError("informe o nível, o tamanho ou os dois")
+        if nivel is None:
+            if not 0 <= letras <= self.letras_max:
+                return None
+            nivel = self._escolher(self._acum_letras[letras], rng)
+        elif letras is None:
+            if not 0 <= nivel < self.niveis:
+                return None
+            letras = self._escolher(self._acum_nivel[nivel], rng)
+        if nivel is None or letras is None:
+            return None
+
+        ini, fim = self.faixa(nivel, letras, inicial)
+        if ini == fim:
+            return None
+        i = rng.randrange(ini, fim)
+        if inicial is None:
+            limiar, alias = ALIAS.unpack_from(self.mm, self.off_amostragem + ALIAS.size * i)
+            if rng.getrandbits(32) >= limiar:
+                i = alias
+        return self.entrada(i)
+
+
+def main():
+    caminho = sys.argv[1] if len(sys.argv) > 1 else CAMINHO_PADRAO
+    indice = IndicePalavras(caminho)
+    print(f"{indice.num_palavras} palavras, até {indice.letras_max} letras, {indice.niveis} níveis")
+    letras = int(sys.argv[2]) if len(sys.argv) > 2 else None
+    for nivel in range(indice.niveis):
+        ini, fim = indice.faixa(nivel, letras)
+        if ini == fim:
+            continue
+        exemplos = ", ".join(indice.sortear(nivel, letras)[1] for _ in range(4))
+        print(f"nível {nivel}: {fim - ini:6} palavras  ex.: {exemplos}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -1,132 +1,84 @@
-# python3 listen_serial.py COM7
+# python3 listen_serial.py COM7       (uma placa; para várias, servidor_multi.py)
 
 import serial
 import random
 import time
 import os
-import wave
 import struct
 import sys
-import unicodedata
-import re
+from array import array
 import speech_recognition as sr
-from pydub import AudioSegment, effects, silence
+import protocolo_serial as proto
+import codec_audio
+import dsp_voz
+from texto import normalize_string
+from indice_palavras import IndicePalavras, CAMINHO_PADRAO as CAMINHO_INDICE
+import distancia
+import verificador
+from soletracao import Soletracao
 
 # Configurações
 porta_serial = sys.argv[1] if len(sys.argv) > 1 else 'COM7'
 baudrate = 115200
-SAMPLE_RATE = 8000
 SAMPLE_WIDTH = 2
+TOLERANCIA = 1  # distância de edição aceita como acerto (p.ex.: s <-> f)
 
 r = sr.Recognizer()
 
-# ---------- Helpers ----------
-def normalize_string(s: str) -> str:
-    """
-    Normaliza uma string:
-    - lowercase
-    - remove acentos (NFKD)
-    - mantém apenas letras a-z
-    - junta sequências de letras separadas (ex: "t e s t e" -> "teste")
-    Retorna a forma *sem espaços* (porque a palavra esperada é única).
-    """
-    if not s:
-        return ""
-    s = s.lower().strip()
-    s = unicodedata.normalize('NFKD', s)
-    s = ''.join(ch for ch in s if not unicodedata.combining(ch))
-    # mantém apenas letras e espaços
-    s = re.sub(r'[^a-z\s]', '', s)
-    # split + juntar sequências de tokens de 1 letra (ex.: "t e s t e" -> "teste")
-    tokens = s.split()
-    merged = []
-    i = 0
-    while i < len(tokens):
-        if len(tokens[i]) == 1:
-            j = i
-            seq = []
-            while j < len(tokens) and len(tokens[j]) == 1:
-                seq.append(tokens[j])
-                j += 1
-            if len(seq) > 1:
-                merged.append(''.join(seq))
-            else:
-                merged.append(seq[0])
-            i = j
-        else:
-            merged.append(tokens[i])
-            i += 1
-    # como estamos lidando com palavras únicas, retornamos sem espaços
-    return ''.join(merged)
-
-def levenshtein(a: str, b: str) -> int:
-    """Distância de Levenshtein (edit distance)."""
-    if a == b:
-        return 0
-    n, m = len(a), len(b)
-    if n == 0:
-        return m
-    if m == 0:
-        return n
-    # matrix (n+1) x (m+1)
-    prev = list(range(m + 1))
-    for i in range(1, n + 1):
-        cur = [i] + [0] * m
-        ai = a[i - 1]
-        for j in range(1, m + 1):
-            cost = 0 if ai == b[j - 1] else 1
-            cur[j] = min(prev[j] + 1,      # deletion
-                         cur[j - 1] + 1,   # insertion
-                         prev[j - 1] + cost)  # substitution
-        prev = cur
-    return prev[m]
-
 # ---------- Áudio / transcrição ----------
-def preprocessar_audio(caminho_entrada):
-    """Remove silêncios, normaliza e resample para 16000 Hz (melhora ASR)."""
-    audio = AudioSegment.from_file(caminho_entrada, format="wav")
-    audio = effects.normalize(audio)
-    audio_chunks = silence.split_on_silence(
-        audio,
-        min_silence_len=700,
-        silence_thresh=audio.dBFS - 14,
-        keep_silence=300
-    )
-    if not audio_chunks:
-        # nada cortado, apenas converte para 16k mono
-        audio = audio.set_frame_rate(16000).set_channels(1)
-        caminho_processado = caminho_entrada.replace(".wav", "_proc.wav")
-        audio.export(caminho_processado, format="wav")
-        return caminho_processado
-
-    audio_final = AudioSegment.silent(duration=200)
-    for chunk in audio_chunks:
-        audio_final += chunk + AudioSegment.silent(duration=200)
-    audio_final = audio_final.set_frame_rate(16000).set_channels(1)
-    caminho_processado = caminho_entrada.replace(".wav", "_proc.wav")
-    audio_final.export(caminho_processado, format="wav")
-    return caminho_processado
-
-def transcrever_fala(caminho_arquivo):
-    """Faz a transcrição com Google Speech e retorna versão normalizada (lower, sem acento)."""
-    caminho_processado = preprocessar_audio(caminho_arquivo)
-    with sr.AudioFile(caminho_processado) as arq_audio:
-        try:
-            r.adjust_for_ambient_noise(arq_audio, duration=0.5)
-            audio = r.record(arq_audio)
-            texto = r.recognize_google(audio, language='pt-BR')
-            print("[ASR] Original:", texto)
-            texto_norm = normalize_string(texto)
-            print("[ASR] Normalizado:", texto_norm)
-            return texto_norm
-        except sr.UnknownValueError:
-            print("[ASR] Incompreensível")
-            return "incompreensivel"
-        except sr.RequestError as e:
-            print(f"[ASR] Erro serviço: {e}")
-            return "erro"
+def transcrever_fala(audio_16k):
+    """
+    Faz a transcrição com Google Speech e retorna versão normalizada (lower, sem acento).
+    audio_16k: já pré-processado por dsp_voz durante a captura, em memória.
+    """
+    audio = sr.AudioData(audio_16k, dsp_voz.TAXA_SAIDA, SAMPLE_WIDTH)
+    try:
+        texto = r.recognize_google(audio, language='pt-BR')
+        print("[ASR] Original:", texto)
+        texto_norm = normalize_string(texto)
+        print("[ASR] Normalizado:", texto_norm)
+        return texto_norm
+    except sr.UnknownValueError:
+        print("[ASR] Incompreensível")
+        return "incompreensivel"
+    except sr.RequestError as e:
+        print(f"[ASR] Erro serviço: {e}")
+        return "erro"
 
 # ---------- Arquivos de palavras ----------
+def abrir_indice():
+    """Índice mapeado (ferramentas/indexar_palavras); None se ainda não foi gerado."""
+    try:
+        return IndicePalavras()
+    except (OSError, ValueError) as e:
+        print(f"[WARN] índice de palavras indisponível ({e}); usando os palavras_N.txt")
+        return None
+
+def abrir_vizinhas():
+    """Busca de palavras próximas sobre o índice (nativa se ferramentas/ foi compilada)."""
+    try:
+        vizinhas = distancia.Vizinhas(CAMINHO_INDICE)
+    except (OSError, ValueError) as e:
+        print(f"[WARN] busca de vizinhas indisponível ({e})")
+        return None
+    if not distancia.NATIVA:
+        print("[WARN] libdistancia não encontrada; busca de vizinhas em Python (lenta)")
+    return vizinhas
+
+def abrir_verificador(caminho=verificador.CAMINHO_PADRAO):
+    """Verificação local (modelo de letras + libverificador); None: só o ASR na nuvem."""
+    try:
+        return verificador.Verificador(caminho)
+    except (OSError, ValueError) as e:
+        print(f"[WARN] verificação local indisponível ({e}); usando só o ASR na nuvem")
+        return None
+
+def abrir_verificador_pico():
+    """Modelo para o codec log-mel da Pico (só características); None se não foi construído."""
+    if not os.path.exists(verificador.CAMINHO_PICO):
+        return None
+    return abrir_verificador(verificador.CAMINHO_PICO)
+
 def carregar_palavras(nivel):
     """
     Carrega lista de palavras do arquivo correspondente ao nível.
@@ -141,56 +93,233 @@ def carregar_palavras(nivel):
     with open(caminho, "r", encoding="utf-8") as f:
         return [linha.strip() for linha in f if linha.strip()]
 
-# ---------- Gravação via serial -> .wav ----------
-def gravar_audio(ser):
+def escolher_palavra(indice, nivel, dificuldade):
+    """
+    (original, normalizada): do índice, sem ler nada por rodada, ou dos arquivos
+    de texto. O nível da Pico dá o tamanho; a dificuldade escolhe o quantil.
+    """
+    if indice is not None:
+        escolhida = indice.sortear(dificuldade, nivel + 4)
+        if escolhida is not None:
+            normalizada, original, _ = escolhida
+            return original, normalizada
+    palavra = random.choice(carregar_palavras(nivel))
+    return palavra, normalize_string(palavra)
+
+# ---------- Captura via serial ----------
+class RodadaCancelada(Exception):
+    """A Pico abandonou a rodada no meio (B segurado)."""
+
+def rodada_cancelada(dec):
+    """
+    A Pico avisou que abandonou a rodada ("cancelar") ou já começou outra
+    ("palavra"/"pedir_palavra"). As linhas ficam na fila: a da rodada nova é
+    tratada pelo laço principal.
+    """
+    return any(l == "cancelar" or l.startswith(("palavra ", "pedir_palavra")) for l in dec.linhas)
+
+def gravar_audio(ser, dec, soletracao=None):
+    """
+    Recebe os quadros de áudio da Pico até o quadro FIM e devolve (áudio, mel):
+    o áudio já pré-processado para o ASR (16 kHz, 16 bits), ou None sem fala.
+    Cada quadro passa pelo dsp_voz assim que chega, então no FIM só falta o
+    corte final. Com a soletração, cada letra também é julgada assim que
+    termina. Com o codec log-mel, a Pico só manda características: mel são
+    os quadros juntos (bytes) e o áudio é None. Levanta RodadaCancelada se a
+    Pico abandonar a rodada antes do FIM.
+    """
     print("[INFO] Aguardando início da gravação pelo botão A...")
     ser.timeout = 0.1
 
-    # aguarda primeiro byte do microfone
+    buffer = array('h')
+    gravando = False
+    formato = codec_audio.PCM8
+    proc = None
+    processadas = 0
+    mel = None
     while True:
-        raw = ser.read()
-        if raw:
-            print("[INFO] Iniciando gravação...")
+        if rodada_cancelada(dec):
+            print("[INFO] Rodada cancelada pela Pico.")
+            raise RodadaCancelada()
+        if not dec.quadros:
+            proto.ler_serial(ser, dec)
+            continue
+        q = dec.quadros.popleft()
+        if q.tipo == proto.INICIO:
+            taxa, formato = struct.unpack_from('<HB', q.payload)
+            print(f"[INFO] Iniciando gravação ({taxa} Hz, formato {formato})...")
+            proc = dsp_voz.ProcessadorVoz(taxa)
+            if formato == codec_audio.LOG_MEL:
+                mel = bytearray()
+                soletracao = None  # a segmentação em letras precisa do áudio
+            elif soletracao:
+                soletracao.iniciar(taxa)
+            gravando = True
+        elif q.tipo == proto.MEL and gravando and mel is not None:
+            mel += q.payload
+        elif q.tipo == proto.AUDIO and gravando:
+            codec_audio.decodificar(formato, q.payload, buffer)
+            # a última amostra fica para o FIM: pode ser só o enchimento do ADPCM
+            proc.empurrar(buffer, processadas, len(buffer) - 1)
+            if soletracao:
+                soletracao.alimentar(buffer, processadas, len(buffer) - 1)
+            processadas = max(processadas, len(buffer) - 1)
+        elif q.tipo == proto.VAD and gravando:
+            evento, bloco, energia, piso = struct.unpack_from('<BIII', q.payload)
+            print(f"[VAD] {proto.VAD_EVENTOS.get(evento, evento)} no bloco {bloco} "
+                  f"(energia={energia}, piso={piso})")
+            if soletracao and evento == proto.VAD_INICIO_FALA:
+                soletracao.segmentador.definir_piso(piso * 256)  # 12 bits -> 16 bits, ao quadrado
+        elif q.tipo == proto.FIM and gravando:
+            total, perdidos = struct.unpack_from('<II', q.payload)
+            if total == 0:
+                print("[INFO] Nenhuma fala detectada.")
+                return None, None
+            print(f"[INFO] Fim da captura. Amostras: {len(buffer)}/{total}, "
+                  f"blocos perdidos na Pico: {perdidos}, quadros perdidos: {dec.quadros_perdidos}")
             break
 
-    buffer = []
-    sem_dados = 0
-    LIMITE_ESPERA = 50  # aprox ~5s de silêncio
+    if mel is not None:
+        print(f"[INFO] {len(mel)} bytes de características log-mel (em vez de áudio)")
+        return None, bytes(mel)
+    proc.empurrar(buffer, processadas)
+    if soletracao:
+        soletracao.alimentar(buffer, processadas)
+        soletracao.finalizar()
+    return proc.finalizar() or None, None
 
-    while True:
-        raw = ser.read()
-        if raw:
-            byte = raw[0]
-            signed = int((byte - 128) * 256)
-            buffer.append(signed)
-            sem_dados = 0
+# ---------- Rodada ----------
+def avaliar_rodada(ser, dec, expected_norm, vizinhas=None, verif=None, verif_pico=None):
+    """
+    Grava o áudio da rodada, julga e devolve o resultado à Pico. Retorna se
+    acertou, ou None se a Pico abandonou a rodada. Com o modelo de letras (verif), a resposta é verificada aqui
+    mesmo e o ASR na nuvem só entra quando o veredito local é incerto. Com o
+    dicionário (vizinhas), uma resposta errada volta como a palavra do
+    dicionário mais próxima do que foi dito. O modelo também julga letra a
+    letra durante a gravação: uma letra errada ou a palavra completa e sem
+    dúvidas já decidem a rodada. Se a Pico só mandou características
+    (log-mel), quem julga é o modelo dela (verif_pico), sem ASR.
+    """
+    # grava áudio enviado pela Pico
+    print("[INFO] Aguardando áudio da Pico...")
+    soletracao = Soletracao(ser, verif, expected_norm) if verif else None
+    try:
+        audio, mel = gravar_audio(ser, dec, soletracao)
+    except RodadaCancelada:
+        return None
+
+    if soletracao and (soletracao.errou or soletracao.completa):
+        # a Pico já mostrou o resultado; a linha só fecha a rodada dos dois lados
+        to_send = expected_norm if soletracao.completa else "".join(soletracao.letras)
+        print(f"[INFO] Decidido letra a letra: '{''.join(soletracao.letras)}'")
+        ser.write((to_send + "\n").encode("utf-8"))
+        return soletracao.completa
+
+    to_send = julgar_resposta(audio, mel, expected_norm, vizinhas, verif, verif_pico)
+    # o julgamento pode levar segundos (ASR): a Pico pode ter abandonado a rodada
+    # nesse meio tempo, e a resposta seria lida como a palavra da rodada seguinte
+    proto.ler_serial(ser, dec)
+    if rodada_cancelada(dec):
+        print("[INFO] Rodada cancelada pela Pico; resposta descartada.")
+        return None
+    ser.write((to_send + "\n").encode("utf-8"))
+    return to_send == expected_norm
+
+def julgar_resposta(audio, mel, expected_norm, vizinhas=None, verif=None, verif_pico=None):
+    """
+    O que responder à Pico pela fala de uma rodada (áudio do dsp_voz ou quadros
+    log-mel): a esperada se aceita, senão o que foi entendido. Veredito local
+    primeiro; o ASR na nuvem só quando ele é incerto.
+    """
+    if mel is not None:
+        if not verif_pico:
+            print("[WARN] a Pico mandou log-mel, mas não há modelo da Pico (verificador.py construir --pico)")
+        veredito = verif_pico.verificar(mel, expected_norm, vizinhas) if verif_pico and mel else None
+    else:
+        veredito = verif.verificar(audio, expected_norm, vizinhas) if verif and audio else None
+    if veredito:
+        print(f"[VERIF] melhor '{veredito.melhor}' (custo {veredito.custo:.2f}, "
+              f"confiança {veredito.confianca:.2f}) em {veredito.ms:.1f} ms")
+    if veredito and veredito.confianca >= verificador.CONFIANCA_MIN:
+        to_send = expected_norm if veredito.aceita else veredito.melhor
+        print(f"[INFO] {'Aceito' if veredito.aceita else 'Não aceito'} localmente. Enviando: '{to_send}'")
+        return to_send
+
+    # transcreve (já normalizado); sem fala não há o que mandar para o ASR
+    if audio:
+        recognized_norm = transcrever_fala(audio)
+    elif mel:
+        recognized_norm = "erro"  # só características: o ASR na nuvem não tem como ajudar
+    else:
+        recognized_norm = "incompreensivel"
+
+    if recognized_norm == "erro" and veredito and veredito.confianca > 0:
+        # sem o serviço, vale o veredito local mesmo incerto
+        to_send = expected_norm if veredito.aceita else veredito.melhor
+        print(f"[INFO] ASR indisponível; veredito local: '{to_send}'")
+    # se incompreensível ou erro, apenas encaminha isso
+    elif recognized_norm in ("incompreensivel", "erro", ""):
+        to_send = recognized_norm
+        print(f"[INFO] Resultado ASR: {to_send}")
+    else:
+        # compara e permite pequenas diferenças (p.ex.: s <-> f)
+        lev = distancia.levenshtein(recognized_norm, expected_norm, k=TOLERANCIA + 1)
+        if lev <= TOLERANCIA:
+            # Aceita pequeno erro: enviamos a palavra correta para a Pico
+            # (assim o main.c fará strstr e reconhecerá como correta).
+            print(f"[INFO] Aceito (lev={lev}). Enviando palavra correta: '{expected_norm}'")
+            to_send = expected_norm
         else:
-            sem_dados += 1
-            if sem_dados >= LIMITE_ESPERA:
-                print("[INFO] Fim da captura detectado.")
-                break
-
-    print(f"[INFO] Captura finalizada. Amostras: {len(buffer)}")
-    caminho_voz = os.path.join(os.path.dirname(os.path.abspath(__file__)), "voz.wav")
-    with wave.open(caminho_voz, "wb") as wf:
-        wf.setnchannels(1)
-        wf.setsampwidth(SAMPLE_WIDTH)
-        wf.setframerate(SAMPLE_RATE)
-        for s in buffer:
-            wf.writeframes(struct.pack('<h', s))
-    return caminho_voz
+            dita = vizinhas.buscar(recognized_norm, k=2, maximo=1) if vizinhas else []
+            # nunca a esperada: a 2 edições dela ainda é erro
+            if dita and dita[0][0] not in (recognized_norm, expected_norm):
+                print(f"[INFO] Não aceito (lev>{TOLERANCIA}). Transcrição '{recognized_norm}' "
+                      f"~ '{dita[0][0]}' (dist {dita[0][1]}) no dicionário")
+                to_send = dita[0][0]
+            else:
+                print(f"[INFO] Não aceito (lev>{TOLERANCIA}). Enviando transcrição: '{recognized_norm}'")
+                to_send = recognized_norm
+    return to_send
+
+def anunciar_indice(ser, indice):
+    """
+    Com o índice de dificuldade, a Pico passa a pedir as palavras ao host
+    (pedir_palavra) em vez de sortear da flash, e a escada adaptativa vale.
+    """
+    if indice:
+        ser.write(f"indice {indice.niveis}\n".encode("ascii"))
+
+def ajustar_dificuldade(indice, dificuldade, acertou):
+    """Escada adaptativa sobre os níveis do índice: acerto sobe, erro desce."""
+    if not indice or acertou is None:
+        return dificuldade
+    dificuldade = min(dificuldade + 1, indice.niveis - 1) if acertou else max(dificuldade - 1, 0)
+    print(f"[INFO] Dificuldade {dificuldade}/{indice.niveis - 1}")
+    return dificuldade
 
 # ---------- Main ----------
 def main():
     ser = serial.Serial(porta_serial, baudrate, timeout=1)
     time.sleep(2)
     print("[INFO] Aguardando requisição da Pico...")
+    dec = proto.DecodificadorSerial()
+    indice = abrir_indice()
+    vizinhas = abrir_vizinhas() if indice else None
+    verif = abrir_verificador()
+    verif_pico = abrir_verificador_pico()
+    # Escada adaptativa sobre os níveis de dificuldade do índice: acerto sobe, erro desce
+    dificuldade = indice.niveis // 2 if indice else 0
+    anunciar_indice(ser, indice)
 
     try:
         while True:
-            if ser.in_waiting:
-                linha = ser.readline().decode("utf-8").strip()
-                if linha.startswith("pedir_palavra"):
+            ser.timeout = 1
+            proto.ler_serial(ser, dec)
+            while dec.linhas:
+                linha = dec.linhas.popleft()
+                if linha.startswith("reacao_ms"):
+                    print(f"[INFO] Tempo de reação: {linha.split()[-1]} ms")
+                elif linha.startswith("pedir_palavra"):
                     partes = linha.split()
                     nivel = 1
                     if len(partes) > 1:
@@ -199,9 +328,7 @@ def main():
                         except ValueError:
                             pass
 
-                    palavras = carregar_palavras(nivel)
-                    palavra = random.choice(palavras)
-                    expected_norm = normalize_string(palavra)
+                    palavra, expected_norm = escolher_palavra(indice, nivel, dificuldade)
 
                     # Envia a palavra NORMALIZADA — assim o buffer na Pico fica na mesma forma
                     # (lowercase, sem acentos). Se você preferir mostrar ao usuário a palavra com
@@ -210,30 +337,18 @@ def main():
                     print(f"[INFO] Nível {nivel} | palavra escolhida: '{palavra}' -> '{expected_norm}'")
                     ser.write((expected_norm + "\n").encode("utf-8"))
 
-                    # grava áudio enviado pela Pico
-                    print("[INFO] Aguardando áudio da Pico...")
-                    caminho = gravar_audio(ser)
-
-                    # transcreve (já normalizado)
-                    recognized_norm = transcrever_fala(caminho)
-
-                    # se incompreensível ou erro, apenas encaminha isso
-                    if recognized_norm in ("incompreensivel", "erro", ""):
-                        to_send = recognized_norm
-                        print(f"[INFO] Resultado ASR: {to_send}")
-                    else:
-                        # compara e permite pequenas diferenças (p.ex.: s <-> f)
-                        lev = levenshtein(recognized_norm, expected_norm)
-                        if recognized_norm == expected_norm or lev <= 1:
-                            # Aceita pequeno erro: enviamos a palavra correta para a Pico
-                            # (assim o main.c fará strstr e reconhecerá como correta).
-                            print(f"[INFO] Aceito (lev={lev}). Enviando palavra correta: '{expected_norm}'")
-                            to_send = expected_norm
-                        else:
-                            print(f"[INFO] Não aceito (lev={lev}). Enviando transcrição: '{recognized_norm}'")
-                            to_send = recognized_norm
-
-                    ser.write((to_send + "\n").encode("utf-8"))
+                    acertou = avaliar_rodada(ser, dec, expected_norm, vizinhas, verif, verif_pico)
+                    dificuldade = ajustar_dificuldade(indice, dificuldade, acertou)
+                elif linha.startswith("palavra "):
+                    # A Pico sorteou a palavra do próprio dicionário: "palavra <nivel> <palavra>".
+                    # Com o índice, ela não sabia dele (reiniciou depois do anúncio): anuncia de
+                    # novo, e a rodada já conta para a escada.
+                    partes = linha.split()
+                    if len(partes) == 3:
+                        print(f"[INFO] Nível {partes[1]} | palavra sorteada na Pico: '{partes[2]}'")
+                        anunciar_indice(ser, indice)
+                        acertou = avaliar_rodada(ser, dec, partes[2], vizinhas, verif, verif_pico)
+                        dificuldade = ajustar_dificuldade(indice, dificuldade, acertou)
 
     except KeyboardInterrupt:
         print("Encerrando...")
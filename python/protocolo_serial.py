@@ -0,0 +1,129 @@
+# Decodificador do protocolo de quadros usado pela Pico (ver comunicacao/protocolo_serial.h)
+#
+#   0xA5 0x5A | tipo (1) | seq (2, LE) | len (2, LE) | payload | crc16 (2, LE)
+#
+# Tudo o que não está dentro de um quadro é tratado como linha de texto.
+
+import struct
+from collections import deque
+
+SYNC = b"\xA5\x5A"
+HEADER_LEN = 7
+CRC_LEN = 2
+MAX_PAYLOAD = 512
+
+# Tipos de quadro
+INICIO = 0x01
+AUDIO = 0x02
+FIM = 0x03
+VAD = 0x04
+RASTREIO = 0x05
+ESTATISTICAS = 0x06
+MEL = 0x07  # quadros log-mel da Pico (codec_audio.LOG_MEL), verificador.BANDAS_PICO bytes cada
+
+# Eventos do detector de voz (quadro VAD)
+VAD_INICIO_FALA = 1
+VAD_EVENTOS = {VAD_INICIO_FALA: "inicio_fala", 3: "fim_fala", 4: "sem_fala"}
+
+
+def _tabela_crc16():
+    tabela = []
+    for i in range(256):
+        crc = i << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+        tabela.append(crc & 0xFFFF)
+    return tabela
+
+
+_CRC16_TAB = _tabela_crc16()
+
+
+def crc16(dados: bytes, crc: int = 0xFFFF) -> int:
+    """CRC-16/CCITT (poly 0x1021, init 0xFFFF), igual ao proto_crc16 da Pico."""
+    for b in dados:
+        crc = ((crc << 8) & 0xFFFF) ^ _CRC16_TAB[(crc >> 8) ^ b]
+    return crc
+
+
+class Quadro:
+    __slots__ = ("tipo", "seq", "payload")
+
+    def __init__(self, tipo, seq, payload):
+        self.tipo = tipo
+        self.seq = seq
+        self.payload = payload
+
+    def __repr__(self):
+        return f"Quadro(tipo=0x{self.tipo:02X}, seq={self.seq}, len={len(self.payload)})"
+
+
+class DecodificadorSerial:
+    """
+    Separa o fluxo da serial em linhas de texto e quadros binários.
+    Alimente com bytes (em blocos de qualquer tamanho) e consuma
+    `linhas` e `quadros`, que são filas independentes.
+    """
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.texto = bytearray()
+        self.linhas = deque()
+        self.quadros = deque()
+        self.seq_esperada = None
+        self.quadros_perdidos = 0
+        self.erros_crc = 0
+
+    def alimentar(self, dados: bytes):
+        self.buf += dados
+        while self.buf:
+            i = self.buf.find(SYNC[0])
+            if i < 0:
+                self._texto(self.buf)
+                self.buf.clear()
+                return
+            if i > 0:
+                self._texto(self.buf[:i])
+                del self.buf[:i]
+            if len(self.buf) < 2:
+                return
+            if self.buf[1] != SYNC[1]:
+                # 0xA5 solto (lixo): descarta e continua
+                del self.buf[:1]
+                continue
+            if len(self.buf) < HEADER_LEN:
+                return
+            tipo, seq, n = struct.unpack_from("<BHH", self.buf, 2)
+            if n > MAX_PAYLOAD:
+                del self.buf[:1]
+                continue
+            total = HEADER_LEN + n + CRC_LEN
+            if len(self.buf) < total:
+                return
+            (crc,) = struct.unpack_from("<H", self.buf, HEADER_LEN + n)
+            if crc16(self.buf[2:HEADER_LEN + n]) != crc:
+                self.erros_crc += 1
+                del self.buf[:1]
+                continue
+            if self.seq_esperada is not None and seq != self.seq_esperada:
+                self.quadros_perdidos += (seq - self.seq_esperada) & 0xFFFF
+            self.seq_esperada = (seq + 1) & 0xFFFF
+            self.quadros.append(Quadro(tipo, seq, bytes(self.buf[HEADER_LEN:HEADER_LEN + n])))
+            del self.buf[:total]
+
+    def _texto(self, dados):
+        for b in dados:
+            if b in (0x0A, 0x0D):
+                if self.texto:
+                    self.linhas.append(self.texto.decode("utf-8", errors="replace").strip())
+                    self.texto.clear()
+            else:
+                self.texto.append(b)
+
+
+def ler_serial(ser, dec: DecodificadorSerial):
+    """Lê tudo o que estiver disponível de uma vez (ou espera até ser.timeout por 1 byte)."""
+    dados = ser.read(ser.in_waiting or 1)
+    if dados:
+        dec.alimentar(dados)
+    return len(dados)
@@ -0,0 +1,162 @@
+# Decodifica o rastro da Pico (rastreio/rastreio.h) numa linha do tempo no
+# formato do Chrome (abra em chrome://tracing ou ui.perfetto.dev).
+#
+#   python3 rastreio.py COM7 -o rastro.json        # pede "stats" e "trace" à placa
+#   python3 rastreio.py serial.bin -o rastro.json  # gravação da serial (ex.: sim --serial)
+
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+
+import protocolo_serial as proto
+
+CABECALHO = struct.Struct("<2sBBIHHI")
+REGISTRO = struct.Struct("<IBBH")
+
+INICIO, FIM, INSTANTE = 0, 1, 2
+
+TIPOS = {1: "render", 2: "npWrite", 3: "beep", 4: "bloco_adc", 5: "codec",
+         6: "serial_tx", 7: "serial_rx", 8: "evento", 9: "transicao"}
+
+# Mesma ordem de rastreio_contadores_t
+CONTADORES = ["registros_core0", "registros_core1", "descartados_dump", "blocos_perdidos",
+              "slots_descartados", "usb_quadros", "usb_bytes", "usb_bloqueios",
+              "usb_bloqueio_us", "linhas_rx"]
+
+# Nomes do firmware (main.c e jogo/eventos.h), para as transições ficarem legíveis
+ESTADOS = ["esperando", "pedindo_palavra", "contagem", "aguardando_a",
+           "gravando", "analisando", "mostrando_erro", "liberando_captura"]
+EVENTOS = {1: "botao_a", 2: "botao_b", 3: "botao_b_longo", 4: "linha_serial",
+           5: "temporizador", 6: "captura_fim", 7: "captura_parada"}
+QUADROS = {proto.INICIO: "inicio", proto.AUDIO: "audio", proto.FIM: "fim", proto.VAD: "vad",
+           proto.RASTREIO: "rastreio", proto.ESTATISTICAS: "estatisticas", proto.MEL: "mel"}
+
+TID_I2C = 2  # o render termina na IRQ do DMA; fica numa trilha própria
+
+
+def nome_estado(n):
+    return ESTADOS[n] if n < len(ESTADOS) else str(n)
+
+
+def decodificar_despejo(blob):
+    magic, versao, nucleos, agora, n0, n1, _ = CABECALHO.unpack_from(blob)
+    if magic != b"RT" or versao != 1:
+        raise ValueError("despejo de rastro inválido")
+    registros = []
+    pos = CABECALHO.size
+    for core, n in enumerate((n0, n1)):
+        for _ in range(n):
+            t, tipo, fase, arg = REGISTRO.unpack_from(blob, pos)
+            pos += REGISTRO.size
+            # time_us_32 dá a volta a cada ~71 min: conta para trás a partir do despejo
+            registros.append((agora - ((agora - t) & 0xFFFFFFFF), core, tipo, fase, arg))
+    registros.sort(key=lambda r: r[0])  # estável: mantém a ordem de cada anel
+    return agora, registros
+
+
+def para_chrome(registros, contadores=None, agora=0):
+    eventos = [
+        {"name": "process_name", "ph": "M", "pid": 0, "args": {"name": "Pico"}},
+        {"name": "thread_name", "ph": "M", "pid": 0, "tid": 0, "args": {"name": "core0"}},
+        {"name": "thread_name", "ph": "M", "pid": 0, "tid": 1, "args": {"name": "core1"}},
+        {"name": "thread_name", "ph": "M", "pid": 0, "tid": TID_I2C, "args": {"name": "I2C (DMA)"}},
+    ]
+    abertos = {}
+
+    for t, core, tipo, fase, arg in registros:
+        nome = TIPOS.get(tipo, f"tipo_{tipo}")
+        tid = TID_I2C if nome == "render" else core
+        args = {"arg": arg}
+        if nome == "serial_tx":
+            args = {"quadro": QUADROS.get(arg, arg)}
+        elif nome == "evento":
+            nome = "evento " + EVENTOS.get(arg, str(arg))
+        elif nome == "transicao":
+            nome = f"{nome_estado(arg >> 8)} -> {nome_estado(arg & 0xFF)}"
+
+        if fase == INICIO:
+            abertos.setdefault((tid, tipo), []).append((t, args))
+        elif fase == FIM:
+            pilha = abertos.get((tid, tipo))
+            if not pilha:
+                continue  # o início já foi sobrescrito no anel
+            inicio, args = pilha.pop()
+            if nome == "render" and arg == 0xFFFF:
+                args["abortado"] = True
+            eventos.append({"name": nome, "ph": "X", "pid": 0, "tid": tid, "ts": inicio,
+                            "dur": t - inicio, "args": args})
+        else:
+            eventos.append({"name": nome, "ph": "i", "s": "t", "pid": 0, "tid": tid, "ts": t, "args": args})
+
+    if contadores:
+        eventos.append({"name": "contadores", "ph": "C", "pid": 0, "ts": agora, "args": contadores})
+    return {"traceEvents": eventos, "displayTimeUnit": "ms"}
+
+
+def ler_quadros(origem, timeout):
+    """Junta os payloads de PROTO_RASTREIO e o último PROTO_ESTATISTICAS."""
+    dec = proto.DecodificadorSerial()
+    blob = bytearray()
+    stats = None
+
+    def consumir():
+        nonlocal stats
+        while dec.quadros:
+            q = dec.quadros.popleft()
+            if q.tipo == proto.RASTREIO:
+                if q.payload[:2] == b"RT" and (not blob or completo()):
+                    blob.clear()  # um despejo novo começa
+                blob.extend(q.payload)
+            elif q.tipo == proto.ESTATISTICAS:
+                stats = dict(zip(CONTADORES, struct.unpack_from(f"<{len(q.payload) // 4}I", q.payload)))
+        dec.linhas.clear()
+
+    def completo():
+        if len(blob) < CABECALHO.size:
+            return False
+        _, _, _, _, n0, n1, _ = CABECALHO.unpack_from(blob)
+        return len(blob) >= CABECALHO.size + (n0 + n1) * REGISTRO.size
+
+    if os.path.isfile(origem):
+        with open(origem, "rb") as f:
+            dec.alimentar(f.read())
+        consumir()
+    else:
+        import serial
+        with serial.Serial(origem, 115200, timeout=0.1) as ser:
+            ser.write(b"stats\ntrace\n")
+            limite = time.monotonic() + timeout
+            while time.monotonic() < limite and not completo():
+                proto.ler_serial(ser, dec)
+                consumir()
+
+    return (bytes(blob) if completo() else None), stats
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Rastro da Pico para o formato de trace do Chrome")
+    ap.add_argument("origem", help="porta serial ou gravação da serial")
+    ap.add_argument("-o", "--saida", default="rastro.json")
+    ap.add_argument("--timeout", type=float, default=10.0)
+    args = ap.parse_args()
+
+    blob, stats = ler_quadros(args.origem, args.timeout)
+    if stats:
+        for nome, valor in stats.items():
+            print(f"{nome:20} {valor}")
+    if blob is None:
+        print("[ERRO] nenhum despejo de rastro completo encontrado", file=sys.stderr)
+        return 1
+
+    agora, registros = decodificar_despejo(blob)
+    with open(args.saida, "w", encoding="utf-8") as f:
+        json.dump(para_chrome(registros, stats, agora), f)
+    print(f"{len(registros)} registros -> {args.saida}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
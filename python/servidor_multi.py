@@ -0,0 +1,372 @@
+# Servidor de sala de aula: atende várias Picos ao mesmo tempo, uma porta
+# serial por placa, num processo só.
+#
+#   python3 servidor_multi.py /dev/ttyACM0 /dev/ttyACM1 ... [-t 4] [-f 8]
+#
+# Um laço de eventos (selectors: epoll no Linux) lê cada porta em blocos, com
+# o que houver disponível, e mantém o estado da rodada de cada placa. Nada de
+# pesado roda no laço: no FIM da captura, os quadros da rodada vão inteiros
+# para um processo de um pool (decodificação, dsp_voz, verificador e, se
+# preciso, o ASR na nuvem) e a resposta volta para a porta quando ele termina.
+# Enquanto isso, as outras placas continuam sendo lidas normalmente.
+#
+# Contrapressão: no máximo -f rodadas no pool de uma vez. Com o pool cheio,
+# os julgamentos seguintes esperam a vez e os pedidos de palavra nova
+# (pedir_palavra) ficam adiados: a Pico espera em ESTADO_PEDINDO_PALAVRA, sem
+# perder nada, e quem já está gravando continua sendo lido. Os pedidos só
+# existem quando a Pico pede a palavra ao host, o que ela faz quando o
+# servidor tem o índice de dificuldade (ferramentas/indexar_palavras) e o
+# anuncia; sem o índice a Pico sorteia da flash e manda "palavra", e aí não há
+# o que adiar: só os julgamentos esperam na fila.
+#
+# Diferenças do listen_serial.py: sem o julgamento letra a letra durante a
+# gravação (ele precisaria de um trabalho no pool por letra); a palavra é
+# julgada inteira no FIM. Só POSIX (a porta precisa de um fileno() para o
+# selector).
+
+import argparse
+import os
+import selectors
+import socket
+import struct
+import time
+from array import array
+from collections import deque
+import multiprocessing
+from concurrent.futures import ProcessPoolExecutor
+
+import serial
+
+import codec_audio
+import dsp_voz
+import listen_serial
+import protocolo_serial as proto
+
+METRICAS_S = 60  # intervalo do relatório de latências
+
+# Estados da sessão de cada placa
+OCIOSA = "ociosa"          # esperando pedir_palavra ou palavra
+ADIADA = "adiada"          # pedir_palavra recebido, esperando vaga no pool
+PALAVRA = "palavra"        # palavra definida, esperando o INICIO da captura
+GRAVANDO = "gravando"      # recebendo os quadros da fala
+NA_FILA = "na_fila"        # captura completa, esperando vaga no pool
+JULGANDO = "julgando"      # no pool
+
+
+# ---------- Trabalhadores (outros processos) ----------
+_vizinhas = _verif = _verif_pico = None
+
+
+def _iniciar_trabalhador():
+    """Cada processo abre os próprios modelos (o índice é mapeado, então é compartilhado)."""
+    global _vizinhas, _verif, _verif_pico
+    _vizinhas = listen_serial.abrir_vizinhas() if os.path.exists(listen_serial.CAMINHO_INDICE) else None
+    _verif = listen_serial.abrir_verificador()
+    _verif_pico = listen_serial.abrir_verificador_pico()
+
+
+def julgar(esperada, taxa, formato, payloads, total):
+    """
+    Julga uma rodada a partir dos payloads dos quadros AUDIO (ou MEL) como
+    chegaram. Retorna (resposta, início, fim) em time.monotonic(), que é o
+    mesmo relógio em todos os processos.
+    """
+    inicio = time.monotonic()
+    if formato == codec_audio.LOG_MEL:
+        audio, mel = None, b"".join(payloads)
+    else:
+        amostras = array("h")
+        for p in payloads:
+            codec_audio.decodificar(formato, p, amostras)
+        audio, mel = None, None
+        if total:
+            proc = dsp_voz.ProcessadorVoz(taxa)
+            proc.empurrar(amostras)
+            audio = proc.finalizar() or None
+    resposta = listen_serial.julgar_resposta(audio, mel, esperada, _vizinhas, _verif, _verif_pico)
+    return resposta, inicio, time.monotonic()
+
+
+# ---------- Sessões (laço de eventos) ----------
+class Latencias:
+    """Amostras de latência em ms desde o último relatório."""
+
+    def __init__(self):
+        self.valores = []
+
+    def registrar(self, ms):
+        self.valores.append(ms)
+
+    def resumo(self):
+        v = sorted(self.valores)
+        if not v:
+            return "-"
+        return f"p50 {v[len(v) // 2]:.0f} p95 {v[len(v) * 95 // 100]:.0f} max {v[-1]:.0f} ms"
+
+
+class Sessao:
+    """Uma placa: a porta, o decodificador do protocolo e a rodada em andamento."""
+
+    def __init__(self, porta, ser, dificuldade):
+        self.porta = porta
+        self.ser = ser
+        self.dec = proto.DecodificadorSerial()
+        self.estado = OCIOSA
+        self.dificuldade = dificuldade
+        self.rodada = 0         # muda a cada palavra: resultados de rodadas abandonadas são descartados
+        self.nivel = 1
+        self.esperada = None
+        self.taxa = self.formato = 0
+        self.payloads = []
+        self.total = 0
+        self.fim_captura = 0.0
+        # métricas
+        self.rodadas = self.acertos = 0
+        self.blocos_perdidos = 0
+        self.fila_ms = Latencias()       # FIM -> um trabalhador pegou a rodada
+        self.trabalho_ms = Latencias()   # dentro do trabalhador
+        self.resposta_ms = Latencias()   # FIM -> resposta escrita na porta
+
+    def escrever(self, linha):
+        self.ser.write((linha + "\n").encode("utf-8"))
+
+    def log(self, msg):
+        print(f"[{self.porta}] {msg}")
+
+
+class Servidor:
+    def __init__(self, portas, trabalhadores, fila):
+        self.indice = listen_serial.abrir_indice()
+        self.limite = fila
+        # Os processos só nascem no primeiro submit, com as portas já abertas: com
+        # fork, cada um herdaria as portas, o epoll e o socketpair (e uma porta
+        # fechada em _desconectar continuaria aberta neles). O forkserver cria os
+        # processos a partir de um processo limpo, sem esses descritores.
+        self.pool = ProcessPoolExecutor(trabalhadores, mp_context=multiprocessing.get_context("forkserver"),
+                                        initializer=_iniciar_trabalhador)
+        self.em_voo = 0
+        self.na_fila = deque()      # sessões NA_FILA, em ordem de chegada
+        self.adiadas = deque()      # sessões ADIADA, em ordem de chegada
+        self.prontos = deque()      # (sessão, rodada, future) concluídos, vindos da thread do pool
+        self.sel = selectors.DefaultSelector()
+        # o pool avisa o laço por um socketpair: o selector acorda quando um trabalho termina
+        self.aviso_r, self.aviso_w = socket.socketpair()
+        self.aviso_r.setblocking(False)
+        self.sel.register(self.aviso_r, selectors.EVENT_READ, None)
+        self.sessoes = []
+        dificuldade = self.indice.niveis // 2 if self.indice else 0
+        for porta in portas:
+            ser = serial.Serial(porta, listen_serial.baudrate, timeout=0, write_timeout=1)
+            s = Sessao(porta, ser, dificuldade)
+            self.sel.register(ser.fileno(), selectors.EVENT_READ, s)
+            self.sessoes.append(s)
+            s.log("aberta")
+            self._anunciar_indice(s)
+
+    # -- laço --
+    def rodar(self):
+        proximo_relatorio = time.monotonic() + METRICAS_S
+        while self.sessoes:
+            for chave, _ in self.sel.select(timeout=1.0):
+                if chave.data is None:
+                    self._concluidos()
+                else:
+                    self._ler(chave.data)
+            if time.monotonic() >= proximo_relatorio:
+                self.relatar()
+                proximo_relatorio = time.monotonic() + METRICAS_S
+
+    def fechar(self):
+        self.relatar()
+        for s in list(self.sessoes):
+            self._desconectar(s)
+        self.pool.shutdown(cancel_futures=True)  # espera só os que já estão rodando
+
+    def _ler(self, s):
+        try:
+            dados = s.ser.read(s.ser.in_waiting or 1)
+        except OSError as e:  # SerialException é um OSError; in_waiting levanta o do ioctl
+            s.log(f"erro de leitura ({e})")
+            self._desconectar(s)
+            return
+        if not dados:
+            return
+        s.dec.alimentar(dados)
+        # quadros antes das linhas: um FIM e o pedido da rodada seguinte podem vir
+        # no mesmo bloco; já a palavra e o INICIO têm a contagem da Pico entre eles
+        while s.dec.quadros:
+            self._quadro(s, s.dec.quadros.popleft())
+        while s.dec.linhas:
+            self._linha(s, s.dec.linhas.popleft())
+
+    def _desconectar(self, s):
+        if s not in self.sessoes:
+            return
+        self.sel.unregister(s.ser.fileno())
+        s.ser.close()
+        self.sessoes.remove(s)
+        for fila in (self.na_fila, self.adiadas):
+            if s in fila:
+                fila.remove(s)
+        s.log("fechada")
+
+    def _escrever(self, s, linha):
+        if s not in self.sessoes:
+            return
+        try:
+            s.escrever(linha)
+        except OSError as e:
+            s.log(f"erro de escrita ({e})")
+            self._desconectar(s)
+
+    # -- máquina de estados de cada sessão --
+    def _abandonar(self, s):
+        """A Pico cancelou a rodada (B longo) ou pediu outra palavra sem terminá-la."""
+        if s.estado == NA_FILA:
+            self.na_fila.remove(s)
+        elif s.estado == ADIADA:
+            self.adiadas.remove(s)
+        elif s.estado in (PALAVRA, GRAVANDO, JULGANDO):
+            s.log(f"rodada '{s.esperada}' abandonada")
+        s.rodada += 1
+        s.payloads = []
+        s.estado = OCIOSA
+
+    def _linha(self, s, linha):
+        if linha.startswith("reacao_ms"):
+            s.log(f"tempo de reação: {linha.split()[-1]} ms")
+        elif linha == "cancelar":
+            self._abandonar(s)  # B segurado na Pico
+        elif linha.startswith("pedir_palavra"):
+            self._abandonar(s)
+            partes = linha.split()
+            try:
+                s.nivel = int(partes[1]) if len(partes) > 1 else 1
+            except ValueError:
+                s.nivel = 1
+            if self._cheio():
+                s.estado = ADIADA
+                self.adiadas.append(s)
+                s.log(f"pool cheio ({self.em_voo}/{self.limite}); pedido de palavra adiado")
+            else:
+                self._mandar_palavra(s)
+        elif linha.startswith("palavra "):
+            # a Pico sorteou a palavra do próprio dicionário: "palavra <nivel> <palavra>"
+            partes = linha.split()
+            if len(partes) == 3:
+                self._abandonar(s)
+                s.log(f"nível {partes[1]} | palavra sorteada na Pico: '{partes[2]}'")
+                self._anunciar_indice(s)  # a Pico reiniciou depois do anúncio
+                s.esperada = partes[2]
+                s.estado = PALAVRA
+
+    def _anunciar_indice(self, s):
+        """Com o índice, a Pico pede as palavras (e a escada adaptativa vale); ver listen_serial."""
+        if self.indice:
+            self._escrever(s, f"indice {self.indice.niveis}")
+
+    def _mandar_palavra(self, s):
+        palavra, s.esperada = listen_serial.escolher_palavra(self.indice, s.nivel, s.dificuldade)
+        s.log(f"nível {s.nivel} | palavra escolhida: '{palavra}' -> '{s.esperada}'")
+        s.estado = PALAVRA
+        self._escrever(s, s.esperada)
+
+    def _quadro(self, s, q):
+        if q.tipo == proto.INICIO and s.estado == PALAVRA:
+            s.taxa, s.formato = struct.unpack_from("<HB", q.payload)
+            s.payloads = []
+            s.estado = GRAVANDO
+        elif q.tipo in (proto.AUDIO, proto.MEL) and s.estado == GRAVANDO:
+            s.payloads.append(q.payload)
+        elif q.tipo == proto.FIM and s.estado == GRAVANDO:
+            s.total, perdidos = struct.unpack_from("<II", q.payload)
+            s.blocos_perdidos += perdidos
+            s.fim_captura = time.monotonic()
+            s.estado = NA_FILA
+            self.na_fila.append(s)
+            self._despachar()
+
+    # -- pool --
+    def _cheio(self):
+        return self.em_voo >= self.limite or bool(self.na_fila)
+
+    def _despachar(self):
+        """Manda as rodadas que esperam enquanto houver vaga; depois, as palavras adiadas."""
+        while self.na_fila and self.em_voo < self.limite:
+            s = self.na_fila.popleft()
+            s.estado = JULGANDO
+            self.em_voo += 1
+            f = self.pool.submit(julgar, s.esperada, s.taxa, s.formato, s.payloads, s.total)
+            s.payloads = []
+            rodada = s.rodada
+            f.add_done_callback(lambda f, s=s, rodada=rodada: self._avisar(s, rodada, f))
+        while self.adiadas and not self._cheio():
+            self._mandar_palavra(self.adiadas.popleft())
+
+    def _avisar(self, s, rodada, f):
+        # thread do pool: só enfileira e acorda o laço
+        self.prontos.append((s, rodada, f))
+        self.aviso_w.send(b"\0")
+
+    def _concluidos(self):
+        try:
+            self.aviso_r.recv(4096)
+        except BlockingIOError:
+            pass
+        while self.prontos:
+            s, rodada, f = self.prontos.popleft()
+            self.em_voo -= 1
+            if s not in self.sessoes or rodada != s.rodada:
+                continue  # placa desconectada ou rodada abandonada
+            try:
+                resposta, inicio, fim = f.result()
+            except Exception as e:
+                s.log(f"erro no julgamento ({e!r})")
+                resposta, inicio, fim = "erro", s.fim_captura, time.monotonic()
+            self._escrever(s, resposta)
+            agora = time.monotonic()
+            acertou = resposta == s.esperada
+            s.rodadas += 1
+            s.acertos += acertou
+            s.fila_ms.registrar((inicio - s.fim_captura) * 1000)
+            s.trabalho_ms.registrar((fim - inicio) * 1000)
+            s.resposta_ms.registrar((agora - s.fim_captura) * 1000)
+            if self.indice:
+                n = self.indice.niveis - 1
+                s.dificuldade = min(s.dificuldade + 1, n) if acertou else max(s.dificuldade - 1, 0)
+            s.log(f"'{s.esperada}' -> '{resposta}' ({'acerto' if acertou else 'erro'}) "
+                  f"em {(agora - s.fim_captura) * 1000:.0f} ms")
+            s.estado = OCIOSA
+        self._despachar()
+
+    def relatar(self):
+        """Uma linha por placa: latência desde o FIM (fila, trabalho, total) e perdas."""
+        print(f"[METRICAS] pool {self.em_voo}/{self.limite}, {len(self.na_fila)} na fila, "
+              f"{len(self.adiadas)} pedidos adiados")
+        for s in self.sessoes:
+            print(f"[METRICAS] {s.porta}: {s.rodadas} rodadas, {s.acertos} acertos | "
+                  f"fila {s.fila_ms.resumo()} | trabalho {s.trabalho_ms.resumo()} | "
+                  f"resposta {s.resposta_ms.resumo()} | quadros perdidos {s.dec.quadros_perdidos}, "
+                  f"erros crc {s.dec.erros_crc}, blocos perdidos na Pico {s.blocos_perdidos}")
+            s.fila_ms, s.trabalho_ms, s.resposta_ms = Latencias(), Latencias(), Latencias()
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Atende várias Picos ao mesmo tempo")
+    ap.add_argument("portas", nargs="+", help="portas seriais, uma por placa")
+    ap.add_argument("-t", "--trabalhadores", type=int, default=os.cpu_count(),
+                    help="processos de julgamento (padrão: um por núcleo)")
+    ap.add_argument("-f", "--fila", type=int, default=None,
+                    help="rodadas no pool de uma vez (padrão: 2 por trabalhador)")
+    args = ap.parse_args()
+    servidor = Servidor(args.portas, args.trabalhadores, args.fila or 2 * args.trabalhadores)
+    try:
+        servidor.rodar()
+    except KeyboardInterrupt:
+        print("Encerrando...")
+    finally:
+        servidor.fechar()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,188 @@
+# Soletração letra a letra: enquanto a Pico ainda está gravando, o áudio é
+# cortado em letras faladas (pausas curtas entre elas), cada letra é
+# classificada pelo verificador local contra as 26 letras e o veredito volta
+# na hora para a Pico como "letra <posição> <letra>" ("?" se incerta). A Pico
+# mostra o progresso e encerra a rodada na primeira letra errada.
+#
+#   python3 soletracao.py ../dataset/letras.mdl fala.wav [esperada]   # segmenta um .wav
+
+import sys
+from array import array
+
+import dsp_voz
+import verificador
+
+BLOCO_MS = 10
+LIMIAR = 3.0            # energia de fala em relação ao piso (como o VAD da Pico, limiar_q4 = 48)
+PISO_MINIMO = 256.0     # VAD_PISO_MINIMO da Pico em amostras de 16 bits: 1 << 8
+PAUSA_MS = 150          # silêncio que fecha uma letra (oclusivas dentro de uma letra são mais curtas)
+LETRA_MIN_MS = 100      # menos que isso é estalo, não letra
+LETRA_MAX_MS = 1200     # letra que não termina é cortada aqui
+MARGEM_MS = 30          # áudio mantido antes e depois de cada letra
+CONFIANCA_LETRA = 0.8   # abaixo disso a letra vai como "?" e não encerra a rodada
+
+
+class SegmentadorLetras:
+    """
+    Corta um fluxo de amostras de 16 bits em trechos de fala separados por
+    pausas. Energia por bloco de 10 ms sem a média do bloco (o DC do microfone)
+    e piso de ruído adaptativo como o de microfone/vad.c: desce rápido, sobe
+    devagar, só fora da fala. O piso medido pela Pico antes do início da fala
+    (quadro VAD) pode ser dado por definir_piso().
+    """
+
+    def __init__(self, taxa):
+        self.taxa = taxa
+        self.bloco = taxa * BLOCO_MS // 1000
+        self.margem = taxa * MARGEM_MS // 1000
+        self.piso = None
+        self.pendente = array("h")   # amostras que ainda não fecharam um bloco
+        self.historico = array("h")  # desde o começo do trecho atual (ou a margem antes dele)
+        self.em_fala = False
+        self.blocos_fala = 0
+        self.blocos_pausa = 0
+
+    def definir_piso(self, piso):
+        self.piso = max(float(piso), PISO_MINIMO)
+
+    def _energia(self, bloco):
+        media = sum(bloco) / len(bloco)
+        return sum((x - media) ** 2 for x in bloco) / len(bloco)
+
+    def _bloco(self, bloco):
+        """Processa um bloco; retorna o trecho que ele fechou, se algum."""
+        e = self._energia(bloco)
+        if self.piso is None:
+            self.piso = max(e, PISO_MINIMO)
+        ativo = e > self.piso * LIMIAR
+        self.historico.extend(bloco)
+
+        if not self.em_fala:
+            if ativo:
+                self.em_fala = True
+                self.blocos_fala, self.blocos_pausa = 1, 0
+                # começa com a margem antes da fala
+                del self.historico[:max(0, len(self.historico) - len(bloco) - self.margem)]
+                return None
+            if e < self.piso:
+                self.piso -= (self.piso - e) / 4
+            else:
+                self.piso += (e - self.piso) / 16
+            self.piso = max(self.piso, PISO_MINIMO)
+            del self.historico[:max(0, len(self.historico) - self.margem)]
+            return None
+
+        if ativo:
+            self.blocos_fala += 1 + self.blocos_pausa  # pausas curtas contam como parte da letra
+            self.blocos_pausa = 0
+        else:
+            self.blocos_pausa += 1
+        fechou = self.blocos_pausa * BLOCO_MS >= PAUSA_MS
+        if not fechou and (self.blocos_fala + self.blocos_pausa) * BLOCO_MS < LETRA_MAX_MS:
+            return None
+        return self._fechar()
+
+    def _fechar(self):
+        self.em_fala = False
+        pausa = self.blocos_pausa * self.bloco
+        fala = self.blocos_fala * BLOCO_MS
+        # a pausa inteira fica de fora, menos a margem depois da fala
+        fim = len(self.historico) - max(0, pausa - self.margem)
+        trecho = self.historico[:fim]
+        del self.historico[:max(0, len(self.historico) - self.margem)]
+        self.blocos_fala = self.blocos_pausa = 0
+        return trecho if fala >= LETRA_MIN_MS else None
+
+    def alimentar(self, amostras, inicio=0, fim=None):
+        """Trechos (array('h')) fechados pelas amostras[inicio:fim]."""
+        self.pendente.extend(amostras[inicio:fim])
+        trechos = []
+        n = len(self.pendente) - len(self.pendente) % self.bloco
+        for i in range(0, n, self.bloco):
+            t = self._bloco(self.pendente[i:i + self.bloco])
+            if t is not None:
+                trechos.append(t)
+        del self.pendente[:n]
+        return trechos
+
+    def finalizar(self):
+        """Fecha a letra em andamento no fim da captura."""
+        if self.em_fala:
+            t = self._fechar()
+            return [t] if t is not None else []
+        return []
+
+
+class Soletracao:
+    """
+    Acompanha uma rodada: classifica cada trecho como uma letra e manda o
+    veredito à Pico. errou: saiu uma letra certa de ser errada (a Pico encerra
+    a captura); completa: todas as letras da esperada, sem nenhuma incerta.
+    Depois da primeira incerta, a posição das seguintes já não é confiável
+    (podem ter sido duas letras num trecho só): elas vão todas como "?".
+    """
+
+    def __init__(self, ser, verif, esperada):
+        self.ser = ser
+        self.verif = verif
+        self.esperada = esperada
+        self.segmentador = None
+        self.letras = []
+        self.errou = False
+
+    def iniciar(self, taxa):
+        self.taxa = taxa
+        self.segmentador = SegmentadorLetras(taxa)
+
+    @property
+    def completa(self):
+        return "".join(self.letras) == self.esperada
+
+    def alimentar(self, amostras, inicio=0, fim=None):
+        for trecho in self.segmentador.alimentar(amostras, inicio, fim):
+            self._letra(trecho)
+
+    def finalizar(self):
+        for trecho in self.segmentador.finalizar():
+            self._letra(trecho)
+
+    def _letra(self, trecho):
+        if self.errou or self.completa:
+            return  # a Pico já encerrou a rodada
+        proc = dsp_voz.ProcessadorVoz(self.taxa)
+        proc.empurrar(trecho)
+        audio = proc.finalizar()
+        r = self.verif.letra(audio) if audio else None
+        letra = r[0] if r and r[1] >= CONFIANCA_LETRA and "?" not in self.letras else "?"
+        pos = len(self.letras)
+        self.letras.append(letra)
+        if letra != "?" and (pos >= len(self.esperada) or letra != self.esperada[pos]):
+            self.errou = True
+        detalhe = f"'{r[0]}' confiança {r[1]:.2f}" if r else "sem fala"
+        print(f"[LETRA] {pos}: {letra} ({detalhe}, {len(trecho) * 1000 // self.taxa} ms)")
+        if self.ser is not None:
+            self.ser.write(f"letra {pos} {letra}\n".encode("ascii"))
+
+
+def main():
+    if len(sys.argv) < 3:
+        print("uso: soletracao.py letras.mdl fala.wav [esperada]", file=sys.stderr)
+        return 2
+    import wave
+    verif = verificador.Verificador(sys.argv[1])
+    with wave.open(sys.argv[2], "rb") as wf:
+        taxa = wf.getframerate()
+        amostras = array("h", wf.readframes(wf.getnframes()))
+    if sys.byteorder != "little":
+        amostras.byteswap()
+    s = Soletracao(None, verif, sys.argv[3] if len(sys.argv) > 3 else "")
+    s.iniciar(taxa)
+    for i in range(0, len(amostras), 256):  # em quadros, como chegam da Pico
+        s.alimentar(amostras, i, i + 256)
+    s.finalizar()
+    print(f"soletrado: {''.join(s.letras)}" + (" (errou)" if s.errou else " (completa)" if s.completa else ""))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,66 @@
+# Normalização das transcrições e distância de edição (usadas por listen_serial.py
+# e medidas por bench.py)
+
+import unicodedata
+import re
+
+
+def normalize_string(s: str) -> str:
+    """
+    Normaliza uma string:
+    - lowercase
+    - remove acentos (NFKD)
+    - mantém apenas letras a-z
+    - junta sequências de letras separadas (ex: "t e s t e" -> "teste")
+    Retorna a forma *sem espaços* (porque a palavra esperada é única).
+    """
+    if not s:
+        return ""
+    s = s.lower().strip()
+    s = unicodedata.normalize('NFKD', s)
+    s = ''.join(ch for ch in s if not unicodedata.combining(ch))
+    # mantém apenas letras e espaços
+    s = re.sub(r'[^a-z\s]', '', s)
+    # split + juntar sequências de tokens de 1 letra (ex.: "t e s t e" -> "teste")
+    tokens = s.split()
+    merged = []
+    i = 0
+    while i < len(tokens):
+        if len(tokens[i]) == 1:
+            j = i
+            seq = []
+            while j < len(tokens) and len(tokens[j]) == 1:
+                seq.append(tokens[j])
+                j += 1
+            if len(seq) > 1:
+                merged.append(''.join(seq))
+            else:
+                merged.append(seq[0])
+            i = j
+        else:
+            merged.append(tokens[i])
+            i += 1
+    # como estamos lidando com palavras únicas, retornamos sem espaços
+    return ''.join(merged)
+
+def levenshtein(a: str, b: str) -> int:
+    """Distância de Levenshtein (edit distance)."""
+    if a == b:
+        return 0
+    n, m = len(a), len(b)
+    if n == 0:
+        return m
+    if m == 0:
+        return n
+    # matrix (n+1) x (m+1)
+    prev = list(range(m + 1))
+    for i in range(1, n + 1):
+        cur = [i] + [0] * m
+        ai = a[i - 1]
+        for j in range(1, m + 1):
+            cost = 0 if ai == b[j - 1] else 1
+            cur[j] = min(prev[j] + 1,      # deletion
+                         cur[j - 1] + 1,   # insertion
+                         prev[j - 1] + cost)  # substitution
+        prev = cur
+    return prev[m]
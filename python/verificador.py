@@ -0,0 +1,353 @@
+# Verificação local da resposta soletrada, sem ASR na nuvem
+# (ferramentas/verificador.c): a fala é comparada por DTW com os modelos das
+# letras da palavra esperada e das palavras parecidas do dicionário. A
+# confiança é a fatia da esperada (ou da vencedora) num softmax dos custos;
+# abaixo de CONFIANCA_MIN quem chama decide pelo ASR.
+#
+# O modelo de letras é construído offline a partir de gravações de cada letra
+# falada, uma por arquivo: <letra>[_qualquer_coisa].wav, mono, 16 bits, 8 ou
+# 16 kHz (a.wav, a_2.wav, b_joana.wav...). Elas passam pelo mesmo dsp_voz da
+# captura, e de cada letra fica só o medoide (a gravação mais parecida com as
+# outras), então o modelo tem algumas dezenas de KB.
+#
+# Com --pico o modelo é para o codec CODEC_LOG_MEL, em que a Pico só manda
+# características log-mel: as gravações (de 8 kHz, como as da Pico) passam
+# pelo mesmo microfone/log_mel.c do firmware, compilado na libverificador.
+#
+#   python3 verificador.py construir gravacoes/ -o ../dataset/letras.mdl
+#   python3 verificador.py construir gravacoes_8k/ --pico -o ../dataset/letras_pico.mdl
+#   python3 verificador.py testar ../dataset/letras.mdl fala.wav casa [caso capa...]
+
+import argparse
+import ctypes
+import glob
+import math
+import os
+import random
+import struct
+import sys
+import time
+import wave
+from array import array
+from collections import namedtuple
+
+import dsp_voz
+
+BASE_DIR = os.path.dirname(os.path.abspath(__file__))
+CAMINHO_PADRAO = os.path.join(BASE_DIR, "..", "dataset", "letras.mdl")
+CAMINHO_PICO = os.path.join(BASE_DIR, "..", "dataset", "letras_pico.mdl")
+
+COEFS = 13
+LETRAS = 26
+VERSAO = 2
+ORIGEM_AUDIO, ORIGEM_PICO = 0, 1
+PASSO = 160  # amostras por quadro de características, a 16 kHz
+TAXA_PICO = 8000
+BANDAS_PICO = 20    # LOG_MEL_BANDAS: bytes por quadro log-mel (microfone/log_mel.h)
+PASSO_PICO = 128    # LOG_MEL_PASSO, em amostras a 8 kHz
+
+TEMPERATURA = 0.05    # custo relativo ao da melhor: 5% mais caro pesa 1/e
+CONFIANCA_MIN = 0.7
+MAX_VIZINHAS = 8      # palavras do dicionário que concorrem com a esperada
+FOLGA_CUSTO_MAX = 1.25
+PALAVRAS_CALIBRACAO = 200
+
+Veredito = namedtuple("Veredito", "aceita confianca melhor custo ms")
+
+
+def _carregar_biblioteca():
+    """VERIFICADOR_LIB ou a libverificador de algum diretório de build ao lado do repositório."""
+    candidatos = [os.environ.get("VERIFICADOR_LIB", "")]
+    candidatos += sorted(glob.glob(os.path.join(BASE_DIR, "..", "*", "ferramentas", "libverificador.*")))
+    for caminho in filter(None, candidatos):
+        try:
+            lib = ctypes.CDLL(caminho)
+        except OSError:
+            continue
+        f32p = ctypes.POINTER(ctypes.c_float)
+        lib.verificador_caracteristicas.argtypes = [ctypes.c_void_p, ctypes.c_size_t, f32p, ctypes.c_int,
+                                                    ctypes.c_int]
+        lib.verificador_caracteristicas.restype = ctypes.c_int
+        lib.verificador_dtw.argtypes = [f32p, ctypes.c_int, f32p, ctypes.c_int, ctypes.c_float]
+        lib.verificador_dtw.restype = ctypes.c_float
+        lib.verificador_abrir.argtypes = [ctypes.c_char_p]
+        lib.verificador_abrir.restype = ctypes.c_void_p
+        lib.verificador_fechar.argtypes = [ctypes.c_void_p]
+        lib.verificador_custo_max.argtypes = [ctypes.c_void_p]
+        lib.verificador_custo_max.restype = ctypes.c_float
+        lib.verificador_custo_max_letra.argtypes = [ctypes.c_void_p]
+        lib.verificador_custo_max_letra.restype = ctypes.c_float
+        lib.verificador_pontuar.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t,
+                                            ctypes.POINTER(ctypes.c_char_p), ctypes.c_int, f32p]
+        lib.verificador_pontuar.restype = ctypes.c_int
+        lib.verificador_letra.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t, f32p]
+        lib.verificador_letra.restype = ctypes.c_int
+        lib.verificador_log_mel.argtypes = [ctypes.c_void_p, ctypes.c_size_t, ctypes.c_char_p, ctypes.c_int]
+        lib.verificador_log_mel.restype = ctypes.c_int
+        lib.verificador_caracteristicas_mel.argtypes = [ctypes.c_char_p, ctypes.c_int, f32p, ctypes.c_int,
+                                                        ctypes.c_int]
+        lib.verificador_caracteristicas_mel.restype = ctypes.c_int
+        lib.verificador_origem.argtypes = [ctypes.c_void_p]
+        lib.verificador_origem.restype = ctypes.c_int
+        lib.verificador_pontuar_mel.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int,
+                                                ctypes.POINTER(ctypes.c_char_p), ctypes.c_int, f32p]
+        lib.verificador_pontuar_mel.restype = ctypes.c_int
+        lib.verificador_letra_mel.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_int, f32p]
+        lib.verificador_letra_mel.restype = ctypes.c_int
+        return lib
+    return None
+
+
+_lib = _carregar_biblioteca()
+NATIVA = _lib is not None
+
+
+def _amostras(audio_16k):
+    """bytes de 16 bits little-endian -> array('h') nativo."""
+    a = array("h", audio_16k)
+    if sys.byteorder != "little":
+        a.byteswap()
+    return a
+
+
+def caracteristicas(fala, cmn=True, pico=False):
+    """
+    (quadros, vetor ctypes de quadros * COEFS floats) da fala: áudio a 16 kHz,
+    ou com pico=True os quadros log-mel da Pico (bytes).
+    """
+    if pico:
+        maximo = len(fala) // BANDAS_PICO
+        saida = (ctypes.c_float * (max(maximo, 1) * COEFS))()
+        n = _lib.verificador_caracteristicas_mel(bytes(fala), maximo, saida, maximo, int(cmn))
+        return n, saida
+    a = _amostras(fala)
+    maximo = len(a) // PASSO + 1
+    saida = (ctypes.c_float * (maximo * COEFS))()
+    n = _lib.verificador_caracteristicas(a.buffer_info()[0], len(a), saida, maximo, int(cmn))
+    return n, saida
+
+
+def log_mel(audio_8k):
+    """Os quadros log-mel que a Pico mandaria para este áudio de 8 kHz e 16 bits."""
+    a = _amostras(audio_8k)
+    adc = array("H", (min(4095, max(0, (x >> 4) + 2048)) for x in a))  # de volta a 12 bits
+    maximo = len(a) // PASSO_PICO + 1
+    saida = ctypes.create_string_buffer(maximo * BANDAS_PICO)
+    n = _lib.verificador_log_mel(adc.buffer_info()[0], len(adc), saida, maximo)
+    return saida.raw[:n * BANDAS_PICO]
+
+
+def dtw(a, b, limite=math.inf):
+    (na, fa), (nb, fb) = a, b
+    return _lib.verificador_dtw(fa, na, fb, nb, limite)
+
+
+class Verificador:
+    """
+    Modelo de letras aberto. A fala passada aos métodos é áudio a 16 kHz já
+    pré-processado, ou, num modelo de origem Pico (self.pico), os quadros
+    log-mel que a Pico mandou.
+    """
+
+    def __init__(self, caminho_modelo=CAMINHO_PADRAO):
+        if not NATIVA:
+            raise OSError("libverificador não encontrada (compile ferramentas/)")
+        self._v = _lib.verificador_abrir(os.fsencode(caminho_modelo))
+        if not self._v:
+            raise ValueError(f"{caminho_modelo}: modelo de letras inválido")
+        self.custo_max = _lib.verificador_custo_max(self._v)
+        self.custo_max_letra = _lib.verificador_custo_max_letra(self._v)
+        self.pico = _lib.verificador_origem(self._v) == ORIGEM_PICO
+
+    def fechar(self):
+        if self._v:
+            _lib.verificador_fechar(self._v)
+            self._v = None
+
+    def _fala(self, fala):
+        """Argumentos de ctypes da fala, conforme a origem do modelo."""
+        if self.pico:
+            fala = bytes(fala)
+            return fala, len(fala) // BANDAS_PICO
+        a = _amostras(fala)
+        return (ctypes.c_int16 * len(a)).from_buffer(a), len(a)  # a vista mantém o array vivo
+
+    def pontuar(self, fala, candidatas):
+        """Custo de DTW da fala contra cada candidata (inf: sem modelo ou muito atrás)."""
+        nomes = (ctypes.c_char_p * len(candidatas))(*(c.encode("ascii") for c in candidatas))
+        custos = (ctypes.c_float * len(candidatas))()
+        pontuar = _lib.verificador_pontuar_mel if self.pico else _lib.verificador_pontuar
+        pontuar(self._v, *self._fala(fala), nomes, len(candidatas), custos)
+        return list(custos)
+
+    def verificar(self, fala, esperada, vizinhas=None):
+        """
+        Veredito da fala contra a esperada e as vizinhas dela no dicionário
+        (distancia.Vizinhas); None se não há como julgar (sem fala, ou letra da
+        esperada sem modelo).
+        """
+        t0 = time.perf_counter()
+        candidatas = [esperada]
+        if vizinhas is not None:
+            candidatas += [p for p, _ in vizinhas.buscar(esperada, k=2, maximo=MAX_VIZINHAS + 1)
+                           if p != esperada][:MAX_VIZINHAS]
+        custos = self.pontuar(fala, candidatas)
+        if math.isinf(custos[0]):
+            return None
+
+        melhor, confianca = self._confianca(custos, self.custo_max)
+        ms = (time.perf_counter() - t0) * 1e3
+        return Veredito(melhor == 0 and confianca > 0, confianca, candidatas[melhor], custos[melhor], ms)
+
+    def custos_letras(self, fala):
+        """Custo de um segmento com uma letra só contra cada uma das 26 letras."""
+        custos = (ctypes.c_float * LETRAS)()
+        letra = _lib.verificador_letra_mel if self.pico else _lib.verificador_letra
+        letra(self._v, *self._fala(fala), custos)
+        return list(custos)
+
+    def letra(self, fala):
+        """(letra, confiança, custo) de um segmento com uma letra só; None sem fala."""
+        custos = self.custos_letras(fala)
+        if all(math.isinf(c) for c in custos):
+            return None
+        melhor, confianca = self._confianca(custos, self.custo_max_letra)
+        return chr(ord("a") + melhor), confianca, custos[melhor]
+
+    @staticmethod
+    def _confianca(custos, teto):
+        """(índice da melhor, fatia dela no softmax dos custos relativos); 0 acima do teto."""
+        melhor = min(range(len(custos)), key=custos.__getitem__)
+        base = custos[melhor]
+        if teto and base > teto:
+            return melhor, 0.0  # nem a melhor parece com o que foi dito
+        escala = TEMPERATURA * max(base, 1e-6)
+        pesos = [math.exp(-(c - base) / escala) if not math.isinf(c) else 0.0 for c in custos]
+        return melhor, pesos[melhor] / sum(pesos)
+
+
+# ---------- construir ----------
+def _ler_wav(caminho):
+    with wave.open(caminho, "rb") as wf:
+        if wf.getnchannels() != 1 or wf.getsampwidth() != 2:
+            raise ValueError(f"{caminho}: esperado .wav mono de 16 bits")
+        return wf.getframerate(), wf.readframes(wf.getnframes())
+
+
+def ler_wav_16k(caminho):
+    """Passa a gravação pelo mesmo pré-processamento da captura (dsp_voz)."""
+    taxa, dados = _ler_wav(caminho)
+    proc = dsp_voz.ProcessadorVoz(taxa)
+    proc.empurrar(_amostras(dados))
+    return proc.finalizar()
+
+
+def ler_wav_pico(caminho):
+    """Os quadros log-mel que a Pico mandaria com esta gravação (8 kHz, como as dela)."""
+    taxa, dados = _ler_wav(caminho)
+    if taxa != TAXA_PICO:
+        raise ValueError(f"{caminho}: o modelo da Pico precisa de gravações a {TAXA_PICO} Hz")
+    return log_mel(dados)
+
+
+def _gravar_modelo(saida, modelos, custo_max, custo_max_letra, origem):
+    with open(saida, "wb") as f:
+        f.write(struct.pack("<4sHBBffB3x", b"SPLM", VERSAO, COEFS, LETRAS, custo_max, custo_max_letra, origem))
+        for l in range(LETRAS):
+            n, feats = modelos.get(chr(ord("a") + l), (0, None))
+            f.write(struct.pack("<H", n))
+            if n:
+                f.write(struct.pack(f"<{n * COEFS}f", *feats[:n * COEFS]))
+
+
+def _percentil_95(valores):
+    valores = sorted(valores)
+    return valores[len(valores) * 95 // 100]
+
+
+def construir(pasta, saida, pico=False):
+    ler = ler_wav_pico if pico else ler_wav_16k
+    origem = ORIGEM_PICO if pico else ORIGEM_AUDIO
+    por_letra = {}
+    for caminho in sorted(glob.glob(os.path.join(pasta, "*.wav"))):
+        letra = os.path.basename(caminho)[0].lower()
+        if "a" <= letra <= "z":
+            fala = ler(caminho)
+            feats = caracteristicas(fala, pico=pico)
+            if feats[0] > 0:
+                # com CMN para comparar as gravações; o modelo guarda sem
+                por_letra.setdefault(letra, []).append((fala, feats, caracteristicas(fala, cmn=False, pico=pico)))
+
+    modelos, sobras = {}, {}
+    for letra, grav in sorted(por_letra.items()):
+        # Medoide: a gravação com a menor soma de custos contra as outras
+        custos = [[dtw(a, b) if a is not b else 0.0 for _, b, _ in grav] for _, a, _ in grav]
+        m = min(range(len(grav)), key=lambda i: sum(custos[i]))
+        modelos[letra] = grav[m][2]
+        sobras[letra] = [fala for i, (fala, _, _) in enumerate(grav) if i != m]
+
+    # Limites absolutos, calibrados com as gravações que não viraram modelo: letras
+    # sozinhas e sequências delas montadas como palavras, pontuadas contra o próprio
+    # modelo. Ficam um pouco acima do 95º percentil; sem gravações de sobra, sem limite.
+    _gravar_modelo(saida, modelos, 0.0, 0.0, origem)
+    custo_max = custo_max_letra = 0.0
+    letras_com_sobra = sorted(l for l, a in sobras.items() if a)
+    if letras_com_sobra:
+        rng = random.Random(0)
+        verificador = Verificador(saida)
+        # 250 ms de silêncio entre as letras: zeros no áudio, quadros no piso no log-mel
+        pausa = bytes(BANDAS_PICO * TAXA_PICO // PASSO_PICO // 4) if pico else bytes(2 * dsp_voz.TAXA_SAIDA // 4)
+        custos = []
+        for _ in range(PALAVRAS_CALIBRACAO):
+            palavra = "".join(rng.choice(letras_com_sobra) for _ in range(rng.randint(4, 7)))
+            fala = pausa + pausa.join(rng.choice(sobras[l]) for l in palavra) + pausa
+            custos.append(verificador.pontuar(fala, [palavra])[0])
+        custos_letra = [verificador.custos_letras(a)[ord(l) - ord("a")]
+                        for l in letras_com_sobra for a in sobras[l]]
+        verificador.fechar()
+        custo_max = _percentil_95(custos) * FOLGA_CUSTO_MAX
+        custo_max_letra = _percentil_95(custos_letra) * FOLGA_CUSTO_MAX
+        _gravar_modelo(saida, modelos, custo_max, custo_max_letra, origem)
+
+    faltam = "".join(c for c in map(chr, range(ord("a"), ord("z") + 1)) if c not in modelos)
+    print(f"[INFO] {saida}: {len(modelos)} letras, {sum(map(len, por_letra.values()))} gravações, "
+          f"custo_max={custo_max:.2f}, custo_max_letra={custo_max_letra:.2f}" + (f", sem modelo: {faltam}" if faltam else ""))
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Modelo de letras e verificação local da resposta")
+    sub = ap.add_subparsers(dest="cmd", required=True)
+    c = sub.add_parser("construir", help="modelo de letras a partir de gravações <letra>*.wav")
+    c.add_argument("pasta")
+    c.add_argument("-o", "--saida")
+    c.add_argument("--pico", action="store_true", help="para o codec log-mel da Pico (gravações a 8 kHz)")
+    t = sub.add_parser("testar", help="verifica uma gravação contra palavras candidatas")
+    t.add_argument("modelo")
+    t.add_argument("wav")
+    t.add_argument("palavras", nargs="+", help="a esperada primeiro")
+    args = ap.parse_args()
+
+    if not NATIVA:
+        print("[ERRO] libverificador não encontrada (compile ferramentas/)", file=sys.stderr)
+        return 1
+    if args.cmd == "construir":
+        return construir(args.pasta, args.saida or (CAMINHO_PICO if args.pico else CAMINHO_PADRAO), args.pico)
+
+    verificador = Verificador(args.modelo)
+    fala = ler_wav_pico(args.wav) if verificador.pico else ler_wav_16k(args.wav)
+    custos = verificador.pontuar(fala, args.palavras)
+    for p, c in sorted(zip(args.palavras, custos), key=lambda x: x[1]):
+        print(f"{p:20} {c:8.3f}")
+
+    class Fixas:  # as palavras da linha de comando no lugar do dicionário
+        def buscar(self, _, k, maximo):
+            return [(p, 0) for p in args.palavras[1:maximo]]
+
+    v = verificador.verificar(fala, args.palavras[0], Fixas())
+    print(v)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
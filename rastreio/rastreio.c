@@ -0,0 +1,110 @@
+// rastreio/rastreio.c
+
+#include "rastreio.h"
+#include <string.h>
+#include "hardware/sync.h"
+#include "comunicacao/protocolo_serial.h"
+
+static rastreio_registro_t anel[2][RASTREIO_REGISTROS];
+static uint32_t escritos[2]; // índice livre de cada anel (só cresce)
+static volatile bool pausado; // durante o despejo os anéis ficam congelados
+
+volatile rastreio_contadores_t rastreio_cont;
+
+void rastreio_registrar(uint8_t tipo, uint8_t fase, uint16_t arg) {
+  uint core = get_core_num();
+  // Os contadores também são incrementados nas IRQs deste núcleo: o ++ tem
+  // que ficar dentro da seção crítica para não perder uma contagem
+  uint32_t status = save_and_disable_interrupts();
+  if (pausado) {
+    rastreio_cont.descartados_dump[core]++;
+    restore_interrupts(status);
+    return;
+  }
+
+  rastreio_registro_t *r = &anel[core][escritos[core]++ & (RASTREIO_REGISTROS - 1)];
+  r->t_us = time_us_32();
+  r->tipo = tipo;
+  r->fase = fase;
+  r->arg = arg;
+  rastreio_cont.registros[core]++;
+  restore_interrupts(status);
+}
+
+static inline void put_u16(uint8_t *p, uint16_t v) {
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v) {
+  put_u16(p, v & 0xFFFF);
+  put_u16(p + 2, v >> 16);
+}
+
+/*
+ * Cabeçalho do despejo:
+ *   'R' 'T' | versão (1) | núcleos (1) | agora (u32) | n core0 (u16) | n core1 (u16) | registros por anel (u32)
+ * Seguido de n0 + n1 registros {t_us u32, tipo u8, fase u8, arg u16}, LE.
+ */
+void rastreio_enviar(void) {
+  uint8_t cab[16];
+  uint n[2];
+
+  pausado = true;
+  __dmb();
+  for (uint c = 0; c < 2; c++)
+    n[c] = escritos[c] < RASTREIO_REGISTROS ? escritos[c] : RASTREIO_REGISTROS;
+
+  cab[0] = 'R';
+  cab[1] = 'T';
+  cab[2] = RASTREIO_VERSAO;
+  cab[3] = 2;
+  put_u32(cab + 4, time_us_32());
+  put_u16(cab + 8, n[0]);
+  put_u16(cab + 10, n[1]);
+  put_u32(cab + 12, RASTREIO_REGISTROS);
+  proto_send(PROTO_RASTREIO, cab, sizeof cab);
+
+  // Cada núcleo do mais antigo ao mais novo; o anel pode ter dado a volta
+  for (uint c = 0; c < 2; c++) {
+    uint ini = (escritos[c] - n[c]) & (RASTREIO_REGISTROS - 1);
+    uint ate_o_fim = RASTREIO_REGISTROS - ini;
+    if (ate_o_fim > n[c])
+      ate_o_fim = n[c];
+    if (ate_o_fim)
+      proto_send(PROTO_RASTREIO, (const uint8_t *)&anel[c][ini], ate_o_fim * sizeof(rastreio_registro_t));
+    if (n[c] > ate_o_fim)
+      proto_send(PROTO_RASTREIO, (const uint8_t *)&anel[c][0], (n[c] - ate_o_fim) * sizeof(rastreio_registro_t));
+  }
+  stdio_flush();
+
+  __dmb();
+  pausado = false;
+}
+
+void rastreio_enviar_estatisticas(void) {
+  const volatile rastreio_contadores_t *c = &rastreio_cont;
+  const uint32_t v[] = {
+    c->registros[0], c->registros[1],
+    c->descartados_dump[0] + c->descartados_dump[1],
+    c->blocos_perdidos, c->slots_descartados,
+    c->usb_quadros, c->usb_bytes, c->usb_bloqueios, c->usb_bloqueio_us,
+    c->linhas_rx,
+  };
+  uint8_t p[sizeof v];
+
+  for (uint i = 0; i < count_of(v); i++)
+    put_u32(p + 4 * i, v[i]);
+  proto_send(PROTO_ESTATISTICAS, p, sizeof p);
+  stdio_flush();
+}
+
+bool rastreio_comando(const char *linha) {
+  if (!strcmp(linha, "trace"))
+    rastreio_enviar();
+  else if (!strcmp(linha, "stats"))
+    rastreio_enviar_estatisticas();
+  else
+    return false;
+  return true;
+}
@@ -0,0 +1,95 @@
+// rastreio/rastreio.h
+
+#ifndef RASTREIO_H
+#define RASTREIO_H
+
+#include "pico/stdlib.h"
+
+/*
+ * Rastro de execução em RAM: um anel de registros de 8 bytes por núcleo,
+ * sempre ligado. Cada núcleo só escreve no próprio anel, então não há trava
+ * entre núcleos; IRQs do mesmo núcleo são seguradas só enquanto o índice
+ * avança. Quando o anel enche, os registros mais antigos são sobrescritos.
+ *
+ * O comando "trace" na serial despeja os dois anéis num quadro
+ * PROTO_RASTREIO e "stats" manda os contadores num PROTO_ESTATISTICAS;
+ * python/rastreio.py converte o despejo numa linha do tempo do Chrome
+ * (chrome://tracing ou Perfetto).
+ */
+
+#define RASTREIO_REGISTROS 512 // por núcleo, potência de 2
+#define RASTREIO_VERSAO 1
+
+// Tipos de registro
+typedef enum {
+  RT_RENDER = 1,   // render_async até a IRQ de fim do DMA do I2C; arg = bytes
+  RT_NPWRITE,      // envio de um quadro para a matriz de LEDs
+  RT_BEEP,         // arg = frequência em Hz
+  RT_BLOCO_ADC,    // IRQ de bloco cheio do microfone; arg = blocos cheios
+  RT_CODEC,        // codificação de um bloco no core1; arg = amostras
+  RT_SERIAL_TX,    // proto_send; arg = tipo do quadro
+  RT_SERIAL_RX,    // linha recebida do host; arg = tamanho
+  RT_EVENTO,       // evento despachado para a máquina do jogo; arg = tipo
+  RT_TRANSICAO,    // mudança de estado do jogo; arg = de << 8 | para
+} rastreio_tipo_t;
+
+// Fase do registro
+#define RT_INICIO 0
+#define RT_FIM 1
+#define RT_INSTANTE 2
+
+typedef struct {
+  uint32_t t_us;
+  uint8_t tipo;
+  uint8_t fase;
+  uint16_t arg;
+} rastreio_registro_t;
+
+/*
+ * Contadores de saúde do fluxo. Cada campo tem um só núcleo escritor
+ * (indicado ao lado), então também dispensam trava.
+ */
+typedef struct {
+  uint32_t registros[2];      // gravados por núcleo (o próprio núcleo)
+  uint32_t descartados_dump[2]; // registros perdidos durante um despejo, por núcleo (o próprio núcleo)
+  uint32_t blocos_perdidos;   // DMA do ADC passou o core1 (core1)
+  uint32_t slots_descartados; // anel de áudio cheio, core0 atrasado (core1)
+  uint32_t usb_quadros;       // quadros enviados (core0)
+  uint32_t usb_bytes;         // (core0)
+  uint32_t usb_bloqueios;     // envios que esperaram a USB mais que RASTREIO_BLOQUEIO_US (core0)
+  uint32_t usb_bloqueio_us;   // tempo total esperando a USB (core0)
+  uint32_t linhas_rx;         // linhas recebidas do host (core0)
+} rastreio_contadores_t;
+
+// Um envio que leva mais que isto está esperando espaço no buffer do CDC
+#define RASTREIO_BLOQUEIO_US 200
+
+extern volatile rastreio_contadores_t rastreio_cont;
+
+void rastreio_registrar(uint8_t tipo, uint8_t fase, uint16_t arg);
+
+static inline void rastreio_inicio(uint8_t tipo, uint16_t arg) {
+  rastreio_registrar(tipo, RT_INICIO, arg);
+}
+
+static inline void rastreio_fim(uint8_t tipo, uint16_t arg) {
+  rastreio_registrar(tipo, RT_FIM, arg);
+}
+
+static inline void rastreio_instante(uint8_t tipo, uint16_t arg) {
+  rastreio_registrar(tipo, RT_INSTANTE, arg);
+}
+
+// Trata os comandos "trace" e "stats" vindos da serial (só no core0).
+// Retorna false se a linha não é um comando do rastro.
+bool rastreio_comando(const char *linha);
+
+// Despeja os anéis (PROTO_RASTREIO): cabeçalho de 16 bytes e os registros,
+// do mais antigo para o mais novo, primeiro os do core0
+void rastreio_enviar(void);
+
+// Contadores em PROTO_ESTATISTICAS, u32 LE na ordem de rastreio_contadores_t,
+// com os descartados_dump dos dois núcleos somados num campo só
+void rastreio_enviar_estatisticas(void);
+
+#endif
@@ -0,0 +1,2 @@
+// sim/include/hardware/i2c.h — ver sim_hal.h
+#include "sim_hal.h"
@@ -0,0 +1,2 @@
+// sim/include/hardware/structs/systick.h — ver sim_hal.h
+#include "sim_hal.h"
@@ -0,0 +1,2 @@
+// sim/include/hardware/uart.h — ver sim_hal.h
+#include "sim_hal.h"
@@ -0,0 +1,2 @@
+// sim/include/pico/binary_info.h — ver sim_hal.h
+#include "sim_hal.h"
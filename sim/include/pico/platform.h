@@ -0,0 +1,2 @@
+// sim/include/pico/platform.h — ver sim_hal.h
+#include "sim_hal.h"
@@ -0,0 +1,417 @@
+// sim/include/sim_hal.h
+//
+// Subconjunto da API do Pico SDK usado pelo firmware, implementado no host
+// (ver sim/README.md). Os headers "pico/..." e "hardware/..." deste
+// diretório só incluem este arquivo, então o código do firmware compila sem
+// nenhuma alteração.
+
+#ifndef SIM_HAL_H
+#define SIM_HAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <assert.h>
+
+// ---------- pico/types.h, pico/platform.h ----------
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define _u(x) x##u
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#define __not_in_flash_func(f) f
+#define __time_critical_func(f) f
+#define __in_flash(grupo)
+#define __unused __attribute__((unused))
+#define hard_assert(c) assert(c)
+
+#define PICO_OK 0
+#define PICO_ERROR_GENERIC (-1)
+#define PICO_ERROR_TIMEOUT (-1)
+
+uint get_core_num(void);
+
+// ---------- pico/time.h, hardware/timer.h ----------
+
+typedef int32_t alarm_id_t;
+typedef int64_t (*alarm_callback_t)(alarm_id_t id, void *user_data);
+
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+
+struct repeating_timer {
+  int64_t delay_us;
+  alarm_id_t alarm_id;
+  repeating_timer_callback_t callback;
+  void *user_data;
+};
+
+uint64_t time_us_64(void);
+uint32_t time_us_32(void);
+absolute_time_t get_absolute_time(void);
+absolute_time_t make_timeout_time_us(uint64_t us);
+absolute_time_t make_timeout_time_ms(uint32_t ms);
+bool time_reached(absolute_time_t t);
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to);
+uint64_t to_us_since_boot(absolute_time_t t);
+uint32_t to_ms_since_boot(absolute_time_t t);
+
+void sleep_us(uint64_t us);
+void sleep_ms(uint32_t ms);
+void sleep_until(absolute_time_t t);
+void busy_wait_us(uint64_t us);
+void busy_wait_ms(uint32_t ms);
+
+alarm_id_t add_alarm_at(absolute_time_t t, alarm_callback_t callback, void *user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past);
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past);
+bool cancel_alarm(alarm_id_t id);
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out);
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out);
+bool cancel_repeating_timer(repeating_timer_t *timer);
+
+// ---------- hardware/sync.h ----------
+
+// Na simulação os "núcleos" se alternam só nos pontos de espera, então os
+// laços de espera ativa precisam ceder a vez (no SDK é uma função vazia).
+void tight_loop_contents(void);
+
+void __wfe(void);
+void __wfi(void);
+void __sev(void);
+void __dmb(void);
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+// ---------- pico/stdio.h ----------
+
+bool stdio_init_all(void);
+int getchar_timeout_us(uint32_t timeout_us);
+int putchar_raw(int c);
+int puts_raw(const char *s);
+void stdio_put_string(const char *s, int len, bool newline, bool cr_translation);
+void stdio_flush(void);
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param);
+
+// ---------- pico/rand.h ----------
+
+uint32_t get_rand_32(void);
+uint64_t get_rand_64(void);
+
+// ---------- hardware/gpio.h ----------
+
+enum gpio_function {
+  GPIO_FUNC_SPI = 1,
+  GPIO_FUNC_UART = 2,
+  GPIO_FUNC_I2C = 3,
+  GPIO_FUNC_PWM = 4,
+  GPIO_FUNC_SIO = 5,
+  GPIO_FUNC_PIO0 = 6,
+  GPIO_FUNC_PIO1 = 7,
+  GPIO_FUNC_NULL = 0x1f,
+};
+
+enum gpio_irq_level {
+  GPIO_IRQ_LEVEL_LOW = 0x1u,
+  GPIO_IRQ_LEVEL_HIGH = 0x2u,
+  GPIO_IRQ_EDGE_FALL = 0x4u,
+  GPIO_IRQ_EDGE_RISE = 0x8u,
+};
+
+#define GPIO_IN false
+#define GPIO_OUT true
+#define NUM_BANK0_GPIOS 30
+
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+void gpio_init(uint gpio);
+void gpio_set_dir(uint gpio, bool out);
+void gpio_set_function(uint gpio, enum gpio_function fn);
+void gpio_pull_up(uint gpio);
+void gpio_pull_down(uint gpio);
+void gpio_disable_pulls(uint gpio);
+bool gpio_get(uint gpio);
+void gpio_put(uint gpio, bool value);
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled);
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback);
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask);
+
+// ---------- hardware/irq.h ----------
+
+enum irq_num {
+  TIMER_IRQ_0 = 0,
+  TIMER_IRQ_1 = 1,
+  TIMER_IRQ_2 = 2,
+  TIMER_IRQ_3 = 3,
+  PIO0_IRQ_0 = 7,
+  PIO0_IRQ_1 = 8,
+  DMA_IRQ_0 = 11,
+  DMA_IRQ_1 = 12,
+  IO_IRQ_BANK0 = 13,
+  SIO_IRQ_PROC0 = 15,
+  SIO_IRQ_PROC1 = 16,
+  I2C0_IRQ = 23,
+  I2C1_IRQ = 24,
+  NUM_IRQS = 32,
+};
+
+typedef void (*irq_handler_t)(void);
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+void irq_set_enabled(uint num, bool enabled);
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority);
+void irq_remove_handler(uint num, irq_handler_t handler);
+
+// ---------- hardware/clocks.h ----------
+
+enum clock_index {
+  clk_gpout0 = 0,
+  clk_ref = 4,
+  clk_sys = 5,
+  clk_peri = 6,
+  clk_usb = 7,
+  clk_adc = 8,
+};
+
+uint32_t clock_get_hz(enum clock_index clk);
+
+// ---------- hardware/structs/systick.h ----------
+//
+// O SysTick conta para baixo a clk_sys; aqui o CVR é recalculado a cada
+// avanço do tempo virtual (o código do firmware em si não gasta ciclos)
+
+typedef struct {
+  volatile uint32_t csr, rvr, cvr, calib;
+} systick_hw_t;
+
+#define M0PLUS_SYST_CSR_ENABLE_BITS 0x00000001u
+#define M0PLUS_SYST_CSR_TICKINT_BITS 0x00000002u
+#define M0PLUS_SYST_CSR_CLKSOURCE_BITS 0x00000004u
+#define M0PLUS_SYST_CSR_COUNTFLAG_BITS 0x00010000u
+
+extern systick_hw_t *const systick_hw;
+
+// ---------- hardware/adc.h ----------
+
+typedef struct {
+  volatile uint32_t cs, result, fcs, fifo, div, intr, inte, intf, ints;
+} adc_hw_t;
+
+extern adc_hw_t *const adc_hw;
+
+void adc_init(void);
+void adc_gpio_init(uint gpio);
+void adc_select_input(uint input);
+void adc_set_round_robin(uint input_mask);
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift);
+void adc_set_clkdiv(float clkdiv);
+void adc_run(bool run);
+bool adc_fifo_is_empty(void);
+void adc_fifo_drain(void);
+uint16_t adc_read(void);
+
+// ---------- hardware/dma.h ----------
+
+enum dma_channel_transfer_size {
+  DMA_SIZE_8 = 0,
+  DMA_SIZE_16 = 1,
+  DMA_SIZE_32 = 2,
+};
+
+enum dreq_num {
+  DREQ_PIO0_TX0 = 0,
+  DREQ_PIO1_TX0 = 8,
+  DREQ_I2C0_TX = 32,
+  DREQ_I2C0_RX = 33,
+  DREQ_I2C1_TX = 34,
+  DREQ_I2C1_RX = 35,
+  DREQ_ADC = 36,
+  DREQ_FORCE = 0x3f,
+};
+
+#define NUM_DMA_CHANNELS 12
+
+typedef struct {
+  uint8_t tamanho;
+  bool incr_leitura;
+  bool incr_escrita;
+  uint8_t dreq;
+  uint8_t chain_to;
+  bool habilitado;
+} dma_channel_config;
+
+typedef struct {
+  volatile uint32_t read_addr, write_addr, transfer_count, ctrl_trig;
+} dma_channel_hw_t;
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_claim(uint channel);
+void dma_channel_unclaim(uint channel);
+dma_channel_config dma_channel_get_default_config(uint channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, uint dreq);
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to);
+void channel_config_set_enable(dma_channel_config *c, bool enable);
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger);
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger);
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger);
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger);
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger);
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count);
+void dma_channel_start(uint channel);
+void dma_channel_abort(uint channel);
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+dma_channel_hw_t *dma_channel_hw_addr(uint channel);
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+void dma_channel_set_irq1_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+bool dma_channel_get_irq1_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
+void dma_channel_acknowledge_irq1(uint channel);
+
+// ---------- hardware/i2c.h ----------
+
+typedef struct {
+  volatile uint32_t con, tar, sar, _reservado0, data_cmd;
+  volatile uint32_t _reservado1[22];
+  volatile uint32_t enable, status, txflr, rxflr, sda_hold, tx_abrt_source;
+  volatile uint32_t clr_tx_abrt, raw_intr_stat;
+} i2c_hw_t;
+
+typedef struct i2c_inst {
+  i2c_hw_t *hw;
+  bool restart_on_next;
+} i2c_inst_t;
+
+extern i2c_inst_t i2c0_inst;
+extern i2c_inst_t i2c1_inst;
+
+#define i2c0 (&i2c0_inst)
+#define i2c1 (&i2c1_inst)
+#define i2c_default i2c0
+
+#define PICO_DEFAULT_I2C 0
+#define PICO_DEFAULT_I2C_SDA_PIN 14
+#define PICO_DEFAULT_I2C_SCL_PIN 15
+
+#define I2C_IC_DATA_CMD_STOP_BITS _u(0x00000200)
+#define I2C_IC_DATA_CMD_RESTART_BITS _u(0x00000400)
+#define I2C_IC_STATUS_ACTIVITY_BITS _u(0x00000001)
+#define I2C_IC_STATUS_TFE_BITS _u(0x00000004)
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS _u(0x00000040)
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx);
+
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) {
+  return i2c->hw;
+}
+
+// ---------- hardware/pio.h ----------
+
+typedef struct {
+  volatile uint32_t ctrl, fstat, fdebug, flevel;
+  volatile uint32_t txf[4];
+  volatile uint32_t rxf[4];
+} pio_hw_t;
+
+typedef pio_hw_t *PIO;
+
+extern pio_hw_t sim_pio_hw[2];
+#define pio0 (&sim_pio_hw[0])
+#define pio1 (&sim_pio_hw[1])
+
+typedef struct {
+  float clkdiv;
+  bool shift_direita;
+  bool autopull;
+  uint pull_threshold;
+  bool fifo_tx_unida;
+  uint sideset_base;
+  uint wrap_target, wrap;
+} pio_sm_config;
+
+typedef struct pio_program {
+  const uint16_t *instructions;
+  uint8_t length;
+  int8_t origin;
+} pio_program_t;
+
+enum pio_fifo_join {
+  PIO_FIFO_JOIN_NONE = 0,
+  PIO_FIFO_JOIN_TX = 1,
+  PIO_FIFO_JOIN_RX = 2,
+};
+
+uint pio_add_program(PIO pio, const pio_program_t *program);
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_claim(PIO pio, uint sm);
+void pio_gpio_init(PIO pio, uint pin);
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out);
+pio_sm_config pio_get_default_sm_config(void);
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap);
+void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs);
+void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base);
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold);
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join);
+void sm_config_set_clkdiv(pio_sm_config *c, float div);
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config);
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data);
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm);
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx);
+
+// ---------- hardware/pwm.h ----------
+
+typedef struct {
+  float div;
+  uint16_t top;
+} pwm_config;
+
+enum pwm_chan {
+  PWM_CHAN_A = 0,
+  PWM_CHAN_B = 1,
+};
+
+uint pwm_gpio_to_slice_num(uint gpio);
+uint pwm_gpio_to_channel(uint gpio);
+pwm_config pwm_get_default_config(void);
+void pwm_config_set_clkdiv(pwm_config *c, float div);
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap);
+void pwm_init(uint slice_num, pwm_config *c, bool start);
+void pwm_set_clkdiv(uint slice_num, float divider);
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract);
+void pwm_set_wrap(uint slice_num, uint16_t wrap);
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+void pwm_set_enabled(uint slice_num, bool enabled);
+
+// ---------- pico/multicore.h ----------
+
+void multicore_launch_core1(void (*entry)(void));
+void multicore_fifo_push_blocking(uint32_t data);
+bool multicore_fifo_push_timeout_us(uint32_t data, uint64_t timeout_us);
+uint32_t multicore_fifo_pop_blocking(void);
+bool multicore_fifo_rvalid(void);
+bool multicore_fifo_wready(void);
+
+// ---------- pico/binary_info.h ----------
+
+#define bi_decl(...)
+#define bi_program_description(d)
+#define bi_2pins_with_func(a, b, f)
+
+#endif
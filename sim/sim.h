@@ -0,0 +1,85 @@
+// sim/sim.h
+//
+// Interface interna da simulação de host: relógio virtual, escalonador dos
+// dois núcleos e ganchos dos periféricos. O firmware não vê este header.
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "sim_hal.h"
+
+#define SIM_NUNCA UINT64_MAX
+#define SIM_CLK_SYS_HZ 125000000u
+
+// ---------- relógio virtual e escalonador (sim_nucleo.c) ----------
+
+typedef void (*sim_evento_fn)(void *arg, uint32_t extra);
+
+uint64_t sim_agora(void);
+
+// Agenda fn(arg, extra) para o instante t_us (tempo virtual). Eventos rodam
+// como interrupções: entre os pontos de espera do código do firmware.
+int sim_agendar(uint64_t t_us, sim_evento_fn fn, void *arg, uint32_t extra);
+void sim_cancelar(int id);
+
+// Bloqueia o núcleo atual até t_us (ou até um evento WFE, se acorda_com_evento).
+// Enquanto espera, o outro núcleo roda e o tempo virtual avança.
+void sim_esperar(uint64_t t_us, bool acorda_com_evento);
+
+// Cede a vez num laço de espera ativa, sem consumir o evento do WFE
+void sim_ceder(void);
+
+void sim_irq(uint num);
+void sim_limite(uint64_t t_us);
+void sim_semente(uint32_t semente);
+void sim_encerrar(const char *motivo) __attribute__((noreturn)); // fim normal
+void sim_falhar(const char *motivo) __attribute__((noreturn));   // erro de uso do SDK
+
+// ---------- log (sim_main.c) ----------
+
+extern FILE *sim_log_arq;
+void sim_log(const char *origem, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// ---------- periféricos ----------
+
+typedef struct {
+  uint32_t i2c_transacoes;
+  uint64_t i2c_bytes;
+  uint32_t tela_quadros;
+  uint32_t led_quadros;
+  uint64_t pio_palavras;
+  uint32_t tons;
+  uint64_t adc_amostras;
+  uint32_t dma_transferencias;
+  uint64_t serial_tx_bytes;
+  uint64_t serial_rx_bytes;
+} sim_contadores_t;
+
+extern sim_contadores_t sim_cont;
+
+// Entrada externa em um pino (botões); gera as IRQs de borda configuradas
+void sim_gpio_entrada(uint gpio, bool nivel);
+
+// Caracteres chegando do host pela serial
+void sim_serial_injetar(const char *s, size_t n);
+bool sim_serial_abrir(const char *caminho);
+
+// Fonte do ADC: o WAV começa a tocar na próxima amostra convertida
+bool sim_wav_abrir(const char *caminho);
+
+// Chamados pelo DMA quando o destino/origem é um periférico
+void sim_i2c_dma_palavra(i2c_inst_t *i2c, uint32_t palavra);
+uint64_t sim_i2c_duracao_us(i2c_inst_t *i2c, uint bytes);
+bool sim_pio_dma_palavra(volatile void *endereco, uint32_t palavra, uint64_t *fim_us);
+extern FILE *sim_leds_arq; // gravação dos quadros da fita: t_us (u64) + 75 bytes GRB
+uint16_t sim_adc_amostra(void);
+double sim_adc_periodo_us(void);
+bool sim_adc_rodando(void);
+void sim_dma_adc_pausar(void);
+void sim_dma_adc_retomar(void);
+
+// Tela do SSD1306: despeja em ASCII se mudou desde o último despejo
+extern bool sim_mostrar_tela;
+void sim_tela_despejar(bool forcar);
+
+#endif
@@ -0,0 +1,469 @@
+// sim/sim_dma.c
+//
+// DMA e ADC. As transferências levam o tempo que levariam no hardware: a do
+// ADC anda no ritmo do divisor de clock, a do I2C no ritmo do barramento e a
+// da PIO no ritmo dos bits. Chain, IRQ0/IRQ1 e abort seguem o RP2040.
+//
+// O ADC lê de um WAV (mono, PCM 8/16 bits ou float 32) reamostrado para a
+// taxa configurada; sem WAV, ou depois que ele acaba, é silêncio com ruído.
+
+#include "sim.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ---------- DMA ----------
+
+typedef struct {
+  bool reclamado;
+  dma_channel_config cfg;
+  dma_channel_hw_t hw;         // o firmware só lê transfer_count
+  volatile void *escrita;      // endereços reais do host (não cabem em 32 bits)
+  const volatile void *leitura;
+  uint32_t recarga;            // contagem usada no próximo disparo
+  bool ocupado;
+  uint32_t feitos;             // transferências já entregues neste disparo
+  double t_base;               // ADC: instante da amostra 0 deste disparo
+  int evento;
+  bool intr;                   // INTR bruto do canal
+  bool inte0, inte1;
+} canal_t;
+
+static canal_t canais[NUM_DMA_CHANNELS];
+
+static uint32_t ler(canal_t *c) {
+  uint32_t v;
+  switch (c->cfg.tamanho) {
+    case DMA_SIZE_8:  v = *(const volatile uint8_t *)c->leitura; break;
+    case DMA_SIZE_16: v = *(const volatile uint16_t *)c->leitura; break;
+    default:          v = *(const volatile uint32_t *)c->leitura; break;
+  }
+  if (c->cfg.incr_leitura)
+    c->leitura = (const volatile uint8_t *)c->leitura + (1u << c->cfg.tamanho);
+  return v;
+}
+
+static void escrever(canal_t *c, uint32_t v) {
+  switch (c->cfg.tamanho) {
+    case DMA_SIZE_8:  *(volatile uint8_t *)c->escrita = (uint8_t)v; break;
+    case DMA_SIZE_16: *(volatile uint16_t *)c->escrita = (uint16_t)v; break;
+    default:          *(volatile uint32_t *)c->escrita = v; break;
+  }
+  if (c->cfg.incr_escrita)
+    c->escrita = (volatile uint8_t *)c->escrita + (1u << c->cfg.tamanho);
+}
+
+static void preencher_adc(canal_t *c, uint32_t ate) {
+  for (; c->feitos < ate; c->feitos++) {
+    escrever(c, sim_adc_amostra());
+    sim_cont.adc_amostras++;
+  }
+  c->hw.transfer_count = c->recarga - c->feitos;
+}
+
+static void iniciar(uint ch);
+
+static void concluir(void *arg, uint32_t ch) {
+  canal_t *c = &canais[ch];
+  (void)arg;
+
+  if (c->cfg.dreq == DREQ_ADC)
+    preencher_adc(c, c->recarga);
+  c->ocupado = false;
+  c->evento = -1;
+  c->hw.transfer_count = 0;
+  c->intr = true;
+
+  if (c->cfg.chain_to != ch)
+    iniciar(c->cfg.chain_to);
+  if (c->inte0)
+    sim_irq(DMA_IRQ_0);
+  if (c->inte1)
+    sim_irq(DMA_IRQ_1);
+}
+
+static void agendar_adc(uint ch) {
+  canal_t *c = &canais[ch];
+  double periodo = sim_adc_periodo_us();
+  c->t_base = (double)sim_agora() - c->feitos * periodo;
+  c->evento = sim_agendar((uint64_t)llround(c->t_base + c->recarga * periodo), concluir, NULL, ch);
+}
+
+static void iniciar(uint ch) {
+  canal_t *c = &canais[ch];
+  if (!c->cfg.habilitado)
+    return;
+
+  c->ocupado = true;
+  c->feitos = 0;
+  c->hw.transfer_count = c->recarga;
+  c->evento = -1;
+  sim_cont.dma_transferencias++;
+
+  uint dreq = c->cfg.dreq;
+  if (dreq == DREQ_ADC) {
+    // Só anda enquanto o ADC estiver convertendo
+    if (sim_adc_rodando())
+      agendar_adc(ch);
+    return;
+  }
+
+  uint64_t fim = sim_agora();
+  if (dreq == DREQ_I2C0_TX || dreq == DREQ_I2C1_TX) {
+    i2c_inst_t *i2c = dreq == DREQ_I2C0_TX ? i2c0 : i2c1;
+    for (uint32_t i = 0; i < c->recarga; i++)
+      sim_i2c_dma_palavra(i2c, ler(c));
+    fim += sim_i2c_duracao_us(i2c, c->recarga);
+  } else if (dreq < DREQ_I2C0_TX) {
+    for (uint32_t i = 0; i < c->recarga; i++) {
+      if (!sim_pio_dma_palavra(c->escrita, ler(c), &fim))
+        sim_falhar("DMA de PIO com destino desconhecido");
+    }
+  } else {
+    for (uint32_t i = 0; i < c->recarga; i++)
+      escrever(c, ler(c));
+  }
+  c->feitos = c->recarga;
+  c->evento = sim_agendar(fim, concluir, NULL, ch);
+}
+
+// O ADC parou: entrega as amostras já convertidas e congela a contagem
+void sim_dma_adc_pausar(void) {
+  double periodo = sim_adc_periodo_us();
+  for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+    canal_t *c = &canais[ch];
+    if (!c->ocupado || c->cfg.dreq != DREQ_ADC || c->evento < 0)
+      continue;
+    sim_cancelar(c->evento);
+    c->evento = -1;
+    uint32_t prontas = (uint32_t)floor((sim_agora() - c->t_base) / periodo);
+    preencher_adc(c, prontas < c->recarga ? prontas : c->recarga);
+  }
+}
+
+void sim_dma_adc_retomar(void) {
+  for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+    canal_t *c = &canais[ch];
+    if (c->ocupado && c->cfg.dreq == DREQ_ADC && c->evento < 0)
+      agendar_adc(ch);
+  }
+}
+
+int dma_claim_unused_channel(bool required) {
+  for (uint ch = 0; ch < NUM_DMA_CHANNELS; ch++) {
+    if (!canais[ch].reclamado) {
+      canais[ch].reclamado = true;
+      canais[ch].evento = -1;
+      return (int)ch;
+    }
+  }
+  if (required)
+    sim_falhar("sem canais de DMA livres");
+  return -1;
+}
+
+void dma_channel_claim(uint channel) {
+  canais[channel].reclamado = true;
+  canais[channel].evento = -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+  canais[channel].reclamado = false;
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+  dma_channel_config c = {
+      .tamanho = DMA_SIZE_32,
+      .incr_leitura = true,
+      .incr_escrita = false,
+      .dreq = DREQ_FORCE,
+      .chain_to = (uint8_t)channel,
+      .habilitado = true,
+  };
+  return c;
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {
+  c->tamanho = (uint8_t)size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+  c->incr_leitura = incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+  c->incr_escrita = incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, uint dreq) {
+  c->dreq = (uint8_t)dreq;
+}
+
+void channel_config_set_chain_to(dma_channel_config *c, uint chain_to) {
+  c->chain_to = (uint8_t)chain_to;
+}
+
+void channel_config_set_enable(dma_channel_config *c, bool enable) {
+  c->habilitado = enable;
+}
+
+void dma_channel_set_config(uint channel, const dma_channel_config *config, bool trigger) {
+  canais[channel].cfg = *config;
+  if (trigger)
+    iniciar(channel);
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                           const volatile void *read_addr, uint transfer_count, bool trigger) {
+  canal_t *c = &canais[channel];
+  c->escrita = write_addr;
+  c->leitura = read_addr;
+  c->recarga = transfer_count;
+  c->hw.transfer_count = transfer_count;
+  dma_channel_set_config(channel, config, trigger);
+}
+
+void dma_channel_set_read_addr(uint channel, const volatile void *read_addr, bool trigger) {
+  canais[channel].leitura = read_addr;
+  if (trigger)
+    iniciar(channel);
+}
+
+void dma_channel_set_write_addr(uint channel, volatile void *write_addr, bool trigger) {
+  canais[channel].escrita = write_addr;
+  if (trigger)
+    iniciar(channel);
+}
+
+void dma_channel_set_trans_count(uint channel, uint32_t trans_count, bool trigger) {
+  canais[channel].recarga = trans_count;
+  if (trigger)
+    iniciar(channel);
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count) {
+  canais[channel].leitura = read_addr;
+  canais[channel].recarga = transfer_count;
+  iniciar(channel);
+}
+
+void dma_channel_start(uint channel) {
+  iniciar(channel);
+}
+
+void dma_channel_abort(uint channel) {
+  canal_t *c = &canais[channel];
+  sim_cancelar(c->evento);
+  c->evento = -1;
+  c->ocupado = false;
+}
+
+bool dma_channel_is_busy(uint channel) {
+  return canais[channel].ocupado;
+}
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+  while (canais[channel].ocupado)
+    sim_ceder();
+}
+
+dma_channel_hw_t *dma_channel_hw_addr(uint channel) {
+  return &canais[channel].hw;
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+  canais[channel].inte0 = enabled;
+}
+
+void dma_channel_set_irq1_enabled(uint channel, bool enabled) {
+  canais[channel].inte1 = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+  return canais[channel].intr && canais[channel].inte0;
+}
+
+bool dma_channel_get_irq1_status(uint channel) {
+  return canais[channel].intr && canais[channel].inte1;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+  canais[channel].intr = false;
+}
+
+void dma_channel_acknowledge_irq1(uint channel) {
+  canais[channel].intr = false;
+}
+
+// ---------- ADC ----------
+
+static adc_hw_t regs_adc;
+adc_hw_t *const adc_hw = &regs_adc;
+
+static float adc_div;
+static bool adc_ligado;
+static uint32_t ruido = 1;
+
+void adc_init(void) {
+  adc_div = 0.f;
+  adc_ligado = false;
+}
+
+void adc_gpio_init(uint gpio) {
+  gpio_set_function(gpio, GPIO_FUNC_NULL);
+  gpio_disable_pulls(gpio);
+}
+
+void adc_select_input(uint input) {
+  (void)input;
+}
+
+void adc_set_round_robin(uint input_mask) {
+  (void)input_mask;
+}
+
+void adc_fifo_setup(bool en, bool dreq_en, uint16_t dreq_thresh, bool err_in_fifo, bool byte_shift) {
+  (void)en, (void)dreq_en, (void)dreq_thresh, (void)err_in_fifo, (void)byte_shift;
+}
+
+void adc_set_clkdiv(float clkdiv) {
+  adc_div = clkdiv;
+}
+
+double sim_adc_periodo_us(void) {
+  // Uma conversão leva no mínimo 96 ciclos do clock de 48 MHz
+  double ciclos = 1.0 + adc_div;
+  return (ciclos < 96.0 ? 96.0 : ciclos) / 48.0;
+}
+
+bool sim_adc_rodando(void) {
+  return adc_ligado;
+}
+
+void adc_run(bool run) {
+  if (run == adc_ligado)
+    return;
+  if (run) {
+    adc_ligado = true;
+    sim_dma_adc_retomar();
+  } else {
+    sim_dma_adc_pausar();
+    adc_ligado = false;
+  }
+}
+
+// O DMA consome cada conversão na hora, então a FIFO nunca acumula
+bool adc_fifo_is_empty(void) {
+  return true;
+}
+
+void adc_fifo_drain(void) {
+}
+
+uint16_t adc_read(void) {
+  return sim_adc_amostra();
+}
+
+// ---------- fonte WAV ----------
+
+static int16_t *wav;
+static size_t wav_n;
+static uint32_t wav_taxa;
+static double wav_pos;
+static bool wav_tocando;
+
+static uint32_t le32(const uint8_t *p) {
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t le16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+bool sim_wav_abrir(const char *caminho) {
+  FILE *f = fopen(caminho, "rb");
+  if (!f)
+    return false;
+  fseek(f, 0, SEEK_END);
+  long tam = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t *dados = malloc((size_t)tam);
+  bool ok = dados && fread(dados, 1, (size_t)tam, f) == (size_t)tam;
+  fclose(f);
+  if (!ok || tam < 12 || memcmp(dados, "RIFF", 4) || memcmp(dados + 8, "WAVE", 4)) {
+    free(dados);
+    return false;
+  }
+
+  uint16_t formato = 0, canais_wav = 0, bits = 0;
+  uint32_t taxa = 0;
+  const uint8_t *pcm = NULL;
+  uint32_t pcm_len = 0;
+  for (long pos = 12; pos + 8 <= tam;) {
+    uint32_t len = le32(dados + pos + 4);
+    const uint8_t *corpo = dados + pos + 8;
+    if (pos + 8 + (long)len > tam)
+      len = (uint32_t)(tam - pos - 8);
+    if (!memcmp(dados + pos, "fmt ", 4) && len >= 16) {
+      formato = le16(corpo);
+      canais_wav = le16(corpo + 2);
+      taxa = le32(corpo + 4);
+      bits = le16(corpo + 14);
+      if (formato == 0xFFFE && len >= 26) // WAVE_FORMAT_EXTENSIBLE: o subformato diz o resto
+        formato = le16(corpo + 24);
+    } else if (!memcmp(dados + pos, "data", 4)) {
+      pcm = corpo;
+      pcm_len = len;
+    }
+    pos += 8 + len + (len & 1);
+  }
+
+  uint bytes = bits / 8;
+  bool suportado = canais_wav > 0 && taxa > 0 && pcm &&
+                   ((formato == 1 && (bits == 8 || bits == 16)) || (formato == 3 && bits == 32));
+  if (!suportado) {
+    free(dados);
+    return false;
+  }
+
+  size_t n = pcm_len / (bytes * canais_wav);
+  int16_t *amostras = malloc(n * sizeof(int16_t) + 1);
+  for (size_t i = 0; i < n; i++) {
+    const uint8_t *p = pcm + i * bytes * canais_wav; // só o primeiro canal
+    if (bits == 8) {
+      amostras[i] = (int16_t)((p[0] - 128) << 8);
+    } else if (bits == 16) {
+      amostras[i] = (int16_t)le16(p);
+    } else {
+      float x;
+      memcpy(&x, p, 4);
+      x = x > 1.f ? 1.f : x < -1.f ? -1.f : x;
+      amostras[i] = (int16_t)lrintf(x * 32767.f);
+    }
+  }
+  free(dados);
+
+  free(wav);
+  wav = amostras;
+  wav_n = n;
+  wav_taxa = taxa;
+  wav_pos = 0;
+  wav_tocando = true;
+  sim_log("adc", "tocando %s (%zu amostras, %u Hz, %.2f s)", caminho, n, taxa, (double)n / taxa);
+  return true;
+}
+
+uint16_t sim_adc_amostra(void) {
+  if (wav_tocando) {
+    int16_t s = wav[(size_t)wav_pos];
+    wav_pos += wav_taxa * sim_adc_periodo_us() / 1e6;
+    if (wav_pos >= wav_n) {
+      wav_tocando = false;
+      sim_log("adc", "fim do wav");
+    }
+    return (uint16_t)((s + 32768) >> 4);
+  }
+  // Silêncio: meia escala com ±2 LSB de ruído (LCG próprio, para não mexer no get_rand_32)
+  ruido = ruido * 1664525u + 1013904223u;
+  return (uint16_t)(2046 + (ruido >> 16) % 5);
+}
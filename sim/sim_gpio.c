@@ -0,0 +1,226 @@
+// sim/sim_gpio.c
+//
+// GPIO (com as IRQs de borda dos botões), clocks e PWM. O PWM vira um log de
+// tons: cada vez que o som audível num pino muda, registra frequência e duty.
+
+#include "sim.h"
+
+// ---------- GPIO ----------
+
+typedef struct {
+  enum gpio_function funcao;
+  bool saida;
+  bool nivel_saida;
+  bool externo_definido; // algo externo (o roteiro) está forçando o nível
+  bool nivel_externo;
+  bool pull_up, pull_down;
+  uint32_t irq_mascara;
+} pino_t;
+
+static pino_t pinos[NUM_BANK0_GPIOS];
+static gpio_irq_callback_t gpio_callback;
+
+static void pwm_reavaliar_pino(uint gpio);
+
+void gpio_init(uint gpio) {
+  pinos[gpio].funcao = GPIO_FUNC_SIO;
+  pinos[gpio].saida = false;
+  pinos[gpio].nivel_saida = false;
+}
+
+void gpio_set_dir(uint gpio, bool out) {
+  pinos[gpio].saida = out;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn) {
+  pinos[gpio].funcao = fn;
+  pwm_reavaliar_pino(gpio);
+}
+
+void gpio_pull_up(uint gpio) {
+  pinos[gpio].pull_up = true;
+  pinos[gpio].pull_down = false;
+}
+
+void gpio_pull_down(uint gpio) {
+  pinos[gpio].pull_up = false;
+  pinos[gpio].pull_down = true;
+}
+
+void gpio_disable_pulls(uint gpio) {
+  pinos[gpio].pull_up = false;
+  pinos[gpio].pull_down = false;
+}
+
+bool gpio_get(uint gpio) {
+  const pino_t *p = &pinos[gpio];
+  if (p->saida)
+    return p->nivel_saida;
+  if (p->externo_definido)
+    return p->nivel_externo;
+  return p->pull_up;
+}
+
+void gpio_put(uint gpio, bool value) {
+  pinos[gpio].nivel_saida = value;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled) {
+  if (enabled)
+    pinos[gpio].irq_mascara |= event_mask;
+  else
+    pinos[gpio].irq_mascara &= ~event_mask;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback) {
+  gpio_set_irq_enabled(gpio, event_mask, enabled);
+  gpio_callback = callback;
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask) {
+  (void)gpio;
+  (void)event_mask;
+}
+
+void sim_gpio_entrada(uint gpio, bool nivel) {
+  bool antes = gpio_get(gpio);
+  pinos[gpio].externo_definido = true;
+  pinos[gpio].nivel_externo = nivel;
+  bool depois = gpio_get(gpio);
+  if (antes == depois)
+    return;
+
+  uint32_t borda = depois ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+  if ((pinos[gpio].irq_mascara & borda) && gpio_callback)
+    gpio_callback(gpio, borda);
+}
+
+// ---------- clocks ----------
+
+uint32_t clock_get_hz(enum clock_index clk) {
+  switch (clk) {
+    case clk_sys:
+    case clk_peri:
+      return SIM_CLK_SYS_HZ;
+    case clk_usb:
+    case clk_adc:
+      return 48000000u;
+    default:
+      return 12000000u;
+  }
+}
+
+// ---------- PWM ----------
+
+#define NUM_SLICES 8
+
+typedef struct {
+  float div;
+  uint16_t top;
+  uint16_t nivel[2];
+  bool ligado;
+} slice_t;
+
+// O que está soando em cada pino, para só registrar mudanças
+typedef struct {
+  bool soando;
+  float freq;
+  uint16_t nivel;
+  uint64_t desde_us;
+} tom_t;
+
+static slice_t slices[NUM_SLICES] = {
+    [0 ... NUM_SLICES - 1] = {.div = 1.f, .top = 0xffff},
+};
+static tom_t tons[NUM_BANK0_GPIOS];
+
+uint pwm_gpio_to_slice_num(uint gpio) {
+  return (gpio >> 1) & 7u;
+}
+
+uint pwm_gpio_to_channel(uint gpio) {
+  return gpio & 1u;
+}
+
+static void pwm_reavaliar_pino(uint gpio) {
+  const slice_t *s = &slices[pwm_gpio_to_slice_num(gpio)];
+  uint16_t nivel = s->nivel[pwm_gpio_to_channel(gpio)];
+  bool soando = pinos[gpio].funcao == GPIO_FUNC_PWM && s->ligado && nivel > 0 && nivel <= s->top;
+  float freq = soando ? SIM_CLK_SYS_HZ / (s->div * (s->top + 1.f)) : 0.f;
+  tom_t *t = &tons[gpio];
+
+  if (soando == t->soando && (!soando || (freq == t->freq && nivel == t->nivel)))
+    return;
+
+  uint64_t agora = sim_agora();
+  if (t->soando && !soando)
+    sim_log("pwm", "gpio %u: silêncio (tom de %.1f Hz durou %.1f ms)", gpio, t->freq, (agora - t->desde_us) / 1000.0);
+  if (soando) {
+    sim_log("pwm", "gpio %u: %.1f Hz, duty %.0f%%", gpio, freq, 100.0 * nivel / (s->top + 1.0));
+    if (!t->soando || freq != t->freq)
+      sim_cont.tons++;
+  }
+
+  if (soando != t->soando || freq != t->freq)
+    t->desde_us = agora;
+  t->soando = soando;
+  t->freq = freq;
+  t->nivel = nivel;
+}
+
+static void pwm_reavaliar_slice(uint slice_num) {
+  for (uint gpio = 0; gpio < NUM_BANK0_GPIOS; gpio++) {
+    if (pwm_gpio_to_slice_num(gpio) == slice_num)
+      pwm_reavaliar_pino(gpio);
+  }
+}
+
+pwm_config pwm_get_default_config(void) {
+  pwm_config c = {.div = 1.f, .top = 0xffff};
+  return c;
+}
+
+void pwm_config_set_clkdiv(pwm_config *c, float div) {
+  c->div = div;
+}
+
+void pwm_config_set_wrap(pwm_config *c, uint16_t wrap) {
+  c->top = wrap;
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start) {
+  slice_t *s = &slices[slice_num];
+  s->div = c->div;
+  s->top = c->top;
+  s->nivel[0] = s->nivel[1] = 0;
+  s->ligado = start;
+  pwm_reavaliar_slice(slice_num);
+}
+
+void pwm_set_clkdiv(uint slice_num, float divider) {
+  slices[slice_num].div = divider;
+  pwm_reavaliar_slice(slice_num);
+}
+
+void pwm_set_clkdiv_int_frac(uint slice_num, uint8_t integer, uint8_t fract) {
+  pwm_set_clkdiv(slice_num, integer + fract / 16.f);
+}
+
+void pwm_set_wrap(uint slice_num, uint16_t wrap) {
+  slices[slice_num].top = wrap;
+  pwm_reavaliar_slice(slice_num);
+}
+
+void pwm_set_chan_level(uint slice_num, uint chan, uint16_t level) {
+  slices[slice_num].nivel[chan] = level;
+  pwm_reavaliar_slice(slice_num);
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level) {
+  pwm_set_chan_level(pwm_gpio_to_slice_num(gpio), pwm_gpio_to_channel(gpio), level);
+}
+
+void pwm_set_enabled(uint slice_num, bool enabled) {
+  slices[slice_num].ligado = enabled;
+  pwm_reavaliar_slice(slice_num);
+}
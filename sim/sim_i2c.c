@@ -0,0 +1,207 @@
+// sim/sim_i2c.c
+//
+// I2C com um SSD1306 de 128x64 no endereço 0x3C. Os bytes (escritos pela
+// CPU ou pelo DMA via IC_DATA_CMD) passam pelo mesmo decodificador que o
+// controlador do display usa: byte de controle (Co, D/C), comandos com seus
+// argumentos e dados gravados na GDDRAM conforme a janela de coluna/página.
+// A GDDRAM é o "framebuffer" da simulação e vai para o log em ASCII.
+
+#include "sim.h"
+#include <string.h>
+
+#define SSD1306_ADDR 0x3C
+#define LARGURA 128
+#define PAGINAS 8
+
+i2c_inst_t i2c0_inst;
+i2c_inst_t i2c1_inst;
+static i2c_hw_t regs_i2c[2];
+static uint baud[2] = {100000, 100000};
+
+bool sim_mostrar_tela = true;
+
+// ---------- modelo do SSD1306 ----------
+
+enum {
+  ESPERA_CONTROLE, // próximo byte é de controle
+  UM_COMANDO,      // Co=1, D/C=0: um byte de comando e volta ao controle
+  UM_DADO,         // Co=1, D/C=1
+  SO_COMANDOS,     // Co=0, D/C=0: o resto da transação é comando
+  SO_DADOS,        // Co=0, D/C=1
+};
+
+static struct {
+  uint8_t gddram[PAGINAS][LARGURA];
+  uint8_t col, col_ini, col_fim;
+  uint8_t pag, pag_ini, pag_fim;
+  bool ligado;
+  int estado;
+  uint8_t cmd[8];
+  uint cmd_len, cmd_esperado;
+  bool mudou;
+} tela = {.col_fim = LARGURA - 1, .pag_fim = PAGINAS - 1};
+
+// Quantos bytes de argumento cada comando traz
+static uint argumentos(uint8_t c) {
+  switch (c) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+      return 1;
+    case 0x21: case 0x22: case 0xA3:
+      return 2;
+    case 0x26: case 0x27:
+      return 6;
+    case 0x29: case 0x2A:
+      return 5;
+    default:
+      return 0;
+  }
+}
+
+static void ssd_comando(uint8_t b) {
+  if (tela.cmd_len == 0)
+    tela.cmd_esperado = argumentos(b);
+  tela.cmd[tela.cmd_len++] = b;
+  if (tela.cmd_len <= tela.cmd_esperado)
+    return;
+
+  const uint8_t *c = tela.cmd;
+  switch (c[0]) {
+    case 0x21:
+      tela.col_ini = tela.col = c[1] & 0x7F;
+      tela.col_fim = c[2] & 0x7F;
+      break;
+    case 0x22:
+      tela.pag_ini = tela.pag = c[1] & 0x07;
+      tela.pag_fim = c[2] & 0x07;
+      break;
+    case 0xAE:
+    case 0xAF:
+      if (tela.ligado != (c[0] == 0xAF)) {
+        tela.ligado = c[0] == 0xAF;
+        tela.mudou = true;
+      }
+      break;
+    default:
+      break; // contraste, remapeamento, scroll etc. não mudam o conteúdo lógico
+  }
+  tela.cmd_len = 0;
+}
+
+static void ssd_dado(uint8_t b) {
+  if (tela.gddram[tela.pag][tela.col] != b) {
+    tela.gddram[tela.pag][tela.col] = b;
+    tela.mudou = true;
+  }
+  // Endereçamento horizontal: avança a coluna e, no fim da janela, a página
+  if (tela.col++ >= tela.col_fim) {
+    tela.col = tela.col_ini;
+    if (tela.pag++ >= tela.pag_fim)
+      tela.pag = tela.pag_ini;
+  }
+}
+
+static void ssd_byte(uint8_t b) {
+  switch (tela.estado) {
+    case ESPERA_CONTROLE:
+      if (b & 0x80)
+        tela.estado = (b & 0x40) ? UM_DADO : UM_COMANDO;
+      else
+        tela.estado = (b & 0x40) ? SO_DADOS : SO_COMANDOS;
+      break;
+    case UM_COMANDO:
+      ssd_comando(b);
+      tela.estado = ESPERA_CONTROLE;
+      break;
+    case UM_DADO:
+      ssd_dado(b);
+      tela.estado = ESPERA_CONTROLE;
+      break;
+    case SO_COMANDOS:
+      ssd_comando(b);
+      break;
+    case SO_DADOS:
+      ssd_dado(b);
+      break;
+  }
+}
+
+static void ssd_stop(void) {
+  tela.estado = ESPERA_CONTROLE;
+}
+
+void sim_tela_despejar(bool forcar) {
+  if (!tela.mudou && !forcar)
+    return;
+  tela.mudou = false;
+  sim_cont.tela_quadros++;
+  if (!sim_mostrar_tela)
+    return;
+
+  // Dois pixels por caractere na vertical: 32 linhas de 128 colunas
+  static const char *const meio_bloco[4] = {" ", "▀", "▄", "█"};
+  sim_log("tela", "quadro %u%s", sim_cont.tela_quadros, tela.ligado ? "" : " (display desligado)");
+  fputs("+", sim_log_arq);
+  for (uint x = 0; x < LARGURA; x++)
+    fputs("-", sim_log_arq);
+  fputs("+\n", sim_log_arq);
+  for (uint y = 0; y < PAGINAS * 8; y += 2) {
+    fputs("|", sim_log_arq);
+    for (uint x = 0; x < LARGURA; x++) {
+      uint cima = (tela.gddram[y / 8][x] >> (y % 8)) & 1;
+      uint baixo = (tela.gddram[(y + 1) / 8][x] >> ((y + 1) % 8)) & 1;
+      fputs(meio_bloco[cima | (baixo << 1)], sim_log_arq);
+    }
+    fputs("|\n", sim_log_arq);
+  }
+  fputs("+", sim_log_arq);
+  for (uint x = 0; x < LARGURA; x++)
+    fputs("-", sim_log_arq);
+  fputs("+\n", sim_log_arq);
+}
+
+// ---------- I2C ----------
+
+static uint indice(i2c_inst_t *i2c) {
+  return i2c == i2c1 ? 1 : 0;
+}
+
+static void i2c_byte(uint8_t addr, uint8_t b, bool stop) {
+  sim_cont.i2c_bytes++;
+  if (stop)
+    sim_cont.i2c_transacoes++;
+  if (addr != SSD1306_ADDR)
+    return; // ninguém mais no barramento
+  ssd_byte(b);
+  if (stop)
+    ssd_stop();
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+  uint i = indice(i2c);
+  i2c->hw = &regs_i2c[i];
+  i2c->hw->enable = 1;
+  i2c->hw->status = I2C_IC_STATUS_TFE_BITS; // FIFO de TX vazia, barramento ocioso
+  baud[i] = baudrate;
+  return baudrate;
+}
+
+// 9 bits por byte (8 + ACK), mais o endereço
+uint64_t sim_i2c_duracao_us(i2c_inst_t *i2c, uint bytes) {
+  return ((uint64_t)(bytes + 1) * 9 * 1000000 + baud[indice(i2c)] - 1) / baud[indice(i2c)];
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+  for (size_t i = 0; i < len; i++)
+    i2c_byte(addr, src[i], !nostop && i + 1 == len);
+  sleep_us(sim_i2c_duracao_us(i2c, (uint)len));
+  return addr == SSD1306_ADDR ? (int)len : PICO_ERROR_GENERIC;
+}
+
+void sim_i2c_dma_palavra(i2c_inst_t *i2c, uint32_t palavra) {
+  i2c_byte((uint8_t)i2c->hw->tar, (uint8_t)palavra, palavra & I2C_IC_DATA_CMD_STOP_BITS);
+}
+
+uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) {
+  return (indice(i2c) ? DREQ_I2C1_TX : DREQ_I2C0_TX) + (is_tx ? 0 : 1);
+}
@@ -0,0 +1,242 @@
+// sim/sim_main.c
+//
+// Ponto de entrada da simulação: lê as opções e o roteiro (o que o jogador
+// e o host fazem, e quando), liga os periféricos simulados e chama o main()
+// do firmware, que aqui se chama soletrando_main(). Ver sim/README.md.
+
+#include "sim.h"
+#include <ctype.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BOTAO_A_GPIO 5
+#define BOTAO_B_GPIO 6
+#define TOQUE_PADRAO_MS 100
+#define MAX_LINHA 512
+
+int soletrando_main(void);
+
+FILE *sim_log_arq;
+sim_contadores_t sim_cont;
+static struct timespec inicio_real;
+
+void sim_log(const char *origem, const char *fmt, ...) {
+  va_list ap;
+  fprintf(sim_log_arq, "[%11.3f ms] %-7s ", sim_agora() / 1000.0, origem);
+  va_start(ap, fmt);
+  vfprintf(sim_log_arq, fmt, ap);
+  va_end(ap);
+  fputc('\n', sim_log_arq);
+}
+
+static void resumo(const char *motivo) {
+  struct timespec fim;
+  clock_gettime(CLOCK_MONOTONIC, &fim);
+  double real_s = (fim.tv_sec - inicio_real.tv_sec) + (fim.tv_nsec - inicio_real.tv_nsec) / 1e9;
+  double virtual_s = sim_agora() / 1e6;
+
+  fprintf(sim_log_arq, "[sim] fim: %s em %.3f s virtuais (%.3f s reais, %.0fx)\n", motivo, virtual_s, real_s,
+          real_s > 0 ? virtual_s / real_s : 0.0);
+  fprintf(sim_log_arq, "[sim] i2c: %u transações, %llu bytes; tela: %u quadros\n", sim_cont.i2c_transacoes,
+          (unsigned long long)sim_cont.i2c_bytes, sim_cont.tela_quadros);
+  fprintf(sim_log_arq, "[sim] leds: %u quadros (%llu palavras na PIO); pwm: %u tons\n", sim_cont.led_quadros,
+          (unsigned long long)sim_cont.pio_palavras, sim_cont.tons);
+  fprintf(sim_log_arq, "[sim] adc: %llu amostras; dma: %u transferências\n", (unsigned long long)sim_cont.adc_amostras,
+          sim_cont.dma_transferencias);
+  fprintf(sim_log_arq, "[sim] serial: %llu bytes enviados, %llu recebidos\n",
+          (unsigned long long)sim_cont.serial_tx_bytes, (unsigned long long)sim_cont.serial_rx_bytes);
+  fflush(sim_log_arq);
+}
+
+void sim_encerrar(const char *motivo) {
+  sim_tela_despejar(false);
+  fflush(stdout);
+  if (sim_leds_arq)
+    fclose(sim_leds_arq);
+  resumo(motivo);
+  exit(0);
+}
+
+void sim_falhar(const char *motivo) {
+  fflush(stdout);
+  fprintf(sim_log_arq, "[sim] erro: %s\n", motivo);
+  resumo("erro");
+  exit(2);
+}
+
+// ---------- roteiro ----------
+//
+// Uma ação por linha, "<tempo> <comando>", com o tempo em ms desde o boot
+// ou "+ms" depois da linha anterior. '#' começa um comentário.
+//
+//   5200 botao B           aperta B por 100 ms (ou "botao B 1500" para segurar)
+//   +300 serial casa       o host manda "casa\n"
+//   +50  wav voz/casa.wav  o jogador começa a falar (o ADC passa a ler o WAV)
+//   +0   tela              despeja a tela mesmo sem mudança
+//   +9000 fim              encerra a simulação
+
+static void soltar_botao(void *arg, uint32_t gpio) {
+  (void)arg;
+  sim_gpio_entrada(gpio, true);
+}
+
+static void executar(void *arg, uint32_t num_linha) {
+  char *cmd = arg;
+  (void)num_linha;
+
+  if (!strncmp(cmd, "botao", 5)) {
+    char qual = 0;
+    unsigned ms = TOQUE_PADRAO_MS;
+    sscanf(cmd + 5, " %c %u", &qual, &ms);
+    uint gpio = toupper((unsigned char)qual) == 'A' ? BOTAO_A_GPIO : BOTAO_B_GPIO;
+    sim_log("roteiro", "botão %c por %u ms", toupper((unsigned char)qual), ms);
+    sim_gpio_entrada(gpio, false);
+    sim_agendar(sim_agora() + ms * 1000ull, soltar_botao, NULL, gpio);
+  } else if (!strncmp(cmd, "serial", 6)) {
+    const char *texto = cmd[6] ? cmd + 7 : "";
+    sim_log("roteiro", "serial <- \"%s\"", texto);
+    sim_serial_injetar(texto, strlen(texto));
+    sim_serial_injetar("\n", 1);
+  } else if (!strncmp(cmd, "wav", 3)) {
+    if (!cmd[3] || !sim_wav_abrir(cmd + 4))
+      sim_falhar("não foi possível ler o WAV do roteiro");
+  } else if (!strcmp(cmd, "tela")) {
+    sim_tela_despejar(true);
+  } else if (!strcmp(cmd, "fim")) {
+    sim_encerrar("fim do roteiro");
+  }
+}
+
+static bool comando_valido(const char *cmd) {
+  static const char *const comandos[] = {"botao", "serial", "wav", "tela", "fim"};
+  size_t n = strcspn(cmd, " ");
+  for (size_t i = 0; i < count_of(comandos); i++) {
+    if (strlen(comandos[i]) == n && !strncmp(cmd, comandos[i], n))
+      return true;
+  }
+  return false;
+}
+
+static bool carregar_roteiro(FILE *f) {
+  char linha[MAX_LINHA];
+  uint64_t t_ms = 0;
+  uint num = 0;
+
+  while (fgets(linha, sizeof linha, f)) {
+    num++;
+    char *c = strchr(linha, '#');
+    if (c)
+      *c = '\0';
+    c = linha + strlen(linha);
+    while (c > linha && isspace((unsigned char)c[-1]))
+      *--c = '\0';
+    c = linha;
+    while (isspace((unsigned char)*c))
+      c++;
+    if (!*c)
+      continue;
+
+    char *resto;
+    bool relativo = *c == '+';
+    unsigned long long v = strtoull(c + relativo, &resto, 10);
+    if (resto == c + relativo || !isspace((unsigned char)*resto)) {
+      fprintf(stderr, "roteiro:%u: tempo inválido\n", num);
+      return false;
+    }
+    while (isspace((unsigned char)*resto))
+      resto++;
+    if (!comando_valido(resto)) {
+      fprintf(stderr, "roteiro:%u: comando desconhecido: %s\n", num, resto);
+      return false;
+    }
+
+    t_ms = relativo ? t_ms + v : v;
+    sim_agendar(t_ms * 1000, executar, strdup(resto), num);
+  }
+  return true;
+}
+
+// ---------- opções ----------
+
+static void uso(const char *prog) {
+  fprintf(stderr,
+          "uso: %s [opções] [< roteiro]\n"
+          "  --roteiro ARQ  ações do jogador e do host (padrão: stdin)\n"
+          "  --wav ARQ      fala do jogador desde o início (o ADC lê o WAV)\n"
+          "  --serial ARQ   grava a saída serial da Pico (padrão: stdout)\n"
+          "  --log ARQ      log da simulação: tela, LEDs, tons (padrão: stderr)\n"
+          "  --leds ARQ     grava os quadros da matriz de LEDs (t_us + 75 bytes GRB)\n"
+          "  --ate MS       para a simulação nesse instante virtual\n"
+          "  --sem-tela     não desenha a tela no log\n"
+          "  --semente N    semente do get_rand_32()\n",
+          prog);
+}
+
+int main(int argc, char **argv) {
+  const char *roteiro = NULL, *wav = NULL, *serial = NULL, *log = NULL, *leds = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    const char *op = argv[i];
+    const char *valor = i + 1 < argc ? argv[i + 1] : NULL;
+    bool usa_valor = true;
+
+    if (!strcmp(op, "--roteiro") && valor)
+      roteiro = valor;
+    else if (!strcmp(op, "--wav") && valor)
+      wav = valor;
+    else if (!strcmp(op, "--serial") && valor)
+      serial = valor;
+    else if (!strcmp(op, "--log") && valor)
+      log = valor;
+    else if (!strcmp(op, "--leds") && valor)
+      leds = valor;
+    else if (!strcmp(op, "--ate") && valor)
+      sim_limite(strtoull(valor, NULL, 10) * 1000);
+    else if (!strcmp(op, "--semente") && valor)
+      sim_semente((uint32_t)strtoul(valor, NULL, 0));
+    else if (!strcmp(op, "--sem-tela")) {
+      sim_mostrar_tela = false;
+      usa_valor = false;
+    } else {
+      uso(argv[0]);
+      return 1;
+    }
+    i += usa_valor;
+  }
+
+  sim_log_arq = log ? fopen(log, "w") : stderr;
+  if (!sim_log_arq) {
+    perror(log);
+    return 1;
+  }
+  if (leds && !(sim_leds_arq = fopen(leds, "wb"))) {
+    perror(leds);
+    return 1;
+  }
+  if (!sim_serial_abrir(serial)) {
+    perror(serial);
+    return 1;
+  }
+
+  FILE *f = roteiro ? fopen(roteiro, "r") : stdin;
+  if (!f) {
+    perror(roteiro);
+    return 1;
+  }
+  bool ok = carregar_roteiro(f);
+  if (f != stdin)
+    fclose(f);
+  if (!ok)
+    return 1;
+
+  if (wav && !sim_wav_abrir(wav)) {
+    fprintf(stderr, "%s: WAV inválido ou não suportado\n", wav);
+    return 1;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &inicio_real);
+  soletrando_main();
+  sim_encerrar("main() retornou");
+}
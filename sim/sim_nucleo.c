@@ -0,0 +1,500 @@
+// sim/sim_nucleo.c
+//
+// Relógio virtual, eventos temporizados, os dois núcleos como corrotinas
+// (ucontext), IRQs, alarmes, FIFO entre núcleos e sincronização.
+//
+// Nada roda em paralelo: um núcleo executa até esperar (WFE, sleep, FIFO
+// vazia, laço de espera ativa); aí o outro núcleo roda, se puder, ou o tempo
+// virtual salta para o próximo evento. Assim a execução é determinística.
+
+#include "sim.h"
+#include <stdlib.h>
+#include <ucontext.h>
+
+#define MAX_EVENTOS 256
+#define MAX_ALARMES 64
+#define MAX_HANDLERS 4
+#define PILHA_CORE1 (1u << 20)
+#define FIFO_PROFUNDIDADE 8
+
+// ---------- eventos temporizados ----------
+
+typedef struct {
+  bool ativo;
+  uint8_t geracao;
+  uint64_t t;
+  uint64_t ordem; // desempate: quem foi agendado antes dispara antes
+  sim_evento_fn fn;
+  void *arg;
+  uint32_t extra;
+} evento_sim_t;
+
+static evento_sim_t eventos[MAX_EVENTOS];
+static uint64_t ordem_seq;
+static uint64_t agora_us;
+static uint64_t limite_us = SIM_NUNCA;
+
+uint64_t sim_agora(void) {
+  return agora_us;
+}
+
+void sim_limite(uint64_t t_us) {
+  limite_us = t_us;
+}
+
+int sim_agendar(uint64_t t_us, sim_evento_fn fn, void *arg, uint32_t extra) {
+  for (int i = 0; i < MAX_EVENTOS; i++) {
+    evento_sim_t *e = &eventos[i];
+    if (e->ativo)
+      continue;
+    e->ativo = true;
+    e->geracao++;
+    e->t = t_us < agora_us ? agora_us : t_us;
+    e->ordem = ordem_seq++;
+    e->fn = fn;
+    e->arg = arg;
+    e->extra = extra;
+    return (e->geracao << 8) | i;
+  }
+  sim_falhar("fila de eventos cheia");
+}
+
+void sim_cancelar(int id) {
+  if (id < 0)
+    return;
+  evento_sim_t *e = &eventos[id & 0xFF];
+  if (e->ativo && e->geracao == (uint8_t)(id >> 8))
+    e->ativo = false;
+}
+
+static int proximo_evento(void) {
+  int melhor = -1;
+  for (int i = 0; i < MAX_EVENTOS; i++) {
+    const evento_sim_t *e = &eventos[i];
+    if (!e->ativo)
+      continue;
+    if (melhor < 0 || e->t < eventos[melhor].t ||
+        (e->t == eventos[melhor].t && e->ordem < eventos[melhor].ordem))
+      melhor = i;
+  }
+  return melhor;
+}
+
+// ---------- núcleos ----------
+
+typedef struct {
+  ucontext_t ctx;
+  bool existe;
+  bool bloqueado;
+  bool por_evento;
+  bool evento; // registrador de evento do WFE/SEV
+  uint64_t prazo;
+} nucleo_t;
+
+static nucleo_t nucleo[2] = {[0] = {.existe = true}};
+static uint core_atual;
+
+uint get_core_num(void) {
+  return core_atual;
+}
+
+static bool pronto(uint c) {
+  const nucleo_t *n = &nucleo[c];
+  return (n->por_evento && n->evento) || agora_us >= n->prazo;
+}
+
+static void trocar_para(uint c) {
+  uint eu = core_atual;
+  core_atual = c;
+  swapcontext(&nucleo[eu].ctx, &nucleo[c].ctx);
+}
+
+// Interrupções acordam os dois núcleos
+static void sinalizar(void) {
+  nucleo[0].evento = true;
+  nucleo[1].evento = true;
+}
+
+static void disparar_vencidos(void) {
+  int i;
+  while ((i = proximo_evento()) >= 0 && eventos[i].t <= agora_us) {
+    evento_sim_t e = eventos[i];
+    eventos[i].ativo = false;
+    e.fn(e.arg, e.extra);
+    sinalizar();
+  }
+}
+
+static systick_hw_t regs_systick = {.rvr = 0xffffff};
+systick_hw_t *const systick_hw = &regs_systick;
+
+static void atualizar_systick(void) {
+  if (!(regs_systick.csr & M0PLUS_SYST_CSR_ENABLE_BITS))
+    return;
+  uint64_t ciclos = agora_us * (SIM_CLK_SYS_HZ / 1000000);
+  uint64_t periodo = (uint64_t)(regs_systick.rvr & 0xffffff) + 1;
+  regs_systick.cvr = (uint32_t)(periodo - 1 - ciclos % periodo);
+}
+
+static void avancar_tempo(void) {
+  uint64_t alvo = SIM_NUNCA;
+  int i = proximo_evento();
+  if (i >= 0)
+    alvo = eventos[i].t;
+  for (uint c = 0; c < 2; c++) {
+    if (nucleo[c].existe && nucleo[c].bloqueado && nucleo[c].prazo < alvo)
+      alvo = nucleo[c].prazo;
+  }
+
+  if (alvo == SIM_NUNCA)
+    sim_encerrar("ocioso (nenhum evento pendente)");
+  if (alvo > limite_us) {
+    agora_us = limite_us;
+    sim_encerrar("limite de tempo");
+  }
+
+  if (alvo > agora_us) {
+    sim_tela_despejar(false); // a tela ficou estável até aqui
+    agora_us = alvo;
+    atualizar_systick();
+  }
+  disparar_vencidos();
+}
+
+void sim_esperar(uint64_t t_us, bool acorda_com_evento) {
+  uint eu = core_atual;
+  nucleo_t *n = &nucleo[eu];
+  n->prazo = t_us;
+  n->por_evento = acorda_com_evento;
+  n->bloqueado = true;
+
+  while (!pronto(eu)) {
+    uint outro = eu ^ 1;
+    if (nucleo[outro].existe && nucleo[outro].bloqueado && pronto(outro))
+      trocar_para(outro);
+    else
+      avancar_tempo();
+  }
+
+  n->bloqueado = false;
+  if (acorda_com_evento)
+    n->evento = false;
+}
+
+void sim_ceder(void) {
+  sim_esperar(agora_us + 1, false);
+}
+
+static void (*entrada_core1)(void);
+
+static void core1_trampolim(void) {
+  entrada_core1();
+  for (;;) // o core1 não tem para onde voltar: fica parado para sempre
+    sim_esperar(SIM_NUNCA, false);
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+  nucleo_t *n = &nucleo[1];
+  entrada_core1 = entry;
+  getcontext(&n->ctx);
+  n->ctx.uc_stack.ss_sp = malloc(PILHA_CORE1);
+  n->ctx.uc_stack.ss_size = PILHA_CORE1;
+  n->ctx.uc_link = NULL;
+  makecontext(&n->ctx, core1_trampolim, 0);
+  n->existe = true;
+  n->bloqueado = true; // "pronto para rodar" assim que o core0 esperar
+  n->prazo = 0;
+}
+
+// ---------- FIFO entre núcleos ----------
+
+// fifo[c] guarda as mensagens destinadas ao núcleo c
+static uint32_t fifo[2][FIFO_PROFUNDIDADE];
+static uint fifo_ini[2], fifo_n[2];
+
+bool multicore_fifo_rvalid(void) {
+  if (fifo_n[core_atual] > 0)
+    return true;
+  sim_ceder(); // quase sempre chamado em laço de sondagem
+  return fifo_n[core_atual] > 0;
+}
+
+bool multicore_fifo_wready(void) {
+  return fifo_n[core_atual ^ 1] < FIFO_PROFUNDIDADE;
+}
+
+void multicore_fifo_push_blocking(uint32_t data) {
+  uint dst = core_atual ^ 1;
+  while (fifo_n[dst] == FIFO_PROFUNDIDADE)
+    sim_esperar(SIM_NUNCA, true);
+  fifo[dst][(fifo_ini[dst] + fifo_n[dst]++) % FIFO_PROFUNDIDADE] = data;
+  __sev();
+}
+
+bool multicore_fifo_push_timeout_us(uint32_t data, uint64_t timeout_us) {
+  uint dst = core_atual ^ 1;
+  uint64_t prazo = agora_us + timeout_us;
+  while (fifo_n[dst] == FIFO_PROFUNDIDADE) {
+    if (agora_us >= prazo)
+      return false;
+    sim_esperar(prazo, true);
+  }
+  multicore_fifo_push_blocking(data);
+  return true;
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+  uint eu = core_atual;
+  while (fifo_n[eu] == 0)
+    sim_esperar(SIM_NUNCA, true);
+  uint32_t v = fifo[eu][fifo_ini[eu]];
+  fifo_ini[eu] = (fifo_ini[eu] + 1) % FIFO_PROFUNDIDADE;
+  fifo_n[eu]--;
+  __sev();
+  return v;
+}
+
+// ---------- sincronização ----------
+
+void __wfe(void) {
+  sim_esperar(SIM_NUNCA, true);
+}
+
+void __wfi(void) {
+  sim_esperar(SIM_NUNCA, true);
+}
+
+void __sev(void) {
+  sinalizar();
+}
+
+void __dmb(void) {
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+void tight_loop_contents(void) {
+  sim_ceder();
+}
+
+// Interrupções só "acontecem" nos pontos de espera, então não há o que mascarar
+uint32_t save_and_disable_interrupts(void) {
+  return 0;
+}
+
+void restore_interrupts(uint32_t status) {
+  (void)status;
+}
+
+// ---------- IRQs ----------
+
+static irq_handler_t handlers[NUM_IRQS][MAX_HANDLERS];
+static bool irq_habilitada[NUM_IRQS];
+
+void irq_set_enabled(uint num, bool enabled) {
+  irq_habilitada[num] = enabled;
+}
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+  handlers[num][0] = handler;
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+  (void)order_priority;
+  for (uint i = 0; i < MAX_HANDLERS; i++) {
+    if (!handlers[num][i]) {
+      handlers[num][i] = handler;
+      return;
+    }
+  }
+  sim_falhar("handlers demais na mesma IRQ");
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+  for (uint i = 0; i < MAX_HANDLERS; i++) {
+    if (handlers[num][i] == handler)
+      handlers[num][i] = NULL;
+  }
+}
+
+void sim_irq(uint num) {
+  if (!irq_habilitada[num])
+    return;
+  for (uint i = 0; i < MAX_HANDLERS; i++) {
+    if (handlers[num][i])
+      handlers[num][i]();
+  }
+  sinalizar();
+}
+
+// ---------- tempo ----------
+
+uint64_t time_us_64(void) {
+  return agora_us;
+}
+
+uint32_t time_us_32(void) {
+  return (uint32_t)agora_us;
+}
+
+absolute_time_t get_absolute_time(void) {
+  return agora_us;
+}
+
+absolute_time_t make_timeout_time_us(uint64_t us) {
+  return agora_us + us;
+}
+
+absolute_time_t make_timeout_time_ms(uint32_t ms) {
+  return agora_us + ms * 1000ull;
+}
+
+bool time_reached(absolute_time_t t) {
+  return agora_us >= t;
+}
+
+int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+  return (int64_t)(to - from);
+}
+
+uint64_t to_us_since_boot(absolute_time_t t) {
+  return t;
+}
+
+uint32_t to_ms_since_boot(absolute_time_t t) {
+  return (uint32_t)(t / 1000);
+}
+
+void sleep_until(absolute_time_t t) {
+  sim_esperar(t, false);
+}
+
+void sleep_us(uint64_t us) {
+  sim_esperar(agora_us + us, false);
+}
+
+void sleep_ms(uint32_t ms) {
+  sleep_us(ms * 1000ull);
+}
+
+void busy_wait_us(uint64_t us) {
+  sleep_us(us);
+}
+
+void busy_wait_ms(uint32_t ms) {
+  sleep_us(ms * 1000ull);
+}
+
+// ---------- alarmes ----------
+
+typedef struct {
+  bool ativo;
+  alarm_callback_t callback;
+  void *user_data;
+  uint64_t t;
+  int evento;
+} alarme_t;
+
+static alarme_t alarmes[MAX_ALARMES];
+
+static void alarme_disparar(void *arg, uint32_t idx) {
+  alarme_t *a = &alarmes[idx];
+  (void)arg;
+  if (!a->ativo)
+    return;
+
+  int64_t r = a->callback((alarm_id_t)idx + 1, a->user_data);
+  if (!a->ativo) // cancelado dentro do próprio callback
+    return;
+  if (r == 0) {
+    a->ativo = false;
+    return;
+  }
+  // > 0: relativo ao instante previsto; < 0: relativo a agora
+  a->t = r > 0 ? a->t + (uint64_t)r : agora_us + (uint64_t)(-r);
+  a->evento = sim_agendar(a->t, alarme_disparar, NULL, idx);
+}
+
+alarm_id_t add_alarm_at(absolute_time_t t, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  if (t <= agora_us && !fire_if_past)
+    return 0;
+  for (uint i = 0; i < MAX_ALARMES; i++) {
+    alarme_t *a = &alarmes[i];
+    if (a->ativo)
+      continue;
+    a->ativo = true;
+    a->callback = callback;
+    a->user_data = user_data;
+    a->t = t;
+    a->evento = sim_agendar(t, alarme_disparar, NULL, i);
+    return (alarm_id_t)i + 1;
+  }
+  return -1; // sem alarmes livres, como o SDK
+}
+
+alarm_id_t add_alarm_in_us(uint64_t us, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  return add_alarm_at(agora_us + us, callback, user_data, fire_if_past);
+}
+
+alarm_id_t add_alarm_in_ms(uint32_t ms, alarm_callback_t callback, void *user_data, bool fire_if_past) {
+  return add_alarm_at(agora_us + ms * 1000ull, callback, user_data, fire_if_past);
+}
+
+bool cancel_alarm(alarm_id_t id) {
+  if (id <= 0 || id > MAX_ALARMES)
+    return false;
+  alarme_t *a = &alarmes[id - 1];
+  if (!a->ativo)
+    return false;
+  a->ativo = false;
+  sim_cancelar(a->evento);
+  return true;
+}
+
+static int64_t repeticao_callback(alarm_id_t id, void *user_data) {
+  repeating_timer_t *rt = user_data;
+  (void)id;
+  if (!rt->callback(rt)) {
+    rt->alarm_id = 0;
+    return 0;
+  }
+  return rt->delay_us;
+}
+
+bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out) {
+  out->delay_us = delay_us;
+  out->callback = callback;
+  out->user_data = user_data;
+  uint64_t passo = (uint64_t)(delay_us >= 0 ? delay_us : -delay_us);
+  out->alarm_id = add_alarm_in_us(passo, repeticao_callback, out, true);
+  return out->alarm_id > 0;
+}
+
+bool add_repeating_timer_ms(int32_t delay_ms, repeating_timer_callback_t callback, void *user_data, repeating_timer_t *out) {
+  return add_repeating_timer_us(delay_ms * (int64_t)1000, callback, user_data, out);
+}
+
+bool cancel_repeating_timer(repeating_timer_t *timer) {
+  bool ok = timer->alarm_id > 0 && cancel_alarm(timer->alarm_id);
+  timer->alarm_id = 0;
+  return ok;
+}
+
+// ---------- pico/rand ----------
+
+static uint64_t estado_rand = 0x853c49e6748fea9bull;
+
+void sim_semente(uint32_t semente) {
+  estado_rand = 0x853c49e6748fea9bull ^ ((uint64_t)semente << 17);
+}
+
+uint64_t get_rand_64(void) {
+  // xorshift64*: reprodutível entre execuções com a mesma semente
+  estado_rand ^= estado_rand >> 12;
+  estado_rand ^= estado_rand << 25;
+  estado_rand ^= estado_rand >> 27;
+  return estado_rand * 0x2545F4914F6CDD1Dull;
+}
+
+uint32_t get_rand_32(void) {
+  return (uint32_t)(get_rand_64() >> 32);
+}
@@ -0,0 +1,202 @@
+// sim/sim_pio.c
+//
+// PIO rodando o programa ws2818b: cada palavra que entra na FIFO vira bits
+// no fio (na ordem dada pelo shift da máquina) a 10 ciclos de PIO por bit.
+// Os bits são remontados como a fita WS2812 os lê (MSB primeiro, G-R-B) e,
+// a cada 25 LEDs, o quadro vai para o log e para o arquivo de gravação.
+// Um intervalo de 50 us sem bits é o reset/latch da fita.
+
+#include "sim.h"
+#include <string.h>
+
+#define LEDS 25
+#define RESET_US 50
+
+pio_hw_t sim_pio_hw[2];
+
+typedef struct {
+  bool reclamada;
+  bool ligada;
+  pio_sm_config cfg;
+  uint64_t livre_em;     // quando a FIFO termina de sair pelo pino
+  uint8_t grb[LEDS * 3]; // quadro sendo recebido
+  uint bits;
+} maquina_pio_t;
+
+static maquina_pio_t maquinas[2][4];
+static uint instrucoes_usadas[2];
+
+FILE *sim_leds_arq;
+
+static uint pio_indice(PIO pio) {
+  return pio == pio1 ? 1 : 0;
+}
+
+static void quadro_completo(const uint8_t *grb) {
+  sim_cont.led_quadros++;
+
+  if (sim_leds_arq) {
+    uint64_t t = sim_agora();
+    fwrite(&t, sizeof t, 1, sim_leds_arq);
+    fwrite(grb, 1, LEDS * 3, sim_leds_arq);
+  }
+
+  // Mesma disposição da BitDogLab: linhas em serpentina, LED 24 no canto
+  // superior esquerdo. Cada LED mostra a cor dominante e o brilho (1..9).
+  char linhas[5][5 * 3 + 1];
+  for (uint y = 0; y < 5; y++) {
+    char *p = linhas[y];
+    for (uint x = 0; x < 5; x++) {
+      uint i = 24 - (y * 5 + ((y % 2) ? 4 - x : x));
+      uint g = grb[i * 3], r = grb[i * 3 + 1], b = grb[i * 3 + 2];
+      uint max = r > g ? (r > b ? r : b) : (g > b ? g : b);
+      if (max == 0) {
+        *p++ = ' ';
+        *p++ = '.';
+      } else {
+        *p++ = (r == max && g == max && b == max) ? 'W' : r == max ? 'R' : g == max ? 'G' : 'B';
+        *p++ = (char)('0' + (max * 9 + 254) / 255);
+      }
+      *p++ = ' ';
+    }
+    *p = '\0';
+  }
+  sim_log("led", "%s| %s| %s| %s| %s", linhas[0], linhas[1], linhas[2], linhas[3], linhas[4]);
+}
+
+// Coloca uma palavra no fio; devolve quando o último bit dela sai
+static uint64_t transmitir(PIO pio, uint sm, uint32_t palavra) {
+  maquina_pio_t *m = &maquinas[pio_indice(pio)][sm];
+  double bit_us = 10.0 * m->cfg.clkdiv / (SIM_CLK_SYS_HZ / 1e6);
+  uint n = m->cfg.pull_threshold ? m->cfg.pull_threshold : 32;
+
+  uint64_t inicio = m->livre_em > sim_agora() ? m->livre_em : sim_agora();
+  if (inicio - m->livre_em >= RESET_US)
+    m->bits = 0; // latch: o próximo bit é o primeiro LED de novo
+
+  for (uint i = 0; i < n; i++) {
+    uint bit = m->cfg.shift_direita ? (palavra >> i) & 1 : (palavra >> (31 - i)) & 1;
+    uint byte = m->bits / 8;
+    if (m->bits % 8 == 0)
+      m->grb[byte] = 0;
+    m->grb[byte] |= (uint8_t)(bit << (7 - m->bits % 8));
+    if (++m->bits == LEDS * 24) {
+      quadro_completo(m->grb);
+      m->bits = 0;
+    }
+  }
+
+  sim_cont.pio_palavras++;
+  m->livre_em = inicio + (uint64_t)(n * bit_us + 0.5);
+  return m->livre_em;
+}
+
+bool sim_pio_dma_palavra(volatile void *endereco, uint32_t palavra, uint64_t *fim_us) {
+  for (uint p = 0; p < 2; p++) {
+    for (uint sm = 0; sm < 4; sm++) {
+      if (endereco == &sim_pio_hw[p].txf[sm]) {
+        *fim_us = transmitir(&sim_pio_hw[p], sm, palavra);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void pio_sm_put_blocking(PIO pio, uint sm, uint32_t data) {
+  maquina_pio_t *m = &maquinas[pio_indice(pio)][sm];
+  uint64_t fim = transmitir(pio, sm, data);
+
+  // A FIFO (8 palavras com TX unida) absorve o começo; depois a CPU espera o fio
+  uint profundidade = m->cfg.fifo_tx_unida ? 8 : 4;
+  double bit_us = 10.0 * m->cfg.clkdiv / (SIM_CLK_SYS_HZ / 1e6);
+  uint64_t folga = (uint64_t)(profundidade * (m->cfg.pull_threshold ? m->cfg.pull_threshold : 32) * bit_us);
+  if (fim > sim_agora() + folga)
+    sleep_until(fim - folga);
+}
+
+bool pio_sm_is_tx_fifo_empty(PIO pio, uint sm) {
+  return maquinas[pio_indice(pio)][sm].livre_em <= sim_agora();
+}
+
+uint pio_add_program(PIO pio, const pio_program_t *program) {
+  uint p = pio_indice(pio);
+  uint offset = instrucoes_usadas[p];
+  if (offset + program->length > 32)
+    sim_falhar("memória de instruções da PIO cheia");
+  instrucoes_usadas[p] += program->length;
+  return offset;
+}
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+  for (uint sm = 0; sm < 4; sm++) {
+    maquina_pio_t *m = &maquinas[pio_indice(pio)][sm];
+    if (!m->reclamada) {
+      m->reclamada = true;
+      return (int)sm;
+    }
+  }
+  if (required)
+    sim_falhar("sem máquinas de estado PIO livres");
+  return -1;
+}
+
+void pio_sm_claim(PIO pio, uint sm) {
+  maquinas[pio_indice(pio)][sm].reclamada = true;
+}
+
+void pio_gpio_init(PIO pio, uint pin) {
+  gpio_set_function(pin, pio == pio1 ? GPIO_FUNC_PIO1 : GPIO_FUNC_PIO0);
+}
+
+void pio_sm_set_consecutive_pindirs(PIO pio, uint sm, uint pin_base, uint pin_count, bool is_out) {
+  (void)pio, (void)sm, (void)pin_base, (void)pin_count, (void)is_out;
+}
+
+pio_sm_config pio_get_default_sm_config(void) {
+  pio_sm_config c = {.clkdiv = 1.f, .shift_direita = true, .pull_threshold = 32, .wrap = 31};
+  return c;
+}
+
+void sm_config_set_wrap(pio_sm_config *c, uint wrap_target, uint wrap) {
+  c->wrap_target = wrap_target;
+  c->wrap = wrap;
+}
+
+void sm_config_set_sideset(pio_sm_config *c, uint bit_count, bool optional, bool pindirs) {
+  (void)c, (void)bit_count, (void)optional, (void)pindirs;
+}
+
+void sm_config_set_sideset_pins(pio_sm_config *c, uint sideset_base) {
+  c->sideset_base = sideset_base;
+}
+
+void sm_config_set_out_shift(pio_sm_config *c, bool shift_right, bool autopull, uint pull_threshold) {
+  c->shift_direita = shift_right;
+  c->autopull = autopull;
+  c->pull_threshold = pull_threshold;
+}
+
+void sm_config_set_fifo_join(pio_sm_config *c, enum pio_fifo_join join) {
+  c->fifo_tx_unida = join == PIO_FIFO_JOIN_TX;
+}
+
+void sm_config_set_clkdiv(pio_sm_config *c, float div) {
+  c->clkdiv = div;
+}
+
+void pio_sm_init(PIO pio, uint sm, uint initial_pc, const pio_sm_config *config) {
+  maquina_pio_t *m = &maquinas[pio_indice(pio)][sm];
+  (void)initial_pc;
+  m->cfg = *config;
+  m->bits = 0;
+  m->ligada = false;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {
+  maquinas[pio_indice(pio)][sm].ligada = enabled;
+}
+
+uint pio_get_dreq(PIO pio, uint sm, bool is_tx) {
+  return (pio == pio1 ? DREQ_PIO1_TX0 : DREQ_PIO0_TX0) + sm + (is_tx ? 0 : 4);
+}
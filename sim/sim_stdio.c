@@ -0,0 +1,96 @@
+// sim/sim_stdio.c
+//
+// A "USB serial" da simulação. O que o firmware escreve (printf e quadros
+// binários) sai pelo stdout do processo, ou por um arquivo com --serial; o
+// que o host manda chega pelos comandos "serial" do roteiro.
+
+#define _GNU_SOURCE
+#include "sim.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+#define RX_TAM 4096
+
+static char rx[RX_TAM];
+static size_t rx_ini, rx_n;
+static void (*chars_callback)(void *);
+static void *chars_param;
+static int serial_fd = STDOUT_FILENO;
+
+static ssize_t escrever_serial(void *cookie, const char *buf, size_t n) {
+  (void)cookie;
+  size_t feito = 0;
+  while (feito < n) {
+    ssize_t r = write(serial_fd, buf + feito, n - feito);
+    if (r <= 0)
+      return feito ? (ssize_t)feito : -1;
+    feito += (size_t)r;
+  }
+  sim_cont.serial_tx_bytes += n;
+  return (ssize_t)n;
+}
+
+// Troca o stdout por um FILE que conta os bytes; o printf do firmware passa por ele
+bool sim_serial_abrir(const char *caminho) {
+  if (caminho) {
+    serial_fd = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (serial_fd < 0)
+      return false;
+  }
+  cookie_io_functions_t io = {.write = escrever_serial};
+  FILE *f = fopencookie(NULL, "w", io);
+  if (!f)
+    return false;
+  setvbuf(f, NULL, _IOFBF, 1 << 16);
+  stdout = f;
+  return true;
+}
+
+void sim_serial_injetar(const char *s, size_t n) {
+  for (size_t i = 0; i < n && rx_n < RX_TAM; i++, rx_n++)
+    rx[(rx_ini + rx_n) % RX_TAM] = s[i];
+  sim_cont.serial_rx_bytes += n;
+  if (chars_callback)
+    chars_callback(chars_param);
+}
+
+bool stdio_init_all(void) {
+  return true;
+}
+
+int getchar_timeout_us(uint32_t timeout_us) {
+  uint64_t prazo = sim_agora() + timeout_us;
+  while (rx_n == 0 && sim_agora() < prazo)
+    sim_esperar(prazo, true);
+  if (rx_n == 0)
+    return PICO_ERROR_TIMEOUT;
+
+  int c = (unsigned char)rx[rx_ini];
+  rx_ini = (rx_ini + 1) % RX_TAM;
+  rx_n--;
+  return c;
+}
+
+int putchar_raw(int c) {
+  return putc(c, stdout);
+}
+
+int puts_raw(const char *s) {
+  fputs(s, stdout);
+  return putc('\n', stdout);
+}
+
+void stdio_put_string(const char *s, int len, bool newline, bool cr_translation) {
+  fwrite(s, 1, (size_t)len, stdout);
+  if (newline)
+    fputs(cr_translation ? "\r\n" : "\n", stdout);
+}
+
+void stdio_flush(void) {
+  fflush(stdout);
+}
+
+void stdio_set_chars_available_callback(void (*fn)(void *), void *param) {
+  chars_callback = fn;
+  chars_param = param;
+}
@@ -0,0 +1,228 @@
+// sim/teste_distancia.c
+//
+// Teste de host da distância de edição (ferramentas/distancia.c), rodado pelo
+// ctest: o Myers bit-paralelo tem que dar o mesmo que a programação dinâmica
+// de sempre, com e sem limite k, e a busca de vizinhas tem que sair na ordem
+// que o python/distancia.py também usa (distância, tamanho mais perto da
+// consulta, a mais curta, alfabética).
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ferramentas/distancia.h"
+
+#define INDICE "teste_distancia.idx"
+#define PALAVRAS 400
+#define MAX_ACHADAS 8
+
+static uint32_t semente = 12345;
+
+static uint32_t sortear(uint32_t n) {
+  semente = semente * 1664525u + 1013904223u;
+  return (semente >> 8) % n;
+}
+
+// Palavra aleatória de "letras" letras tiradas das primeiras "alfabeto" de a-z
+static void palavra_aleatoria(char *s, int letras, int alfabeto) {
+  for (int i = 0; i < letras; i++)
+    s[i] = (char)('a' + sortear(alfabeto));
+  s[letras] = '\0';
+}
+
+static int falhas = 0;
+
+static void conferir(int ok, const char *msg) {
+  printf("%s: %s\n", ok ? "ok" : "FALHOU", msg);
+  falhas += !ok;
+}
+
+// Levenshtein pela matriz inteira, sem truque nenhum
+static int levenshtein_dp(const char *a, const char *b) {
+  int m = (int)strlen(a), n = (int)strlen(b);
+  static int d[DISTANCIA_MAX_LETRAS + 1][DISTANCIA_MAX_LETRAS + 8];
+  for (int i = 0; i <= m; i++)
+    d[i][0] = i;
+  for (int j = 0; j <= n; j++)
+    d[0][j] = j;
+  for (int i = 1; i <= m; i++) {
+    for (int j = 1; j <= n; j++) {
+      int v = d[i - 1][j - 1] + (a[i - 1] != b[j - 1]);
+      if (d[i - 1][j] + 1 < v)
+        v = d[i - 1][j] + 1;
+      if (d[i][j - 1] + 1 < v)
+        v = d[i][j - 1] + 1;
+      d[i][j] = v;
+    }
+  }
+  return d[m][n];
+}
+
+// Pares aleatórios de 0 a 64 letras (o padrão de 64 ocupa a palavra inteira do
+// Myers), alfabetos pequenos para haver casamentos, e vários limites k
+static void levenshtein_contra_dp(void) {
+  static const int limites[] = {0, 1, 2, 3, 5, 10, 64, 100};
+  char a[DISTANCIA_MAX_LETRAS + 1], b[DISTANCIA_MAX_LETRAS + 8];
+  int pares = 0, erros = 0, com_64 = 0;
+
+  for (int r = 0; r < 4000; r++) {
+    int m = r % 8 == 0 ? DISTANCIA_MAX_LETRAS : (int)sortear(DISTANCIA_MAX_LETRAS + 1);
+    int n = r % 3 == 0 ? m + (int)sortear(7) - 3 : (int)sortear(DISTANCIA_MAX_LETRAS + 8);
+    if (n < 0)
+      n = 0;
+    int alfabeto = 2 + (int)sortear(25);
+    palavra_aleatoria(a, m, alfabeto);
+    if (r % 5 == 0) {
+      // b = a com algumas edições, para ter distâncias pequenas de verdade
+      strcpy(b, a);
+      n = m;
+      for (int e = (int)sortear(4); e > 0 && n > 0; e--)
+        b[sortear(n)] = (char)('a' + sortear(alfabeto));
+    } else {
+      palavra_aleatoria(b, n, alfabeto);
+    }
+
+    int ref = levenshtein_dp(a, b);
+    for (unsigned i = 0; i < sizeof limites / sizeof limites[0]; i++) {
+      int k = limites[i];
+      int esperado = ref <= k ? ref : k + 1;
+      int obtido = distancia_levenshtein(a, b, k);
+      if (obtido != esperado && erros++ < 5)
+        printf("  \"%s\" x \"%s\", k = %d: %d, esperado %d\n", a, b, k, obtido, esperado);
+      pares++;
+    }
+    com_64 += m == DISTANCIA_MAX_LETRAS;
+  }
+  printf("  %d comparações, %d com padrão de %d letras\n", pares, com_64, DISTANCIA_MAX_LETRAS);
+  conferir(erros == 0, "distancia_levenshtein igual à programação dinâmica");
+  conferir(distancia_levenshtein("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa", "a", 3) == -1,
+           "padrão com mais de 64 letras devolve -1");
+}
+
+// ---------- vizinhas ----------
+
+static char palavras[PALAVRAS][12];
+
+static void put_u32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++)
+    p[i] = (uint8_t)(v >> (8 * i));
+}
+
+// Só o que o distancia_abrir() lê do formato do indexar_palavras.c: cabeçalho,
+// entradas {offset do texto, letras} e os textos
+static int gravar_indice(void) {
+  uint32_t off_entradas = 40, off_textos = off_entradas + 8 * PALAVRAS, tam_textos = 0;
+  for (int i = 0; i < PALAVRAS; i++)
+    tam_textos += (uint32_t)strlen(palavras[i]);
+
+  uint8_t *idx = calloc(1, off_textos + tam_textos);
+  memcpy(idx, "SPIX\x02\x00", 6);
+  idx[6] = 11; // letras_max
+  idx[7] = 1;  // níveis
+  put_u32(idx + 8, PALAVRAS);
+  put_u32(idx + 16, off_entradas);
+  put_u32(idx + 20, off_textos);
+  put_u32(idx + 24, tam_textos);
+  uint32_t pos = 0;
+  for (int i = 0; i < PALAVRAS; i++) {
+    uint32_t letras = (uint32_t)strlen(palavras[i]);
+    put_u32(idx + off_entradas + 8 * i, pos);
+    idx[off_entradas + 8 * i + 4] = (uint8_t)letras;
+    memcpy(idx + off_textos + pos, palavras[i], letras);
+    pos += letras;
+  }
+
+  FILE *f = fopen(INDICE, "wb");
+  int ok = f && fwrite(idx, 1, off_textos + tam_textos, f) == off_textos + tam_textos;
+  if (f)
+    fclose(f);
+  free(idx);
+  return ok;
+}
+
+typedef struct {
+  int dist, dl, letras;
+  const char *palavra;
+} candidata_t;
+
+static int comparar_candidatas(const void *pa, const void *pb) {
+  const candidata_t *a = pa, *b = pb;
+  if (a->dist != b->dist)
+    return a->dist - b->dist;
+  if (a->dl != b->dl)
+    return a->dl - b->dl;
+  if (a->letras != b->letras)
+    return a->letras - b->letras;
+  return strcmp(a->palavra, b->palavra);
+}
+
+// Força bruta com o desempate do python/distancia.py: ordena tudo o que
+// estiver a distância <= k pela chave (dist, |n - m|, n, palavra)
+static int vizinhas_dp(const char *consulta, int k, int max, candidata_t *saida) {
+  static candidata_t todas[PALAVRAS];
+  int m = (int)strlen(consulta), n = 0;
+  for (int i = 0; i < PALAVRAS; i++) {
+    int dist = levenshtein_dp(consulta, palavras[i]);
+    if (dist > k)
+      continue;
+    int letras = (int)strlen(palavras[i]);
+    todas[n++] = (candidata_t){dist, abs(letras - m), letras, palavras[i]};
+  }
+  qsort(todas, n, sizeof(todas[0]), comparar_candidatas);
+  if (n > max)
+    n = max;
+  memcpy(saida, todas, n * sizeof(todas[0]));
+  return n;
+}
+
+// Dicionário de palavras curtas em poucas letras: muitos empates de distância
+static void vizinhas_no_indice(void) {
+  for (int i = 0; i < PALAVRAS; i++)
+    palavra_aleatoria(palavras[i], 1 + (int)sortear(8), 3 + (int)sortear(3));
+  conferir(gravar_indice(), "índice de teste gravado");
+  distancia_dicionario_t *d = distancia_abrir(INDICE);
+  conferir(d != NULL, "distancia_abrir aceita o índice");
+  if (d == NULL)
+    return;
+  conferir(distancia_num_palavras(d) == PALAVRAS, "todas as palavras carregadas");
+
+  int consultas = 0, erros = 0, achadas_total = 0;
+  for (int r = 0; r < 300; r++) {
+    char consulta[12];
+    palavra_aleatoria(consulta, (int)sortear(10), 3 + (int)sortear(3));
+    int k = (int)sortear(4), max = 1 + (int)sortear(MAX_ACHADAS);
+
+    uint32_t indices[MAX_ACHADAS];
+    uint8_t dists[MAX_ACHADAS];
+    candidata_t esperadas[MAX_ACHADAS];
+    int n = distancia_vizinhas(d, consulta, k, max, indices, dists);
+    int ne = vizinhas_dp(consulta, k, max, esperadas);
+
+    int igual = n == ne;
+    for (int i = 0; igual && i < n; i++)
+      igual = dists[i] == esperadas[i].dist && !strcmp(distancia_palavra(d, indices[i]), esperadas[i].palavra);
+    if (!igual && erros++ < 5) {
+      printf("  \"%s\", k = %d, max = %d:", consulta, k, max);
+      for (int i = 0; i < n; i++)
+        printf(" %s/%u", distancia_palavra(d, indices[i]), dists[i]);
+      printf("  esperado:");
+      for (int i = 0; i < ne; i++)
+        printf(" %s/%d", esperadas[i].palavra, esperadas[i].dist);
+      printf("\n");
+    }
+    consultas++;
+    achadas_total += n;
+  }
+  printf("  %d consultas, %d vizinhas\n", consultas, achadas_total);
+  conferir(achadas_total > consultas, "consultas acham vizinhas");
+  conferir(erros == 0, "distancia_vizinhas na ordem de desempate do python/distancia.py");
+
+  distancia_fechar(d);
+  remove(INDICE);
+}
+
+int main(void) {
+  levenshtein_contra_dp();
+  vizinhas_no_indice();
+  return falhas != 0;
+}
@@ -0,0 +1,103 @@
+// sim/teste_leds.c
+//
+// Teste da matriz de LEDs pela simulação, rodado pelo ctest: roda o firmware
+// (soletrando_sim, caminho no argv) até o fim da contagem e confere nos
+// quadros gravados (--leds) que cada fade só sobe e depois só desce. Com os
+// bits de cada cor saindo na ordem errada o brilho pula para cima e para
+// baixo no meio da rampa.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define LEDS 25
+#define ROTEIRO "teste_leds.roteiro"
+#define QUADROS "teste_leds.bin"
+
+static int falhas = 0;
+
+static void conferir(int ok, const char *msg) {
+  printf("%s: %s\n", ok ? "ok" : "FALHOU", msg);
+  falhas += !ok;
+}
+
+// Sem host: B sorteia da flash e a contagem de 10 s acende um dígito por
+// segundo, depois da seta de "pressione B" pulsando desde o boot
+static int rodar_simulacao(const char *sim) {
+  FILE *f = fopen(ROTEIRO, "w");
+  if (!f)
+    return 0;
+  fputs("5500 botao B\n18000 fim\n", f);
+  fclose(f);
+
+  char cmd[1024];
+  snprintf(cmd, sizeof cmd, "\"%s\" --roteiro " ROTEIRO " --leds " QUADROS
+           " --serial /dev/null --log /dev/null --sem-tela", sim);
+  return system(cmd) == 0;
+}
+
+typedef struct {
+  uint32_t mascara;
+  uint8_t brilho; // maior canal entre os LEDs acesos
+} quadro_t;
+
+static quadro_t ler_quadro(const uint8_t *grb) {
+  quadro_t q = {0, 0};
+  for (int i = 0; i < LEDS * 3; i++) {
+    if (grb[i]) {
+      q.mascara |= 1u << (i / 3);
+      if (grb[i] > q.brilho)
+        q.brilho = grb[i];
+    }
+  }
+  return q;
+}
+
+// Um fade é uma sequência de quadros do mesmo desenho (ou apagados no fim de
+// um pulso); o brilho tem que subir até o pico e só descer depois dele
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    fprintf(stderr, "uso: %s SOLETRANDO_SIM\n", argv[0]);
+    return 2;
+  }
+  conferir(rodar_simulacao(argv[1]), "simulação roda até o fim do roteiro");
+
+  FILE *f = fopen(QUADROS, "rb");
+  if (!f) {
+    conferir(0, "quadros dos LEDs gravados");
+    return 1;
+  }
+
+  uint64_t t;
+  uint8_t grb[LEDS * 3];
+  quadro_t ant = {0, 0};
+  uint32_t desenho = 0;
+  int descendo = 0, subidas = 0, quadros = 0, fora_de_ordem = 0;
+  while (fread(&t, sizeof t, 1, f) == 1 && fread(grb, 1, sizeof grb, f) == sizeof grb) {
+    quadro_t q = ler_quadro(grb);
+    quadros++;
+    if (q.mascara && q.mascara != desenho) {
+      // desenho novo: outro fade começa
+      desenho = q.mascara;
+      descendo = 0;
+    } else if (q.brilho > ant.brilho) {
+      if (descendo && ant.brilho) {
+        printf("  t = %llu us: brilho %u depois de %u descendo\n", (unsigned long long)t, q.brilho, ant.brilho);
+        fora_de_ordem++;
+      }
+      descendo = 0;
+      subidas++;
+    } else if (q.brilho < ant.brilho) {
+      descendo = 1;
+    }
+    ant = q;
+  }
+  fclose(f);
+
+  printf("  %d quadros, %d subidas de brilho\n", quadros, subidas);
+  conferir(quadros > 100 && subidas > 20, "seta pulsando e dígitos acendendo na matriz");
+  conferir(fora_de_ordem == 0, "brilho monotônico em cada fade");
+  remove(ROTEIRO);
+  remove(QUADROS);
+  return falhas != 0;
+}
@@ -0,0 +1,80 @@
+// sim/teste_vad.c
+//
+// Teste de host do detector de voz (microfone/vad.c), rodado pelo ctest: ruído
+// constante não pode virar fala, e a captura tem que terminar pelo timeout.
+
+#include <stdio.h>
+#include "microfone/microfone_dma.h"
+#include "microfone/vad.h"
+
+#define TAXA 8000
+#define CENTRO 2048  // meio da escala do ADC de 12 bits
+
+static uint32_t semente = 12345;
+
+// Ruído uniforme em [-amplitude, amplitude] em torno do centro
+static void ruido(uint16_t *bloco, int amplitude) {
+  for (uint i = 0; i < MIC_BLOCK_SAMPLES; i++) {
+    semente = semente * 1664525u + 1013904223u;
+    bloco[i] = CENTRO + (int)(semente >> 16) % (2 * amplitude + 1) - amplitude;
+  }
+}
+
+// Tom de 500 Hz (onda quadrada) por cima do ruído: "fala" bem acima do piso
+static void tom(uint16_t *bloco, int amplitude, int ruido_amp) {
+  ruido(bloco, ruido_amp);
+  for (uint i = 0; i < MIC_BLOCK_SAMPLES; i++)
+    bloco[i] += (i / 8) % 2 ? amplitude : -amplitude;
+}
+
+static int falhas = 0;
+
+static void conferir(int ok, const char *msg) {
+  printf("%s: %s\n", ok ? "ok" : "FALHOU", msg);
+  falhas += !ok;
+}
+
+// Ruído de energia ~1000 do começo ao fim: só VAD_SILENCIO, depois VAD_SEM_FALA
+static void ruido_constante(void) {
+  vad_config_t cfg = VAD_CONFIG_PADRAO;
+  vad_t v;
+  uint16_t bloco[MIC_BLOCK_SAMPLES];
+  vad_reset(&v, &cfg);
+
+  uint blocos_max = (cfg.timeout_sem_fala_ms + 1000) * (TAXA / 1000) / MIC_BLOCK_SAMPLES;
+  vad_evento_t ev = VAD_SILENCIO;
+  bool inicio = false;
+  for (uint i = 0; i < blocos_max && ev != VAD_SEM_FALA; i++) {
+    ruido(bloco, 54);
+    ev = vad_processar(&v, bloco, MIC_BLOCK_SAMPLES, TAXA);
+    inicio |= ev == VAD_INICIO_FALA;
+  }
+  printf("  piso %u, energia %u\n", (unsigned)v.piso, (unsigned)v.energia);
+  conferir(!inicio, "ruído constante não dispara VAD_INICIO_FALA");
+  conferir(ev == VAD_SEM_FALA, "ruído constante termina em VAD_SEM_FALA");
+}
+
+// O mesmo ruído e depois fala: ainda detectada depois da calibração
+static void ruido_e_fala(void) {
+  vad_config_t cfg = VAD_CONFIG_PADRAO;
+  vad_t v;
+  uint16_t bloco[MIC_BLOCK_SAMPLES];
+  vad_reset(&v, &cfg);
+
+  for (uint i = 0; i < 20; i++) {
+    ruido(bloco, 54);
+    vad_processar(&v, bloco, MIC_BLOCK_SAMPLES, TAXA);
+  }
+  bool inicio = false;
+  for (uint i = 0; i < 5 && !inicio; i++) {
+    tom(bloco, 200, 54);
+    inicio = vad_processar(&v, bloco, MIC_BLOCK_SAMPLES, TAXA) == VAD_INICIO_FALA;
+  }
+  conferir(inicio, "fala depois do ruído dispara VAD_INICIO_FALA");
+}
+
+int main(void) {
+  ruido_constante();
+  ruido_e_fala();
+  return falhas != 0;
+}